@@ -1,6 +1,16 @@
 #include "alloc.h"
 
+#include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define ALLOC_MMAP
+#endif
+
+// size of an explicit huge page
+#define HUGE_PAGE_SIZE ((size_t)2 << 20)
 
 double **malloc_d2d(const int n, const int m) {
   /* allocate row memory */
@@ -10,7 +20,7 @@ double **malloc_d2d(const int n, const int m) {
   }
 
   /* allocate main memory */
-  double *mem = malloc(n * m * sizeof(double));
+  double *mem = malloc((size_t)n * m * sizeof(double));
   if (!mem) {
     free(rows);
     return NULL;
@@ -18,7 +28,7 @@ double **malloc_d2d(const int n, const int m) {
 
   /* match rows to memory */
   for (int i = 0; i < n; i++) {
-    rows[i] = &(mem[i * m]);
+    rows[i] = &(mem[(size_t)i * m]);
   } // i end
 
   return rows;
@@ -32,7 +42,51 @@ double **calloc_d2d(int n, int m) {
   }
 
   /* allocate main memory */
-  double *mem = calloc(n * m, sizeof(double));
+  double *mem = calloc((size_t)n * m, sizeof(double));
+  if (!mem) {
+    free(rows);
+    return NULL;
+  }
+
+  /* match rows to memory */
+  for (int i = 0; i < n; i++) {
+    rows[i] = &(mem[(size_t)i * m]);
+  } // i end
+
+  return rows;
+}
+
+int aligned_stride_d(const int m) {
+  const int line = ALLOC_ALIGN / (int)sizeof(double); // doubles per cache line
+  int stride = ((m + line - 1) / line) * line;
+
+  // avoid strides which are a multiple of 2 KB
+  const int critical = 2048 / (int)sizeof(double);
+  if (stride > 0 && stride % critical == 0) {
+    stride += line;
+  }
+
+  return stride;
+}
+
+double **malloc_d2d_aligned(const int n, const int m, int *stride) {
+  const int s = aligned_stride_d(m);
+  if (stride) {
+    *stride = s;
+  }
+
+  /* allocate row memory */
+  double **rows = malloc(n * sizeof(double *));
+  if (!rows) {
+    return NULL;
+  }
+
+  /* allocate main memory, which is a whole number of cache lines */
+  size_t size = (size_t)n * (size_t)s * sizeof(double);
+  if (size == 0) {
+    size = ALLOC_ALIGN;
+  }
+  double *mem = aligned_alloc(ALLOC_ALIGN, size);
   if (!mem) {
     free(rows);
     return NULL;
@@ -40,12 +94,116 @@ double **calloc_d2d(int n, int m) {
 
   /* match rows to memory */
   for (int i = 0; i < n; i++) {
-    rows[i] = &(mem[i * m]);
+    rows[i] = &(mem[(size_t)i * s]);
+  } // i end
+
+  return rows;
+}
+
+double **calloc_d2d_aligned(const int n, const int m, int *stride) {
+  int s;
+  double **rows = malloc_d2d_aligned(n, m, &s);
+  if (!rows) {
+    return NULL;
+  }
+  if (stride) {
+    *stride = s;
+  }
+
+  memset(rows[0], 0, (size_t)n * (size_t)s * sizeof(double));
+
+  return rows;
+}
+
+/**
+ * Rounds size up to a multiple of align.
+ */
+static size_t round_up(const size_t size, const size_t align) {
+  return (size + align - 1) / align * align;
+}
+
+/**
+ * Maps len bytes of zeroed memory, using huge pages if requested. len is
+ * updated if it has to be rounded up to a whole number of huge pages.
+ */
+static unsigned char *map_memory(size_t *len, const int flags) {
+#ifdef ALLOC_MMAP
+  void *p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+  if (flags & ALLOC_HUGETLB) {
+    const size_t hlen = round_up(*len, HUGE_PAGE_SIZE);
+    p = mmap(
+        NULL, hlen, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0
+    );
+    if (p != MAP_FAILED) {
+      *len = hlen;
+      return p;
+    }
+  }
+#endif
+
+  // fall back to normal pages, promoted to transparent huge pages if possible
+  p = mmap(
+      NULL, *len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+  );
+  if (p == MAP_FAILED) {
+    return NULL;
+  }
+#ifdef MADV_HUGEPAGE
+  if (flags & (ALLOC_HUGE_PAGES | ALLOC_HUGETLB)) {
+    madvise(p, *len, MADV_HUGEPAGE); // only advice, so failure is harmless
+  }
+#endif
+  return p;
+#else
+  (void)flags;
+  *len = round_up(*len, ALLOC_ALIGN);
+  return aligned_alloc(ALLOC_ALIGN, *len);
+#endif
+}
+
+double **calloc_d2d_large(const int n, const int m, const int flags) {
+  // the memory holds its own length, then the row pointers, then the matrix
+  const size_t head = ALLOC_ALIGN + round_up(n * sizeof(double *), ALLOC_ALIGN);
+  size_t len = head + (size_t)n * (size_t)m * sizeof(double);
+  unsigned char *base = map_memory(&len, flags);
+  if (!base) {
+    return NULL;
+  }
+  memcpy(base, &len, sizeof(size_t));
+
+  double **rows = (void *)(base + ALLOC_ALIGN);
+  double *mem = (void *)(base + head);
+
+  // first touch each row from the thread which will later work on it
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (int i = 0; i < n; i++) {
+    rows[i] = &(mem[(size_t)i * m]);
+    memset(rows[i], 0, (size_t)m * sizeof(double));
   } // i end
 
   return rows;
 }
 
+void free_2d_large(double **arr) {
+  if (!arr) {
+    return;
+  }
+
+  unsigned char *base = (unsigned char *)(void *)arr - ALLOC_ALIGN;
+  size_t len;
+  memcpy(&len, base, sizeof(size_t));
+#ifdef ALLOC_MMAP
+  munmap(base, len);
+#else
+  (void)len;
+  free(base);
+#endif
+}
+
 void internal_free_2d(void **arr) {
   if (arr) {
     free(arr[0]); // free the main memory
@@ -39,6 +39,96 @@ double **malloc_d2d(int n, int m);
  */
 double **calloc_d2d(int n, int m);
 
+/**
+ * Alignment, in bytes, of the rows of the arrays allocated by
+ * malloc_d2d_aligned and calloc_d2d_aligned. This is the size of a cache line,
+ * and is enough for aligned loads of any current SIMD width.
+ */
+#define ALLOC_ALIGN (64)
+
+/**
+ * Computes the padded row stride used by malloc_d2d_aligned for rows of m
+ * doubles.
+ *
+ * The stride is rounded up to a whole number of cache lines, and then padded
+ * by a further cache line if it is a multiple of 2 KB, since rows separated by
+ * such strides map to the same few cache sets and evict each other when a
+ * column is traversed.
+ *
+ * @param m number of columns
+ * @return row stride, in doubles
+ */
+int aligned_stride_d(int m);
+
+/**
+ * Allocates a 2D 'array' of doubles whose rows are aligned to ALLOC_ALIGN
+ * bytes and padded to the stride given by aligned_stride_d. Must be freed with
+ * free_2d.
+ *
+ * As for malloc_d2d, arr[0] points to the flattened array, but the rows are
+ * now stride apart rather than m apart:
+ *   arr[0][i * stride + j] == arr[i][j]
+ * The padding at the end of each row is not initialised.
+ *
+ * @param n number of rows
+ * @param m number of columns
+ * @param stride overwritten with the row stride, in doubles (may be NULL)
+ * @return pointer to a 2D array of size n x m
+ */
+double **malloc_d2d_aligned(int n, int m, int *stride);
+
+/**
+ * Allocates an aligned, padded, 2D 'array' of doubles initialised to zero
+ * (including the padding). Must be freed with free_2d.
+ *
+ * This is to malloc_d2d_aligned what calloc is to malloc.
+ *
+ * @param n number of rows
+ * @param m number of columns
+ * @param stride overwritten with the row stride, in doubles (may be NULL)
+ * @return pointer to a 2D array of size n x m
+ */
+double **calloc_d2d_aligned(int n, int m, int *stride);
+
+/**
+ * Flags for calloc_d2d_large. ALLOC_HUGE_PAGES asks the kernel to back the
+ * array with transparent huge pages where it can. ALLOC_HUGETLB asks for
+ * explicitly reserved huge pages, and falls back to transparent huge pages if
+ * none are available.
+ */
+#define ALLOC_HUGE_PAGES (1)
+#define ALLOC_HUGETLB (2)
+
+/**
+ * Allocates a 2D 'array' of doubles initialised to zero, intended for large
+ * matrices. Must be freed with free_2d_large (NOT free_2d).
+ *
+ * The layout is exactly that of calloc_d2d, so arr[0] is the flattened array
+ * and can be passed straight to the solvers. The difference is in how the
+ * memory is obtained: it is mapped directly from the operating system, which
+ * allows it to be backed by huge pages (see the flags above) to reduce TLB
+ * misses, and the zeroing is done in parallel with OpenMP, using a static
+ * schedule over the rows. On a NUMA machine each page is placed on the node of
+ * the thread which first touches it, so the pages are spread over the threads
+ * of a static row partition rather than all placed on one node.
+ *
+ * Where memory mapping is not available, the flags are ignored and the memory
+ * comes from aligned_alloc.
+ *
+ * @param n number of rows
+ * @param m number of columns
+ * @param flags bitwise OR of ALLOC_HUGE_PAGES and ALLOC_HUGETLB, or 0
+ * @return pointer to a 2D array of size n x m
+ */
+double **calloc_d2d_large(int n, int m, int flags);
+
+/**
+ * Frees a 2D array allocated with calloc_d2d_large.
+ *
+ * @param arr pointer to the 2D array to free
+ */
+void free_2d_large(double **arr);
+
 /**
  * Frees a 2D array of any type allocated with malloc_X2d.
  *
@@ -0,0 +1,85 @@
+/**
+ * Allocations are rounded up to whole multiples of ALLOC_ALIGN, so every
+ * pointer handed out is aligned as long as the backing memory is.
+ */
+
+#include "arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "alloc.h"
+
+/**
+ * Rounds size up to a multiple of ALLOC_ALIGN.
+ */
+static size_t round_up(const size_t size) {
+  return (size + ALLOC_ALIGN - 1) / ALLOC_ALIGN * ALLOC_ALIGN;
+}
+
+// arena belonging to each thread
+static _Thread_local arena thread_arena;
+
+int arena_init(arena *a, const size_t size) {
+  memset(a, 0, sizeof(arena));
+
+  const size_t s = round_up(size > 0 ? size : 1);
+  a->mem = aligned_alloc(ALLOC_ALIGN, s);
+  if (!a->mem) {
+    return -1;
+  }
+  a->size = s;
+
+  return 0;
+}
+
+void arena_free(arena *a) {
+  free(a->mem);
+  memset(a, 0, sizeof(arena));
+}
+
+void *arena_alloc(arena *a, const size_t size) {
+  const size_t s = round_up(size);
+  if (s > a->size - a->used) {
+    return NULL;
+  }
+
+  void *ptr = a->mem + a->used;
+  a->used += s;
+  if (a->used > a->peak) {
+    a->peak = a->used;
+  }
+
+  return ptr;
+}
+
+double *arena_alloc_d(arena *a, const size_t n) {
+  return arena_alloc(a, n * sizeof(double));
+}
+
+size_t arena_mark(const arena *a) { return a->used; }
+
+void arena_release(arena *a, const size_t mark) {
+  if (mark < a->used) {
+    a->used = mark;
+  }
+}
+
+void arena_reset(arena *a) { a->used = 0; }
+
+arena *arena_thread(const size_t size) {
+  arena *a = &thread_arena;
+  if (!a->mem || a->size < size) {
+    // grow geometrically, so that a slowly increasing size reallocates rarely
+    const size_t s = (size > 2 * a->size) ? size : 2 * a->size;
+    arena_free(a);
+    if (arena_init(a, s) != 0) {
+      return NULL;
+    }
+  }
+
+  arena_reset(a);
+  return a;
+}
+
+void arena_thread_free(void) { arena_free(&thread_arena); }
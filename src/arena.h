@@ -0,0 +1,111 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+/**
+ * Bump allocator for solver workspace.
+ *
+ * Solvers such as `block_solve` and `hodlr_solve` take their workspace from
+ * the caller, so that repeated solves need not allocate. An arena owns a single
+ * block of memory, and hands out consecutive, ALLOC_ALIGN-aligned pieces of it;
+ * nothing is freed individually, instead the whole arena is reset (or rewound
+ * to a mark) once the workspace is no longer needed. Allocating from an arena
+ * is just a pointer increment, and never touches the heap.
+ *
+ * The size of the workspace needed by each solver can be found with its
+ * `*_work_size` function, so a loop of solves typically looks like
+ *   arena *a = arena_thread(block_solve_work_size(n, m) * sizeof(double));
+ *   for (...) {
+ *     arena_reset(a);
+ *     double *work = arena_alloc_d(a, block_solve_work_size(n, m));
+ *     block_solve(..., work, n, m);
+ *   }
+ * where the only heap allocation is made by the first call to arena_thread.
+ */
+typedef struct {
+  unsigned char *mem; // memory backing the arena
+  size_t size; // size of the arena, in bytes
+  size_t used; // number of bytes currently allocated
+  size_t peak; // largest number of bytes allocated since initialisation
+} arena;
+
+/**
+ * Prepares an arena of the given size.
+ *
+ * @param a arena to initialise, must be freed with arena_free
+ * @param size size of the arena, in bytes
+ * @return 0 on success, -1 on error
+ */
+int arena_init(arena *a, size_t size);
+
+/**
+ * Frees the memory held by an arena.
+ *
+ * @param a arena to free
+ */
+void arena_free(arena *a);
+
+/**
+ * Allocates memory from an arena. The memory is aligned to ALLOC_ALIGN bytes,
+ * and remains valid until the arena is reset past it.
+ *
+ * @param a arena
+ * @param size number of bytes to allocate
+ * @return pointer to the memory, or NULL if the arena is exhausted
+ */
+void *arena_alloc(arena *a, size_t size);
+
+/**
+ * Allocates an array of doubles from an arena.
+ *
+ * @param a arena
+ * @param n number of doubles to allocate
+ * @return pointer to the array, or NULL if the arena is exhausted
+ */
+double *arena_alloc_d(arena *a, size_t n);
+
+/**
+ * Returns a mark which can be passed to arena_release to free everything
+ * allocated after this point.
+ *
+ * @param a arena
+ * @return the current position in the arena
+ */
+size_t arena_mark(const arena *a);
+
+/**
+ * Frees everything allocated from an arena since the given mark.
+ *
+ * @param a arena
+ * @param mark position returned by arena_mark
+ */
+void arena_release(arena *a, size_t mark);
+
+/**
+ * Frees everything allocated from an arena.
+ *
+ * @param a arena
+ */
+void arena_reset(arena *a);
+
+/**
+ * Returns the arena belonging to the calling thread, reset and with room for
+ * at least size bytes.
+ *
+ * Each thread has its own arena, so this may be called from inside an OpenMP
+ * parallel region. The arena is only reallocated if it is too small, so after
+ * the first call of a solve loop no further heap allocations are made. The
+ * arena should be freed with arena_thread_free by each thread that used it.
+ *
+ * @param size minimum size of the arena, in bytes
+ * @return the calling thread's arena, or NULL on error
+ */
+arena *arena_thread(size_t size);
+
+/**
+ * Frees the arena belonging to the calling thread.
+ */
+void arena_thread_free(void);
+
+#endif // ARENA_H
@@ -0,0 +1,205 @@
+/**
+ * All the products are computed as out = alpha A x + beta in, where `in` is
+ * NULL for a plain matrix-vector product. The first and last rows (which are
+ * the only ones affected by truncation or wrapping of the diagonals) are
+ * handled separately, so that the loop over the interior rows is branch-free.
+ */
+
+#include "band_matvec.h"
+
+#include <math.h>
+#include <stddef.h>
+
+/**
+ * Computes the ith entry of A x for a banded matrix with half-bandwidth w.
+ *
+ * @param a diagonals of A, from the lowest to the highest
+ * @param w half-bandwidth, so there are 2w+1 diagonals
+ * @param x input vector
+ * @param i row
+ * @param n size of the matrix
+ * @param cyclic whether diagonals wrap around the corners of the matrix
+ * @return the ith entry of A x
+ */
+static double edge_row(
+    const double *const *a, const int w, const double *x, const int i,
+    const int n, const int cyclic
+) {
+  double sum = 0.0;
+  for (int k = -w; k <= w; k++) {
+    int j = i + k;
+    if (j < 0 || j >= n) {
+      if (!cyclic) {
+        continue; // entry lies outside the matrix
+      }
+      j = (j + n) % n;
+    }
+    sum += a[k + w][i] * x[j];
+  }
+  return sum;
+}
+
+/**
+ * Returns the input of a gemv, which is NULL when beta is zero so that y is
+ * overwritten (as in BLAS) and any NaNs or infinities already in it are not
+ * propagated.
+ */
+static const double *gemv_input(const double beta, const double *y) {
+  return (fpclassify(beta) == FP_ZERO) ? NULL : y;
+}
+
+/**
+ * Computes out = alpha A x + beta in, where A is (cyclic) tridiagonal.
+ */
+static void tri_apply(
+    const double alpha, const double *l, const double *d, const double *u,
+    const double *x, const double beta, const double *in, double *out,
+    const int n, const int cyclic
+) {
+  const double *const a[3] = {l, d, u};
+
+  // first and last rows
+  const int ends[2] = {0, n - 1};
+  for (int e = 0; e < 2; e++) {
+    const int i = ends[e];
+    const double Axi = edge_row(a, 1, x, i, n, cyclic);
+    out[i] = (in) ? alpha * Axi + beta * in[i] : alpha * Axi;
+  }
+
+  // central rows
+  if (in) {
+    for (int i = 1; i < n - 1; i++) {
+      const double Axi = l[i] * x[i - 1] + d[i] * x[i] + u[i] * x[i + 1];
+      out[i] = alpha * Axi + beta * in[i];
+    }
+  } else {
+    for (int i = 1; i < n - 1; i++) {
+      const double Axi = l[i] * x[i - 1] + d[i] * x[i] + u[i] * x[i + 1];
+      out[i] = alpha * Axi;
+    }
+  }
+}
+
+/**
+ * Computes out = alpha A x + beta in, where A is (cyclic) pentadiagonal.
+ */
+static void pent_apply(
+    const double alpha, const double *l2, const double *l1, const double *d0,
+    const double *u1, const double *u2, const double *x, const double beta,
+    const double *in, double *out, const int n, const int cyclic
+) {
+  const double *const a[5] = {l2, l1, d0, u1, u2};
+
+  // first two and last two rows
+  const int ends[4] = {0, 1, n - 2, n - 1};
+  for (int e = 0; e < 4; e++) {
+    const int i = ends[e];
+    const double Axi = edge_row(a, 2, x, i, n, cyclic);
+    out[i] = (in) ? alpha * Axi + beta * in[i] : alpha * Axi;
+  }
+
+  // central rows
+  if (in) {
+    for (int i = 2; i < n - 2; i++) {
+      const double Axi = l2[i] * x[i - 2] + l1[i] * x[i - 1] + d0[i] * x[i] +
+                         u1[i] * x[i + 1] + u2[i] * x[i + 2];
+      out[i] = alpha * Axi + beta * in[i];
+    }
+  } else {
+    for (int i = 2; i < n - 2; i++) {
+      const double Axi = l2[i] * x[i - 2] + l1[i] * x[i - 1] + d0[i] * x[i] +
+                         u1[i] * x[i + 1] + u2[i] * x[i + 2];
+      out[i] = alpha * Axi;
+    }
+  }
+}
+
+void tri_matvec(
+    const double *l, const double *d, const double *u, const double *x,
+    double *y, const int n
+) {
+  tri_apply(1.0, l, d, u, x, 0.0, NULL, y, n, 0);
+}
+
+void tri_gemv(
+    const double alpha, const double *l, const double *d, const double *u,
+    const double *x, const double beta, double *y, const int n
+) {
+  tri_apply(alpha, l, d, u, x, beta, gemv_input(beta, y), y, n, 0);
+}
+
+void tri_residual(
+    const double *l, const double *d, const double *u, const double *x,
+    const double *f, double *r, const int n
+) {
+  tri_apply(-1.0, l, d, u, x, 1.0, f, r, n, 0);
+}
+
+void cyclic_tri_matvec(
+    const double *l, const double *d, const double *u, const double *x,
+    double *y, const int n
+) {
+  tri_apply(1.0, l, d, u, x, 0.0, NULL, y, n, 1);
+}
+
+void cyclic_tri_gemv(
+    const double alpha, const double *l, const double *d, const double *u,
+    const double *x, const double beta, double *y, const int n
+) {
+  tri_apply(alpha, l, d, u, x, beta, gemv_input(beta, y), y, n, 1);
+}
+
+void cyclic_tri_residual(
+    const double *l, const double *d, const double *u, const double *x,
+    const double *f, double *r, const int n
+) {
+  tri_apply(-1.0, l, d, u, x, 1.0, f, r, n, 1);
+}
+
+void pent_matvec(
+    const double *l2, const double *l1, const double *d0, const double *u1,
+    const double *u2, const double *x, double *y, const int n
+) {
+  pent_apply(1.0, l2, l1, d0, u1, u2, x, 0.0, NULL, y, n, 0);
+}
+
+void pent_gemv(
+    const double alpha, const double *l2, const double *l1, const double *d0,
+    const double *u1, const double *u2, const double *x, const double beta,
+    double *y, const int n
+) {
+  pent_apply(
+      alpha, l2, l1, d0, u1, u2, x, beta, gemv_input(beta, y), y, n, 0
+  );
+}
+
+void pent_residual(
+    const double *l2, const double *l1, const double *d0, const double *u1,
+    const double *u2, const double *x, const double *f, double *r, const int n
+) {
+  pent_apply(-1.0, l2, l1, d0, u1, u2, x, 1.0, f, r, n, 0);
+}
+
+void cyclic_pent_matvec(
+    const double *l2, const double *l1, const double *d0, const double *u1,
+    const double *u2, const double *x, double *y, const int n
+) {
+  pent_apply(1.0, l2, l1, d0, u1, u2, x, 0.0, NULL, y, n, 1);
+}
+
+void cyclic_pent_gemv(
+    const double alpha, const double *l2, const double *l1, const double *d0,
+    const double *u1, const double *u2, const double *x, const double beta,
+    double *y, const int n
+) {
+  pent_apply(
+      alpha, l2, l1, d0, u1, u2, x, beta, gemv_input(beta, y), y, n, 1
+  );
+}
+
+void cyclic_pent_residual(
+    const double *l2, const double *l1, const double *d0, const double *u1,
+    const double *u2, const double *x, const double *f, double *r, const int n
+) {
+  pent_apply(-1.0, l2, l1, d0, u1, u2, x, 1.0, f, r, n, 1);
+}
@@ -0,0 +1,227 @@
+#ifndef BAND_MATVEC_H
+#define BAND_MATVEC_H
+
+/**
+ * Matrix-vector products for tridiagonal and pentadiagonal matrices, using the
+ * same diagonal storage as `tri_solve` and `pent_solve` (see those headers for
+ * the layout). The cyclic versions also use the corner entries, exactly as
+ * `cyclic_tri_solve` and `cyclic_pent_solve` do.
+ *
+ * Each function makes a single pass over its inputs, and the interior rows are
+ * written as simple loops that the compiler can vectorise. The input vector x
+ * must not overlap the output vector.
+ *
+ * Three forms are provided:
+ *   matvec:   y = A x
+ *   gemv:     y = alpha A x + beta y, where y is not read if beta is zero
+ *   residual: r = f - A x
+ * The residual may be computed in place, i.e. r may be the same as f.
+ */
+
+/**
+ * Computes y = A x, where A is tridiagonal.
+ *
+ * @param l lower diagonal
+ * @param d main diagonal
+ * @param u upper diagonal
+ * @param x input vector
+ * @param y output vector
+ * @param n size of the matrix (at least 2)
+ */
+void tri_matvec(
+    const double *l, const double *d, const double *u, const double *x,
+    double *y, int n
+);
+
+/**
+ * Computes y = alpha A x + beta y, where A is tridiagonal.
+ *
+ * @param alpha scale of the matrix-vector product
+ * @param l lower diagonal
+ * @param d main diagonal
+ * @param u upper diagonal
+ * @param x input vector
+ * @param beta scale of the existing output vector
+ * @param y output vector, overwritten with the result
+ * @param n size of the matrix (at least 2)
+ */
+void tri_gemv(
+    double alpha, const double *l, const double *d, const double *u,
+    const double *x, double beta, double *y, int n
+);
+
+/**
+ * Computes r = f - A x, where A is tridiagonal.
+ *
+ * @param l lower diagonal
+ * @param d main diagonal
+ * @param u upper diagonal
+ * @param x input vector
+ * @param f right-hand side vector
+ * @param r residual vector (may be the same as f)
+ * @param n size of the matrix (at least 2)
+ */
+void tri_residual(
+    const double *l, const double *d, const double *u, const double *x,
+    const double *f, double *r, int n
+);
+
+/**
+ * Computes y = A x, where A is cyclic and tridiagonal.
+ *
+ * @param l lower diagonal
+ * @param d main diagonal
+ * @param u upper diagonal
+ * @param x input vector
+ * @param y output vector
+ * @param n size of the matrix (at least 3)
+ */
+void cyclic_tri_matvec(
+    const double *l, const double *d, const double *u, const double *x,
+    double *y, int n
+);
+
+/**
+ * Computes y = alpha A x + beta y, where A is cyclic and tridiagonal.
+ *
+ * @param alpha scale of the matrix-vector product
+ * @param l lower diagonal
+ * @param d main diagonal
+ * @param u upper diagonal
+ * @param x input vector
+ * @param beta scale of the existing output vector
+ * @param y output vector, overwritten with the result
+ * @param n size of the matrix (at least 3)
+ */
+void cyclic_tri_gemv(
+    double alpha, const double *l, const double *d, const double *u,
+    const double *x, double beta, double *y, int n
+);
+
+/**
+ * Computes r = f - A x, where A is cyclic and tridiagonal.
+ *
+ * @param l lower diagonal
+ * @param d main diagonal
+ * @param u upper diagonal
+ * @param x input vector
+ * @param f right-hand side vector
+ * @param r residual vector (may be the same as f)
+ * @param n size of the matrix (at least 3)
+ */
+void cyclic_tri_residual(
+    const double *l, const double *d, const double *u, const double *x,
+    const double *f, double *r, int n
+);
+
+/**
+ * Computes y = A x, where A is pentadiagonal.
+ *
+ * @param l2 second lower diagonal
+ * @param l1 first lower diagonal
+ * @param d0 main diagonal
+ * @param u1 first upper diagonal
+ * @param u2 second upper diagonal
+ * @param x input vector
+ * @param y output vector
+ * @param n size of the matrix (at least 4)
+ */
+void pent_matvec(
+    const double *l2, const double *l1, const double *d0, const double *u1,
+    const double *u2, const double *x, double *y, int n
+);
+
+/**
+ * Computes y = alpha A x + beta y, where A is pentadiagonal.
+ *
+ * @param alpha scale of the matrix-vector product
+ * @param l2 second lower diagonal
+ * @param l1 first lower diagonal
+ * @param d0 main diagonal
+ * @param u1 first upper diagonal
+ * @param u2 second upper diagonal
+ * @param x input vector
+ * @param beta scale of the existing output vector
+ * @param y output vector, overwritten with the result
+ * @param n size of the matrix (at least 4)
+ */
+void pent_gemv(
+    double alpha, const double *l2, const double *l1, const double *d0,
+    const double *u1, const double *u2, const double *x, double beta,
+    double *y, int n
+);
+
+/**
+ * Computes r = f - A x, where A is pentadiagonal.
+ *
+ * @param l2 second lower diagonal
+ * @param l1 first lower diagonal
+ * @param d0 main diagonal
+ * @param u1 first upper diagonal
+ * @param u2 second upper diagonal
+ * @param x input vector
+ * @param f right-hand side vector
+ * @param r residual vector (may be the same as f)
+ * @param n size of the matrix (at least 4)
+ */
+void pent_residual(
+    const double *l2, const double *l1, const double *d0, const double *u1,
+    const double *u2, const double *x, const double *f, double *r, int n
+);
+
+/**
+ * Computes y = A x, where A is cyclic and pentadiagonal.
+ *
+ * @param l2 second lower diagonal
+ * @param l1 first lower diagonal
+ * @param d0 main diagonal
+ * @param u1 first upper diagonal
+ * @param u2 second upper diagonal
+ * @param x input vector
+ * @param y output vector
+ * @param n size of the matrix (at least 5)
+ */
+void cyclic_pent_matvec(
+    const double *l2, const double *l1, const double *d0, const double *u1,
+    const double *u2, const double *x, double *y, int n
+);
+
+/**
+ * Computes y = alpha A x + beta y, where A is cyclic and pentadiagonal.
+ *
+ * @param alpha scale of the matrix-vector product
+ * @param l2 second lower diagonal
+ * @param l1 first lower diagonal
+ * @param d0 main diagonal
+ * @param u1 first upper diagonal
+ * @param u2 second upper diagonal
+ * @param x input vector
+ * @param beta scale of the existing output vector
+ * @param y output vector, overwritten with the result
+ * @param n size of the matrix (at least 5)
+ */
+void cyclic_pent_gemv(
+    double alpha, const double *l2, const double *l1, const double *d0,
+    const double *u1, const double *u2, const double *x, double beta,
+    double *y, int n
+);
+
+/**
+ * Computes r = f - A x, where A is cyclic and pentadiagonal.
+ *
+ * @param l2 second lower diagonal
+ * @param l1 first lower diagonal
+ * @param d0 main diagonal
+ * @param u1 first upper diagonal
+ * @param u2 second upper diagonal
+ * @param x input vector
+ * @param f right-hand side vector
+ * @param r residual vector (may be the same as f)
+ * @param n size of the matrix (at least 5)
+ */
+void cyclic_pent_residual(
+    const double *l2, const double *l1, const double *d0, const double *u1,
+    const double *u2, const double *x, const double *f, double *r, int n
+);
+
+#endif // BAND_MATVEC_H
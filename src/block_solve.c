@@ -5,50 +5,297 @@
 
 #include "block_solve.h"
 
+#include <stddef.h>
 #include <string.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "lu_solve.h"
+#include "pent_solve.h"
+#include "tri_solve.h"
 
-int block_solve(
-    double *A, const double *B, const double *C, double *D, double *a,
-    double *b, int *pivn, int *pivm, double *work, const int n, const int m
+/* dense sub-solver */
+static int lu_factorise_s(block_sub_solver *s, const int n) {
+  return lu_factorise(s->v[0], s->piv, n);
+}
+
+static void lu_solve_s(const block_sub_solver *s, double *f, const int n) {
+  lu_solve_factorised(s->v[0], s->piv, f, n);
+}
+
+static void lu_solve_multi_s(
+    const block_sub_solver *s, double *F, const int n, const int m
 ) {
-  // solve a = A \ a
-  int err = lu_solve(A, a, pivn, n);
+  lu_solve_factorised_multi(s->v[0], s->piv, F, n, m);
+}
+
+/* identity sub-solver */
+static int identity_factorise_s(block_sub_solver *s, const int n) {
+  (void)s;
+  (void)n;
+  return 0;
+}
+
+static void
+identity_solve_s(const block_sub_solver *s, double *f, const int n) {
+  (void)s;
+  (void)f;
+  (void)n;
+}
+
+static void identity_solve_multi_s(
+    const block_sub_solver *s, double *F, const int n, const int m
+) {
+  (void)s;
+  (void)F;
+  (void)n;
+  (void)m;
+}
+
+/* tridiagonal sub-solver */
+static int tri_factorise_s(block_sub_solver *s, const int n) {
+  tri_lu_factorise(s->v[0], s->v[1], s->v[2], n);
+  return 0;
+}
+
+static void tri_solve_s(const block_sub_solver *s, double *f, const int n) {
+  tri_lu_solve(s->v[0], s->v[1], s->v[2], f, n);
+}
+
+static void tri_solve_multi_s(
+    const block_sub_solver *s, double *F, const int n, const int m
+) {
+  tri_lu_solve_multi(s->v[0], s->v[1], s->v[2], F, n, m);
+}
+
+/* cyclic tridiagonal sub-solver */
+static int cyclic_tri_factorise_s(block_sub_solver *s, const int n) {
+  cyclic_tri_lu_factorise(s->v[0], s->v[1], s->v[2], s->v[3], n);
+  return 0;
+}
+
+static void
+cyclic_tri_solve_s(const block_sub_solver *s, double *f, const int n) {
+  cyclic_tri_lu_solve(s->v[0], s->v[1], s->v[2], s->v[3], f, n);
+}
+
+static void cyclic_tri_solve_multi_s(
+    const block_sub_solver *s, double *F, const int n, const int m
+) {
+  cyclic_tri_lu_solve_multi(s->v[0], s->v[1], s->v[2], s->v[3], F, n, m);
+}
+
+/* pentadiagonal sub-solver */
+static int pent_factorise_s(block_sub_solver *s, const int n) {
+  double *const *v = s->v;
+  pent_lu_factorise(v[0], v[1], v[2], v[3], v[4], n);
+  return 0;
+}
+
+static void pent_solve_s(const block_sub_solver *s, double *f, const int n) {
+  double *const *v = s->v;
+  pent_lu_solve(v[0], v[1], v[2], v[3], v[4], f, n);
+}
+
+static void pent_solve_multi_s(
+    const block_sub_solver *s, double *F, const int n, const int m
+) {
+  double *const *v = s->v;
+  pent_lu_solve_multi(v[0], v[1], v[2], v[3], v[4], F, n, m);
+}
+
+/* cyclic pentadiagonal sub-solver */
+static int cyclic_pent_factorise_s(block_sub_solver *s, const int n) {
+  double *const *v = s->v;
+  cyclic_pent_lu_factorise(v[0], v[1], v[2], v[3], v[4], v[5], v[6], n);
+  return 0;
+}
+
+static void
+cyclic_pent_solve_s(const block_sub_solver *s, double *f, const int n) {
+  double *const *v = s->v;
+  cyclic_pent_lu_solve(v[0], v[1], v[2], v[3], v[4], v[5], v[6], f, n);
+}
+
+static void cyclic_pent_solve_multi_s(
+    const block_sub_solver *s, double *F, const int n, const int m
+) {
+  double *const *v = s->v;
+  cyclic_pent_lu_solve_multi(v[0], v[1], v[2], v[3], v[4], v[5], v[6], F, n, m);
+}
+
+void block_sub_solver_lu(block_sub_solver *s, double *A, int *piv) {
+  memset(s, 0, sizeof(block_sub_solver));
+  s->factorise = lu_factorise_s;
+  s->solve = lu_solve_s;
+  s->solve_multi = lu_solve_multi_s;
+  s->v[0] = A;
+  s->piv = piv;
+}
+
+void block_sub_solver_identity(block_sub_solver *s) {
+  memset(s, 0, sizeof(block_sub_solver));
+  s->factorise = identity_factorise_s;
+  s->solve = identity_solve_s;
+  s->solve_multi = identity_solve_multi_s;
+}
+
+void block_sub_solver_tri(
+    block_sub_solver *s, double *l, double *d, double *u
+) {
+  memset(s, 0, sizeof(block_sub_solver));
+  s->factorise = tri_factorise_s;
+  s->solve = tri_solve_s;
+  s->solve_multi = tri_solve_multi_s;
+  s->v[0] = l;
+  s->v[1] = d;
+  s->v[2] = u;
+}
+
+void block_sub_solver_cyclic_tri(
+    block_sub_solver *s, double *l, double *d, double *u, double *q
+) {
+  memset(s, 0, sizeof(block_sub_solver));
+  s->factorise = cyclic_tri_factorise_s;
+  s->solve = cyclic_tri_solve_s;
+  s->solve_multi = cyclic_tri_solve_multi_s;
+  s->v[0] = l;
+  s->v[1] = d;
+  s->v[2] = u;
+  s->v[3] = q;
+}
+
+void block_sub_solver_pent(
+    block_sub_solver *s, double *l2, double *l1, double *d0, double *u1,
+    double *u2
+) {
+  memset(s, 0, sizeof(block_sub_solver));
+  s->factorise = pent_factorise_s;
+  s->solve = pent_solve_s;
+  s->solve_multi = pent_solve_multi_s;
+  s->v[0] = l2;
+  s->v[1] = l1;
+  s->v[2] = d0;
+  s->v[3] = u1;
+  s->v[4] = u2;
+}
+
+void block_sub_solver_cyclic_pent(
+    block_sub_solver *s, double *l2, double *l1, double *d0, double *u1,
+    double *u2, double *k0, double *k1
+) {
+  memset(s, 0, sizeof(block_sub_solver));
+  s->factorise = cyclic_pent_factorise_s;
+  s->solve = cyclic_pent_solve_s;
+  s->solve_multi = cyclic_pent_solve_multi_s;
+  s->v[0] = l2;
+  s->v[1] = l1;
+  s->v[2] = d0;
+  s->v[3] = u1;
+  s->v[4] = u2;
+  s->v[5] = k0;
+  s->v[6] = k1;
+}
+
+/**
+ * Computes Y = Y - M X, where M is r x c, and X and Y have k columns.
+ */
+static void sub_product(
+    double *Y, const double *M, const double *X, const int r, const int c,
+    const int k
+) {
+  for (int i = 0; i < r; i++) {
+    for (int l = 0; l < c; l++) { // apply to entire row
+      const double Mil = M[(size_t)i * c + l];
+      for (int j = 0; j < k; j++) {
+        Y[(size_t)i * k + j] -= Mil * X[(size_t)l * k + j];
+      }
+    }
+  }
+}
+
+int block_factorise_with(
+    block_sub_solver *sa, const double *B, const double *C, double *D,
+    block_sub_solver *ss, double *AB, const int n, const int m
+) {
+  int err = sa->factorise(sa, n);
   if (err != 0) {
     return err;
   }
 
-  // store a copy of B
-  double *AB = work;
-  memcpy(AB, B, m * n * sizeof(double));
+  // compute AB = A \ B
+  memcpy(AB, B, (size_t)n * m * sizeof(double));
+  sa->solve_multi(sa, AB, n, m);
 
   // compute S = D - C A \ B
-  lu_solve_factorised_multi(A, pivn, AB, n, m);
-  for (int i = 0; i < m; i++) {
-    for (int j = 0; j < m; j++) {
-      for (int k = 0; k < n; k++) {
-        D[i * m + j] -= C[i * n + k] * AB[k * m + j];
-      }
+  sub_product(D, C, AB, m, n, m);
+
+  return ss->factorise(ss, m);
+}
+
+void block_solve_factorised_with(
+    const block_sub_solver *sa, const double *AB, const double *C,
+    const block_sub_solver *ss, double *a, double *b, const int n, const int m
+) {
+  block_solve_factorised_multi_with(sa, AB, C, ss, a, b, n, m, 1);
+}
+
+void block_solve_factorised_multi_with(
+    const block_sub_solver *sa, const double *AB, const double *C,
+    const block_sub_solver *ss, double *Fa, double *Fb, const int n,
+    const int m, const int k
+) {
+  // solve Fa = A \ Fa
+  sa->solve_multi(sa, Fa, n, k);
+
+  // solve Fb = S \ (Fb - C Fa)
+  sub_product(Fb, C, Fa, m, n, k);
+  ss->solve_multi(ss, Fb, m, k);
+
+  // compute Fa = Fa - (A \ B) Fb
+  sub_product(Fa, AB, Fb, n, m, k);
+}
+
+int block_solve_with(
+    block_sub_solver *sa, const double *B, const double *C, double *D,
+    block_sub_solver *ss, double *a, double *b, double *work, const int n,
+    const int m
+) {
+  if (D) {
+    double *AB = work;
+    const int err = block_factorise_with(sa, B, C, D, ss, AB, n, m);
+    if (err != 0) {
+      return err;
     }
+    block_solve_factorised_with(sa, AB, C, ss, a, b, n, m);
+    return 0;
+  }
+
+  // solve a = A \ a
+  int err = sa->factorise(sa, n);
+  if (err != 0) {
+    return err;
   }
+  sa->solve(sa, a, n);
 
   // compute z = C a
-  double *z = work + m * n; // here we're using m entries, later we will use n
+  double *z = work; // here we're using m entries, later we will use n
   for (int i = 0; i < m; i++) {
     z[i] = 0.0;
     for (int j = 0; j < n; j++) {
-      z[i] += C[i * n + j] * a[j];
+      z[i] += C[(size_t)i * n + j] * a[j];
     }
   }
 
   // solve z = S \ z, b = S \ b
-  err = lu_factorise(D, pivm, m);
+  err = ss->factorise(ss, m);
   if (err != 0) {
     return err;
   }
-  lu_solve_factorised(D, pivm, z, m);
-  lu_solve_factorised(D, pivm, b, m);
+  ss->solve(ss, z, m);
+  ss->solve(ss, b, m);
 
   // compute b = b - z
   for (int i = 0; i < m; i++) {
@@ -56,16 +303,16 @@ int block_solve(
   }
 
   // z = B b
-  // now using m entries of z
+  // now using n entries of z
   for (int i = 0; i < n; i++) {
     z[i] = 0.0;
     for (int j = 0; j < m; j++) {
-      z[i] += B[i * m + j] * b[j];
+      z[i] += B[(size_t)i * m + j] * b[j];
     }
   }
 
   // z = A \ z
-  lu_solve_factorised(A, pivn, z, n);
+  sa->solve(sa, z, n);
 
   // a = a - z
   for (int i = 0; i < n; i++) {
@@ -75,45 +322,278 @@ int block_solve(
   return 0;
 }
 
-int block_solve_simplified(
-    const double *B, const double *C, double *S, double *a, double *b,
-    int *pivm, double *work, const int n, const int m
+size_t block_solve_panelled_work_size(
+    const int n, const int m, int p, const int nthreads
 ) {
-  // compute z = C a
-  double *z = work; // here we're using m entries, later we will use n
-  for (int i = 0; i < m; i++) {
-    z[i] = 0.0;
-    for (int j = 0; j < n; j++) {
-      z[i] += C[i * n + j] * a[j];
+  p = (p < m) ? p : m;
+  if (p < 1 || nthreads < 1) {
+    return (size_t)n;
+  }
+  return (size_t)nthreads * (size_t)n * (size_t)p + (size_t)n;
+}
+
+int block_solve_panelled_with(
+    block_sub_solver *sa, const double *B, const double *C, double *D,
+    block_sub_solver *ss, double *a, double *b, double *work, const int n,
+    const int m, int p, const int nthreads
+) {
+  if (p > m) {
+    p = m;
+  }
+  if (p < 1 || nthreads < 1) {
+    return -1;
+  }
+
+  int err = sa->factorise(sa, n);
+  if (err != 0) {
+    return err;
+  }
+
+  // compute S = D - C A \ B one panel of p columns at a time, each of which
+  // only updates the matching columns of S
+  const int npanel = (m + p - 1) / p;
+#ifdef _OPENMP
+  // the team is never larger than nthreads, so each thread has its own panel
+#pragma omp parallel num_threads(nthreads)
+#endif
+  {
+#ifdef _OPENMP
+    double *P = work + (size_t)omp_get_thread_num() * n * p;
+#else
+    double *P = work;
+#endif
+
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+    for (int q = 0; q < npanel; q++) {
+      const int j0 = q * p;
+      const int w = (m - j0 < p) ? m - j0 : p;
+
+      // copy the panel of B into contiguous memory and solve P = A \ P
+      for (int i = 0; i < n; i++) {
+        memcpy(P + (size_t)i * w, B + (size_t)i * m + j0, w * sizeof(double));
+      }
+      sa->solve_multi(sa, P, n, w);
+
+      // S[:, j0:j0+w] -= C P
+      for (int i = 0; i < m; i++) {
+        double *Si = D + (size_t)i * m + j0;
+        for (int l = 0; l < n; l++) { // apply to entire row
+          const double Cil = C[(size_t)i * n + l];
+          for (int j = 0; j < w; j++) {
+            Si[j] -= Cil * P[(size_t)l * w + j];
+          }
+        }
+      }
     }
   }
 
-  // solve z = S \ z, b = S \ b
-  const int err = lu_factorise(S, pivm, m);
+  err = ss->factorise(ss, m);
   if (err != 0) {
     return err;
   }
-  lu_solve_factorised(S, pivm, z, m);
-  lu_solve_factorised(S, pivm, b, m);
 
-  // compute b = b - z
+  // solve a = A \ a, then b = S \ (b - C a)
+  sa->solve(sa, a, n);
   for (int i = 0; i < m; i++) {
-    b[i] -= z[i];
+    for (int j = 0; j < n; j++) {
+      b[i] -= C[(size_t)i * n + j] * a[j];
+    }
   }
+  ss->solve(ss, b, m);
 
-  // z = B b
-  // now using m entries of z
+  // a = a - A \ (B b)
+  double *z = work;
   for (int i = 0; i < n; i++) {
     z[i] = 0.0;
     for (int j = 0; j < m; j++) {
-      z[i] += B[i * m + j] * b[j];
+      z[i] += B[(size_t)i * m + j] * b[j];
     }
   }
+  sa->solve(sa, z, n);
+  for (int i = 0; i < n; i++) {
+    a[i] -= z[i];
+  }
 
-  // a = a - z
+  return 0;
+}
+
+int block_solve_panelled(
+    double *A, const double *B, const double *C, double *D, double *a,
+    double *b, int *pivn, int *pivm, double *work, const int n, const int m,
+    const int p, const int nthreads
+) {
+  block_sub_solver sa, ss;
+  block_sub_solver_lu(&sa, A, pivn);
+  block_sub_solver_lu(&ss, D, pivm);
+  return block_solve_panelled_with(
+      &sa, B, C, D, &ss, a, b, work, n, m, p, nthreads
+  );
+}
+
+size_t block_solve_symmetric_work_size(const int n, const int m) {
+  return (size_t)n * (size_t)((m > 1) ? m : 1);
+}
+
+int block_solve_symmetric(
+    double *A, const double *B, double *D, double *a, double *b, double *work,
+    const int n, const int m
+) {
+  int err = ldlt_factorise(A, n);
+  if (err != 0) {
+    return err;
+  }
+
+  // compute W = L \ B, where A = L D_A L^T
+  double *W = work;
+  memcpy(W, B, (size_t)n * m * sizeof(double));
+  ldlt_solve_lower_multi(A, W, n, m);
+
+  // compute the lower triangle of S = D - B^T A \ B = D - W^T D_A^-1 W as a
+  // symmetric rank-n update
+  for (int k = 0; k < n; k++) {
+    const double *Wk = W + (size_t)k * m;
+    const double dk = A[(size_t)k * n + k];
+    for (int i = 0; i < m; i++) {
+      const double s = Wk[i] / dk;
+      for (int j = 0; j <= i; j++) {
+        D[(size_t)i * m + j] -= s * Wk[j];
+      }
+    }
+  }
+
+  err = ldlt_factorise(D, m);
+  if (err != 0) {
+    return err;
+  }
+
+  // solve a = A \ a, then b = S \ (b - B^T a)
+  ldlt_solve_factorised(A, a, n);
+  for (int k = 0; k < n; k++) {
+    for (int i = 0; i < m; i++) { // apply to entire row of B
+      b[i] -= B[(size_t)k * m + i] * a[k];
+    }
+  }
+  ldlt_solve_factorised(D, b, m);
+
+  // a = a - A \ (B b)
+  double *z = work;
+  for (int i = 0; i < n; i++) {
+    z[i] = 0.0;
+    for (int j = 0; j < m; j++) {
+      z[i] += B[(size_t)i * m + j] * b[j];
+    }
+  }
+  ldlt_solve_factorised(A, z, n);
   for (int i = 0; i < n; i++) {
     a[i] -= z[i];
   }
 
   return 0;
 }
+
+int block_factorise(
+    double *A, const double *B, const double *C, double *D, double *AB,
+    int *pivn, int *pivm, const int n, const int m
+) {
+  block_sub_solver sa, ss;
+  block_sub_solver_lu(&sa, A, pivn);
+  block_sub_solver_lu(&ss, D, pivm);
+  return block_factorise_with(&sa, B, C, D, &ss, AB, n, m);
+}
+
+void block_solve_factorised(
+    const double *LUA, const double *AB, const double *C, const double *LUS,
+    double *a, double *b, int *pivn, int *pivm, const int n, const int m
+) {
+  block_solve_factorised_multi(LUA, AB, C, LUS, a, b, pivn, pivm, n, m, 1);
+}
+
+void block_solve_factorised_multi(
+    const double *LUA, const double *AB, const double *C, const double *LUS,
+    double *Fa, double *Fb, int *pivn, int *pivm, const int n, const int m,
+    const int k
+) {
+  // as for block_solve_factorised_multi_with, but the dense LU solves are
+  // called directly so that the factorisations can be passed as const
+  lu_solve_factorised_multi(LUA, pivn, Fa, n, k);
+  sub_product(Fb, C, Fa, m, n, k);
+  lu_solve_factorised_multi(LUS, pivm, Fb, m, k);
+  sub_product(Fa, AB, Fb, n, m, k);
+}
+
+size_t block_solve_work_size(const int n, const int m) {
+  const size_t nm = (size_t)n * (size_t)m;
+  const size_t k = (size_t)((n > m) ? n : m);
+  return (nm > k) ? nm : k;
+}
+
+int block_solve(
+    double *A, const double *B, const double *C, double *D, double *a,
+    double *b, int *pivn, int *pivm, double *work, const int n, const int m
+) {
+  block_sub_solver sa, ss;
+  block_sub_solver_lu(&sa, A, pivn);
+  block_sub_solver_lu(&ss, D, pivm);
+  return block_solve_with(&sa, B, C, D, &ss, a, b, work, n, m);
+}
+
+/**
+ * Returns the number of doubles needed to pack M, or 0 if it can be used in
+ * place.
+ */
+static size_t pack_size(const matrix *M) {
+  return matrix_is_contiguous(M) ? 0 : (size_t)M->rows * (size_t)M->cols;
+}
+
+/**
+ * Returns a pointer to the flattened entries of M, packing them into *work
+ * (which is then advanced) if M is not contiguous.
+ */
+static double *packed(const matrix *M, double **work) {
+  if (matrix_is_contiguous(M)) {
+    return M->data;
+  }
+
+  matrix P;
+  matrix_wrap(&P, *work, M->rows, M->cols, M->cols);
+  matrix_copy(&P, M);
+  *work += pack_size(M);
+  return P.data;
+}
+
+size_t matrix_block_solve_work_size(
+    const matrix *A, const matrix *B, const matrix *C, const matrix *D
+) {
+  return pack_size(A) + pack_size(B) + pack_size(C) + pack_size(D) +
+         block_solve_work_size(A->rows, D->rows);
+}
+
+int matrix_block_solve(
+    matrix *A, const matrix *B, const matrix *C, matrix *D, double *a,
+    double *b, int *pivn, int *pivm, double *work
+) {
+  const int n = A->rows;
+  const int m = D->rows;
+  if (A->cols != n || D->cols != m || B->rows != n || B->cols != m ||
+      C->rows != m || C->cols != n) {
+    return -1;
+  }
+
+  double *PA = packed(A, &work);
+  const double *PB = packed(B, &work);
+  const double *PC = packed(C, &work);
+  double *PD = packed(D, &work);
+  return block_solve(PA, PB, PC, PD, a, b, pivn, pivm, work, n, m);
+}
+
+int block_solve_simplified(
+    const double *B, const double *C, double *S, double *a, double *b,
+    int *pivm, double *work, const int n, const int m
+) {
+  block_sub_solver sa, ss;
+  block_sub_solver_identity(&sa);
+  block_sub_solver_lu(&ss, S, pivm);
+  return block_solve_with(&sa, B, C, NULL, &ss, a, b, work, n, m);
+}
@@ -1,6 +1,114 @@
 #ifndef BLOCK_SOLVE_H
 #define BLOCK_SOLVE_H
 
+#include <stddef.h>
+
+#include "matrix.h"
+
+/**
+ * Solver for one of the diagonal blocks of a block system, used by
+ * `block_solve_with`.
+ *
+ * The block solve only ever needs to factorise a block and then apply its
+ * inverse to one or more vectors, so any structure in the blocks can be
+ * exploited by supplying a solver which does this efficiently. Solvers for
+ * dense, identity, (cyclic) tridiagonal and (cyclic) pentadiagonal blocks are
+ * provided by the block_sub_solver_* functions below. A custom solver can be
+ * built by setting the function pointers directly, using `ctx` to hold its
+ * data.
+ *
+ * The matrix data is not owned by the solver, and is overwritten with the
+ * factorisation, exactly as for the underlying solve functions.
+ */
+typedef struct block_sub_solver block_sub_solver;
+struct block_sub_solver {
+  // factorise the n x n block in place, returning 0 on success
+  int (*factorise)(block_sub_solver *s, int n);
+  // solve x = M \ f in place using the factorisation
+  void (*solve)(const block_sub_solver *s, double *f, int n);
+  // solve X = M \ F in place for the m columns of the n x m matrix F, only
+  // reading the factorisation so that it may be called concurrently
+  void (*solve_multi)(const block_sub_solver *s, double *F, int n, int m);
+  double *v[7]; // matrix (and extra) storage used by the built-in solvers
+  int *piv; // pivot array used by the built-in dense solver
+  void *ctx; // data for custom solvers
+};
+
+/**
+ * Sets up a sub-solver for a dense block, using `lu_solve`.
+ *
+ * @param s sub-solver to initialise
+ * @param A block (n x n), overwritten with its LU factorisation
+ * @param piv pivot array for A, size n
+ */
+void block_sub_solver_lu(block_sub_solver *s, double *A, int *piv);
+
+/**
+ * Sets up a sub-solver for an identity block, which does nothing.
+ *
+ * @param s sub-solver to initialise
+ */
+void block_sub_solver_identity(block_sub_solver *s);
+
+/**
+ * Sets up a sub-solver for a tridiagonal block, using `tri_solve`.
+ *
+ * @param s sub-solver to initialise
+ * @param l lower diagonal
+ * @param d main diagonal
+ * @param u upper diagonal
+ */
+void block_sub_solver_tri(
+    block_sub_solver *s, double *l, double *d, double *u
+);
+
+/**
+ * Sets up a sub-solver for a cyclic tridiagonal block, using
+ * `cyclic_tri_solve`.
+ *
+ * @param s sub-solver to initialise
+ * @param l lower diagonal
+ * @param d main diagonal
+ * @param u upper diagonal
+ * @param q workspace vector, size n
+ */
+void block_sub_solver_cyclic_tri(
+    block_sub_solver *s, double *l, double *d, double *u, double *q
+);
+
+/**
+ * Sets up a sub-solver for a pentadiagonal block, using `pent_solve`.
+ *
+ * @param s sub-solver to initialise
+ * @param l2 second lower diagonal
+ * @param l1 first lower diagonal
+ * @param d0 main diagonal
+ * @param u1 first upper diagonal
+ * @param u2 second upper diagonal
+ */
+void block_sub_solver_pent(
+    block_sub_solver *s, double *l2, double *l1, double *d0, double *u1,
+    double *u2
+);
+
+/**
+ * Sets up a sub-solver for a cyclic pentadiagonal block, using
+ * `cyclic_pent_solve`.
+ *
+ * @param s sub-solver to initialise
+ * @param l2 second lower diagonal
+ * @param l1 first lower diagonal
+ * @param d0 main diagonal
+ * @param u1 first upper diagonal
+ * @param u2 second upper diagonal
+ * @param k0 workspace vector, size n
+ * @param k1 workspace vector, size n
+ */
+void block_sub_solver_cyclic_pent(
+    block_sub_solver *s, double *l2, double *l1, double *d0, double *u1,
+    double *u2, double *k0, double *k1
+);
+
 /**
  * Computes the solution to a system of linear equations decomposed into blocks.
  *
@@ -14,7 +122,7 @@
  * This solver uses a general LU factorisation of the blocks, and so will not be
  * any faster than just doing a full LU factorisation of the matrix R. However,
  * if A and/or S have some sort of structure (e.g. banded, triangular, etc.)
- * then the lu_solve calls can be replaced with more efficient versions, and the
+ * then `block_solve_with` can be used with more efficient sub-solvers, and the
  * block solve will be significantly faster.
  *
  * @param A upper left block
@@ -25,7 +133,8 @@
  * @param b lower right hand side
  * @param pivn pivot array for A
  * @param pivm pivot array for S
- * @param work interim workspace, should be at least size max(n*(m+1), (n+1)*m)
+ * @param work interim workspace, should be at least size
+ * block_solve_work_size(n, m)
  * @param n upper left block size
  * @param m lower right block size
  * @return 0 on success, -1 on error
@@ -57,4 +166,316 @@ int block_solve_simplified(
     int *pivm, double *work, int n, int m
 );
 
+/**
+ * As for `block_solve`, but with the solves for A and S performed by the given
+ * sub-solvers.
+ *
+ * If D is not NULL, it is overwritten with S = D - CA\B, so `ss` should be a
+ * dense solver acting on D (e.g. from `block_sub_solver_lu`). If D is NULL,
+ * then `ss` must already hold S, which is useful when S is known to have some
+ * structure or can be computed directly, in which case C A\B is never formed.
+ *
+ * @param sa sub-solver holding A, which is factorised
+ * @param B upper right block
+ * @param C lower left block
+ * @param D lower right block, or NULL if ss already holds S
+ * @param ss sub-solver holding S, which is factorised
+ * @param a upper right hand side
+ * @param b lower right hand side
+ * @param work interim workspace, should be at least size n*m, or max(n, m) if
+ * D is NULL
+ * @param n upper left block size
+ * @param m lower right block size
+ * @return 0 on success, otherwise the error from the failed factorisation
+ */
+int block_solve_with(
+    block_sub_solver *sa, const double *B, const double *C, double *D,
+    block_sub_solver *ss, double *a, double *b, double *work, int n, int m
+);
+
+/**
+ * Computes the size of the workspace needed by `block_solve`,
+ * `block_solve_simplified` and `block_solve_with`.
+ *
+ * @param n upper left block size
+ * @param m lower right block size
+ * @return the number of doubles needed for the workspace
+ */
+size_t block_solve_work_size(int n, int m);
+
+/**
+ * As for `block_solve`, but with the blocks given as matrix descriptors, so
+ * that they can be views into a larger matrix R = [A B; C D] (see
+ * `matrix_view`).
+ *
+ * Blocks which are contiguous in memory are used in place. Any others (e.g.
+ * the quadrants of R) are first packed into the workspace, in which case A and
+ * D are left untouched rather than being overwritten.
+ *
+ * @param A upper left block
+ * @param B upper right block
+ * @param C lower left block
+ * @param D lower right block
+ * @param a upper right hand side
+ * @param b lower right hand side
+ * @param pivn pivot array for A
+ * @param pivm pivot array for S
+ * @param work interim workspace, should be at least size
+ * matrix_block_solve_work_size(A, B, C, D)
+ * @return 0 on success, otherwise the error from the failed factorisation, or
+ * -1 if the blocks have inconsistent sizes
+ */
+int matrix_block_solve(
+    matrix *A, const matrix *B, const matrix *C, matrix *D, double *a,
+    double *b, int *pivn, int *pivm, double *work
+);
+
+/**
+ * Computes the size of the workspace needed by `matrix_block_solve`.
+ *
+ * @param A upper left block
+ * @param B upper right block
+ * @param C lower left block
+ * @param D lower right block
+ * @return the number of doubles needed for the workspace
+ */
+size_t matrix_block_solve_work_size(
+    const matrix *A, const matrix *B, const matrix *C, const matrix *D
+);
+
+/**
+ * As for `block_solve`, but forms the Schur complement S = D - CA\B from
+ * panels of p columns of B at a time, rather than computing all of A\B at
+ * once.
+ *
+ * Each panel is copied into the workspace, solved with A, and used to update
+ * the matching p columns of S, so the workspace is O(np) rather than O(nm).
+ * If OpenMP is enabled the panels are processed in parallel by at most
+ * nthreads threads, with one panel of workspace for each thread. The size of
+ * the workspace should be found with `block_solve_panelled_work_size`, with
+ * the same p and nthreads, so that it does not depend on the number of threads
+ * OpenMP would use by the time of the solve.
+ *
+ * @param A upper left block
+ * @param B upper right block
+ * @param C lower left block
+ * @param D lower right block
+ * @param a upper right hand side
+ * @param b lower right hand side
+ * @param pivn pivot array for A
+ * @param pivm pivot array for S
+ * @param work interim workspace
+ * @param n upper left block size
+ * @param m lower right block size
+ * @param p panel width, the number of columns of B solved at once
+ * @param nthreads most panels solved at once (only 1 is used without OpenMP)
+ * @return 0 on success, -1 on error (including if p or nthreads is less than 1)
+ */
+int block_solve_panelled(
+    double *A, const double *B, const double *C, double *D, double *a,
+    double *b, int *pivn, int *pivm, double *work, int n, int m, int p,
+    int nthreads
+);
+
+/**
+ * As for `block_solve_panelled`, but with the solves for A and S performed by
+ * the given sub-solvers, as in `block_solve_with`. If OpenMP is enabled, then
+ * `sa->solve_multi` is called from several threads at once on different
+ * panels, so it must be re-entrant: it may only read the shared factorisation
+ * (and any `ctx` data), and must not use shared scratch storage. All the
+ * built-in sub-solvers satisfy this.
+ *
+ * @param sa sub-solver holding A, which is factorised
+ * @param B upper right block
+ * @param C lower left block
+ * @param D lower right block, overwritten with S
+ * @param ss sub-solver holding S (i.e. acting on D), which is factorised
+ * @param a upper right hand side
+ * @param b lower right hand side
+ * @param work interim workspace
+ * @param n upper left block size
+ * @param m lower right block size
+ * @param p panel width, the number of columns of B solved at once
+ * @param nthreads most panels solved at once (only 1 is used without OpenMP)
+ * @return 0 on success, -1 if p or nthreads is less than 1, otherwise the error
+ * from the failed factorisation
+ */
+int block_solve_panelled_with(
+    block_sub_solver *sa, const double *B, const double *C, double *D,
+    block_sub_solver *ss, double *a, double *b, double *work, int n, int m,
+    int p, int nthreads
+);
+
+/**
+ * Computes the size of the workspace needed by `block_solve_panelled`. A
+ * typical choice of nthreads is omp_get_max_threads(), taken once and passed
+ * to both this and the solve.
+ *
+ * @param n upper left block size
+ * @param m lower right block size
+ * @param p panel width
+ * @param nthreads most panels solved at once
+ * @return the number of doubles needed for the workspace (just n if p or
+ * nthreads is less than 1, for which the solve fails)
+ */
+size_t block_solve_panelled_work_size(int n, int m, int p, int nthreads);
+
+/**
+ * Computes the solution to a symmetric block system R = [A B; B^T D], where A
+ * and D are symmetric, such as those arising from saddle-point or constrained
+ * problems.
+ *
+ * As for `block_solve`, but A and S = D - B^T A\B are factorised with
+ * `ldlt_factorise`, and only the lower triangle of S is formed, with a
+ * symmetric rank-n update. The lower left block is never read, and only the
+ * lower triangles of A and D are used. This roughly halves the work of
+ * `block_solve`. As there is no pivoting, the factorisations will fail if A or
+ * S has a zero pivot.
+ *
+ * @param A upper left block, lower triangle overwritten with its LDL^T
+ * factorisation
+ * @param B upper right block
+ * @param D lower right block, lower triangle overwritten with the LDL^T
+ * factorisation of S
+ * @param a upper right hand side
+ * @param b lower right hand side
+ * @param work interim workspace, should be at least size n*max(m, 1)
+ * @param n upper left block size
+ * @param m lower right block size
+ * @return 0 on success, otherwise the error from the failed factorisation
+ */
+int block_solve_symmetric(
+    double *A, const double *B, double *D, double *a, double *b, double *work,
+    int n, int m
+);
+
+/**
+ * Computes the size of the workspace needed by `block_solve_symmetric`.
+ *
+ * @param n upper left block size
+ * @param m lower right block size
+ * @return the number of doubles needed for the workspace
+ */
+size_t block_solve_symmetric_work_size(int n, int m);
+
+/**
+ * Factorises a block system R = [A B; C D] so that it can be solved repeatedly
+ * with `block_solve_factorised`.
+ *
+ * The factorisations of A and S = D - CA\B are kept, along with A\B, so that
+ * each subsequent solve only needs to apply the two factorisations and two
+ * matrix-vector products, i.e. O(n^2 + m^2 + nm) rather than O(n^3 + m^3).
+ *
+ * @param A upper left block, overwritten with its LU factorisation
+ * @param B upper right block
+ * @param C lower left block
+ * @param D lower right block, overwritten with the LU factorisation of S
+ * @param AB A\B (n x m), overwritten
+ * @param pivn pivot array for A
+ * @param pivm pivot array for S
+ * @param n upper left block size
+ * @param m lower right block size
+ * @return 0 on success, otherwise the error from the failed factorisation
+ */
+int block_factorise(
+    double *A, const double *B, const double *C, double *D, double *AB,
+    int *pivn, int *pivm, int n, int m
+);
+
+/**
+ * Given a factorisation from `block_factorise`, solves Rx = f in place.
+ *
+ * @param LUA LU factorisation of A
+ * @param AB A\B
+ * @param C lower left block
+ * @param LUS LU factorisation of S
+ * @param a upper right hand side, overwritten with the solution
+ * @param b lower right hand side, overwritten with the solution
+ * @param pivn pivot array for A
+ * @param pivm pivot array for S
+ * @param n upper left block size
+ * @param m lower right block size
+ */
+void block_solve_factorised(
+    const double *LUA, const double *AB, const double *C, const double *LUS,
+    double *a, double *b, int *pivn, int *pivm, int n, int m
+);
+
+/**
+ * Given a factorisation from `block_factorise`, solves RX = F in place for k
+ * right-hand side vectors.
+ *
+ * @param LUA LU factorisation of A
+ * @param AB A\B
+ * @param C lower left block
+ * @param LUS LU factorisation of S
+ * @param Fa upper rows of the right-hand side vectors (n x k)
+ * @param Fb lower rows of the right-hand side vectors (m x k)
+ * @param pivn pivot array for A
+ * @param pivm pivot array for S
+ * @param n upper left block size
+ * @param m lower right block size
+ * @param k number of right-hand side vectors
+ */
+void block_solve_factorised_multi(
+    const double *LUA, const double *AB, const double *C, const double *LUS,
+    double *Fa, double *Fb, int *pivn, int *pivm, int n, int m, int k
+);
+
+/**
+ * As for `block_factorise`, but with A and S factorised by the given
+ * sub-solvers. As for `block_solve_with`, `ss` should be a dense solver acting
+ * on D, which is overwritten with S.
+ *
+ * @param sa sub-solver holding A, which is factorised
+ * @param B upper right block
+ * @param C lower left block
+ * @param D lower right block, overwritten with S
+ * @param ss sub-solver holding S, which is factorised
+ * @param AB A\B (n x m), overwritten
+ * @param n upper left block size
+ * @param m lower right block size
+ * @return 0 on success, otherwise the error from the failed factorisation
+ */
+int block_factorise_with(
+    block_sub_solver *sa, const double *B, const double *C, double *D,
+    block_sub_solver *ss, double *AB, int n, int m
+);
+
+/**
+ * Given a factorisation from `block_factorise_with`, solves Rx = f in place.
+ *
+ * @param sa factorised sub-solver for A
+ * @param AB A\B
+ * @param C lower left block
+ * @param ss factorised sub-solver for S
+ * @param a upper right hand side, overwritten with the solution
+ * @param b lower right hand side, overwritten with the solution
+ * @param n upper left block size
+ * @param m lower right block size
+ */
+void block_solve_factorised_with(
+    const block_sub_solver *sa, const double *AB, const double *C,
+    const block_sub_solver *ss, double *a, double *b, int n, int m
+);
+
+/**
+ * Given a factorisation from `block_factorise_with`, solves RX = F in place for
+ * k right-hand side vectors.
+ *
+ * @param sa factorised sub-solver for A
+ * @param AB A\B
+ * @param C lower left block
+ * @param ss factorised sub-solver for S
+ * @param Fa upper rows of the right-hand side vectors (n x k)
+ * @param Fb lower rows of the right-hand side vectors (m x k)
+ * @param n upper left block size
+ * @param m lower right block size
+ * @param k number of right-hand side vectors
+ */
+void block_solve_factorised_multi_with(
+    const block_sub_solver *sa, const double *AB, const double *C,
+    const block_sub_solver *ss, double *Fa, double *Fb, int n, int m, int k
+);
+
 #endif // BLOCK_SOLVE_H
@@ -0,0 +1,165 @@
+/**
+ * The block Thomas algorithm is the tridiagonal LU factorisation with each
+ * scalar replaced by a block, see
+ *   https://en.wikipedia.org/wiki/Tridiagonal_matrix_algorithm#Block_tridiagonal_matrices
+ * Rather than inverting the diagonal blocks, we keep their LU factorisations
+ * and apply them with `lu_solve_factorised_multi`.
+ *
+ * The cyclic solver treats the last block row and column as a border, in the
+ * same way as the cyclic pentadiagonal solver.
+ */
+
+#include "block_tri_solve.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "lu_solve.h"
+
+/**
+ * Computes Y = Y - M X, where M is b x b and X and Y are b x m.
+ */
+static void block_sub_product(
+    double *Y, const double *M, const double *X, const int b, const int m
+) {
+  for (int i = 0; i < b; i++) {
+    for (int k = 0; k < b; k++) { // apply to entire row
+      const double Mik = M[i * b + k];
+      for (int j = 0; j < m; j++) {
+        Y[i * m + j] -= Mik * X[k * m + j];
+      }
+    }
+  }
+}
+
+int block_tri_lu_factorise(
+    const double *L, double *D, double *U, int *piv, const int n, const int b
+) {
+  const size_t bb = (size_t)b * b;
+
+  for (int i = 0; i < n; i++) {
+    if (i > 0) {
+      // D[i] = D[i] - L[i] G[i-1], where G[i-1] = D[i-1] \ U[i-1]
+      block_sub_product(D + i * bb, L + i * bb, U + (i - 1) * bb, b, b);
+    }
+
+    const int err = lu_factorise(D + i * bb, piv + i * b, b);
+    if (err != 0) {
+      return i * b + err; // return the row of the first zero pivot
+    }
+
+    if (i < n - 1) {
+      // overwrite U[i] with G[i] = D[i] \ U[i]
+      lu_solve_factorised_multi(D + i * bb, piv + i * b, U + i * bb, b, b);
+    }
+  }
+
+  return 0;
+}
+
+void block_tri_lu_solve_multi(
+    const double *L, const double *D, const double *U, int *piv, double *F,
+    const int n, const int b, const int m
+) {
+  const size_t bb = (size_t)b * b;
+  const size_t bm = (size_t)b * m;
+
+  // solve LY = F via forward substitution
+  for (int i = 0; i < n; i++) {
+    if (i > 0) {
+      block_sub_product(F + i * bm, L + i * bb, F + (i - 1) * bm, b, m);
+    }
+    lu_solve_factorised_multi(D + i * bb, piv + i * b, F + i * bm, b, m);
+  }
+
+  // solve UX = Y via backward substitution
+  for (int i = n - 2; i >= 0; i--) {
+    block_sub_product(F + i * bm, U + i * bb, F + (i + 1) * bm, b, m);
+  }
+}
+
+void block_tri_lu_solve(
+    const double *L, const double *D, const double *U, int *piv, double *f,
+    const int n, const int b
+) {
+  block_tri_lu_solve_multi(L, D, U, piv, f, n, b, 1);
+}
+
+int block_tri_solve(
+    const double *L, double *D, double *U, int *piv, double *f, const int n,
+    const int b
+) {
+  const int err = block_tri_lu_factorise(L, D, U, piv, n, b);
+  if (err != 0) {
+    return err;
+  }
+  block_tri_lu_solve(L, D, U, piv, f, n, b);
+  return 0;
+}
+
+int cyclic_block_tri_lu_factorise(
+    const double *L, double *D, double *U, double *K, int *piv, const int n,
+    const int b
+) {
+  const size_t bb = (size_t)b * b;
+
+  // factorise E, the first n-1 block rows and columns
+  int err = block_tri_lu_factorise(L, D, U, piv, n - 1, b);
+  if (err != 0) {
+    return err;
+  }
+
+  // set up the border column K, which has L[0] at the top and U[n-2] at the
+  // bottom, then compute E \ K
+  memset(K, 0, (n - 1) * bb * sizeof(double));
+  memcpy(K, L, bb * sizeof(double));
+  memcpy(K + (n - 2) * bb, U + (n - 2) * bb, bb * sizeof(double));
+  block_tri_lu_solve_multi(L, D, U, piv, K, n - 1, b, b);
+
+  // compute the Schur complement C - H E^-1 K in place of D[n-1], where H has
+  // U[n-1] on the left and L[n-1] on the right
+  double *S = D + (n - 1) * bb;
+  block_sub_product(S, U + (n - 1) * bb, K, b, b);
+  block_sub_product(S, L + (n - 1) * bb, K + (n - 2) * bb, b, b);
+
+  err = lu_factorise(S, piv + (n - 1) * b, b);
+  if (err != 0) {
+    return (n - 1) * b + err;
+  }
+
+  return 0;
+}
+
+void cyclic_block_tri_lu_solve(
+    const double *L, const double *D, const double *U, const double *K,
+    int *piv, double *f, const int n, const int b
+) {
+  const size_t bb = (size_t)b * b;
+
+  // solve E \ f[:-1]
+  block_tri_lu_solve(L, D, U, piv, f, n - 1, b);
+
+  // solve for the final block of the solution
+  //   x[-1] = S \ (f[-1] - H E^-1 f[:-1])
+  double *fn = f + (n - 1) * b;
+  block_sub_product(fn, U + (n - 1) * bb, f, b, 1);
+  block_sub_product(fn, L + (n - 1) * bb, f + (n - 2) * b, b, 1);
+  lu_solve_factorised(D + (n - 1) * bb, piv + (n - 1) * b, fn, b);
+
+  // x[:-1] = E \ f[:-1] - (E \ K) x[-1]
+  for (int i = 0; i < n - 1; i++) {
+    block_sub_product(f + i * b, K + i * bb, fn, b, 1);
+  }
+}
+
+int cyclic_block_tri_solve(
+    const double *L, double *D, double *U, double *K, int *piv, double *f,
+    const int n, const int b
+) {
+  const int err = cyclic_block_tri_lu_factorise(L, D, U, K, piv, n, b);
+  if (err != 0) {
+    return err;
+  }
+  cyclic_block_tri_lu_solve(L, D, U, K, piv, f, n, b);
+  return 0;
+}
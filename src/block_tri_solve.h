@@ -0,0 +1,160 @@
+#ifndef BLOCK_TRI_SOLVE_H
+#define BLOCK_TRI_SOLVE_H
+
+/**
+ * Solvers for block-tridiagonal matrices, where each block is a dense b x b
+ * matrix. Such matrices arise from coupled systems of b variables on a 1D
+ * grid.
+ *
+ * The blocks of each block diagonal are stored contiguously, one after the
+ * other, and each block is flattened in row-major order, so block i of the
+ * main block diagonal is D + i * b * b. As for `tri_solve`, L[0] and U[n-1]
+ * lie outside the matrix (they are used as the corner blocks in the cyclic
+ * case). Vectors are split into n consecutive blocks of b entries.
+ *
+ * The block Thomas algorithm is used, in which each diagonal block is
+ * factorised with `lu_factorise` (so pivoting is only performed within each
+ * block). This takes O(n b^3) steps, rather than the O((nb)^3) steps of a full
+ * LU factorisation, and is stable if the matrix is block diagonally dominant.
+ */
+
+/**
+ * Factorises a block-tridiagonal matrix A = LU.
+ *
+ * The main block diagonal is overwritten with the LU factorisations of the
+ * diagonal blocks of L, and the upper block diagonal is overwritten with the
+ * off-diagonal blocks of U (whose diagonal blocks are the identity).
+ *
+ * @param L lower block diagonal
+ * @param D main block diagonal, overwritten
+ * @param U upper block diagonal, overwritten
+ * @param piv pivot array, size n * b
+ * @param n number of block rows
+ * @param b size of each block
+ * @return 0 on success, row+1 on factorisation failure, -1 on other error
+ */
+int block_tri_lu_factorise(
+    const double *L, double *D, double *U, int *piv, int n, int b
+);
+
+/**
+ * Given an LU factorisation of a block-tridiagonal matrix A = LU, solves
+ * Ax = f in place. This takes O(n b^2) steps.
+ *
+ * @param L lower block diagonal
+ * @param D main block diagonal of the factorisation
+ * @param U upper block diagonal of the factorisation
+ * @param piv pivot array
+ * @param f right-hand side vector, overwritten with the solution
+ * @param n number of block rows
+ * @param b size of each block
+ */
+void block_tri_lu_solve(
+    const double *L, const double *D, const double *U, int *piv, double *f,
+    int n, int b
+);
+
+/**
+ * Given an LU factorisation of a block-tridiagonal matrix A = LU, solves
+ * AX = F in place.
+ *
+ * As for `block_tri_lu_solve` but for multiple right-hand side vectors.
+ *
+ * @param L lower block diagonal
+ * @param D main block diagonal of the factorisation
+ * @param U upper block diagonal of the factorisation
+ * @param piv pivot array
+ * @param F right-hand side vectors (nb x m), overwritten with the solution
+ * @param n number of block rows
+ * @param b size of each block
+ * @param m number of right-hand side vectors
+ */
+void block_tri_lu_solve_multi(
+    const double *L, const double *D, const double *U, int *piv, double *F,
+    int n, int b, int m
+);
+
+/**
+ * Solves the system Ax = f in place, where A is block-tridiagonal. Stores the
+ * LU factorisation of A in place so that it can be reused.
+ *
+ * @param L lower block diagonal
+ * @param D main block diagonal, overwritten
+ * @param U upper block diagonal, overwritten
+ * @param piv pivot array, size n * b
+ * @param f right-hand side vector, overwritten with the solution
+ * @param n number of block rows
+ * @param b size of each block
+ * @return 0 on success, row+1 on factorisation failure, -1 on other error
+ */
+int block_tri_solve(
+    const double *L, double *D, double *U, int *piv, double *f, int n, int b
+);
+
+/**
+ * Factorises a cyclic block-tridiagonal matrix, where L[0] is the block in the
+ * top right corner and U[n-1] is the block in the bottom left corner.
+ *
+ * As in `cyclic_pent_lu_factorise`, the final block row and column are treated
+ * as a border:
+ *   A = [E K; H C]
+ * where E is block-tridiagonal, K has two non-zero blocks (L[0] and U[n-2]),
+ * H has two non-zero blocks (U[n-1] and L[n-1]), and C = D[n-1]. E is
+ * factorised with `block_tri_lu_factorise`, E^-1 K is stored in K, and the
+ * LU factorisation of the Schur complement C - H E^-1 K is stored in D[n-1].
+ *
+ * @param L lower block diagonal
+ * @param D main block diagonal, overwritten
+ * @param U upper block diagonal, overwritten
+ * @param K overwritten with E^-1 K, size (n - 1) * b * b
+ * @param piv pivot array, size n * b
+ * @param n number of block rows (at least 3)
+ * @param b size of each block
+ * @return 0 on success, row+1 on factorisation failure, -1 on other error
+ */
+int cyclic_block_tri_lu_factorise(
+    const double *L, double *D, double *U, double *K, int *piv, int n, int b
+);
+
+/**
+ * Given a partial LU factorisation of a cyclic block-tridiagonal matrix,
+ * solves Ax = f in place.
+ *
+ * See `cyclic_block_tri_lu_factorise` for the format of the factorisation.
+ *
+ * @param L lower block diagonal
+ * @param D main block diagonal of the factorisation
+ * @param U upper block diagonal of the factorisation
+ * @param K E^-1 K
+ * @param piv pivot array
+ * @param f right-hand side vector, overwritten with the solution
+ * @param n number of block rows
+ * @param b size of each block
+ */
+void cyclic_block_tri_lu_solve(
+    const double *L, const double *D, const double *U, const double *K,
+    int *piv, double *f, int n, int b
+);
+
+/**
+ * Solves the system Ax = f in place, where A is cyclic and block-tridiagonal.
+ * Stores the partial LU factorisation of A in place so that it can be reused.
+ *
+ * See `cyclic_block_tri_lu_factorise` for the format of the factorisation.
+ *
+ * @param L lower block diagonal
+ * @param D main block diagonal, overwritten
+ * @param U upper block diagonal, overwritten
+ * @param K overwritten with E^-1 K, size (n - 1) * b * b
+ * @param piv pivot array, size n * b
+ * @param f right-hand side vector, overwritten with the solution
+ * @param n number of block rows (at least 3)
+ * @param b size of each block
+ * @return 0 on success, row+1 on factorisation failure, -1 on other error
+ */
+int cyclic_block_tri_solve(
+    const double *L, double *D, double *U, double *K, int *piv, double *f,
+    int n, int b
+);
+
+#endif // BLOCK_TRI_SOLVE_H
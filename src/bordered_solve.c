@@ -0,0 +1,122 @@
+/**
+ * The bordered solve is a block solve (see block_solve.c) in which the upper
+ * left block is banded, so A^-1 K is cheap to form and the only dense
+ * factorisation is of the m x m Schur complement.
+ */
+
+#include "bordered_solve.h"
+
+#include <stddef.h>
+
+#include "lu_solve.h"
+#include "pent_solve.h"
+#include "tri_solve.h"
+
+/**
+ * Given K = A^-1 K, forms S = C - H A^-1 K in place of C and factorises it.
+ */
+static int border_factorise(
+    const double *K, const double *H, double *C, int *piv, const int n,
+    const int m
+) {
+  for (int i = 0; i < m; i++) {
+    for (int k = 0; k < n; k++) { // apply to entire row
+      const double Hik = H[(size_t)i * n + k];
+      for (int j = 0; j < m; j++) {
+        C[(size_t)i * m + j] -= Hik * K[(size_t)k * m + j];
+      }
+    }
+  }
+
+  const int err = lu_factorise(C, piv, m);
+  if (err != 0) {
+    return n + err; // return the row of the first zero pivot
+  }
+  return 0;
+}
+
+/**
+ * Given f[:n] = A^-1 f[:n], completes the solve:
+ *   x[n:] = S^-1 (f[n:] - H A^-1 f[:n])
+ *   x[:n] = A^-1 f[:n] - A^-1 K x[n:]
+ */
+static void border_solve(
+    const double *K, const double *H, const double *C, int *piv, double *f,
+    const int n, const int m
+) {
+  double *fb = f + n;
+  for (int i = 0; i < m; i++) {
+    for (int k = 0; k < n; k++) {
+      fb[i] -= H[(size_t)i * n + k] * f[k];
+    }
+  }
+  lu_solve_factorised(C, piv, fb, m);
+
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < m; j++) {
+      f[i] -= K[(size_t)i * m + j] * fb[j];
+    }
+  }
+}
+
+int bordered_tri_lu_factorise(
+    const double *l, double *d, double *u, double *K, const double *H,
+    double *C, int *piv, const int n, const int m
+) {
+  tri_lu_factorise(l, d, u, n);
+  tri_lu_solve_multi(l, d, u, K, n, m);
+  return border_factorise(K, H, C, piv, n, m);
+}
+
+void bordered_tri_lu_solve(
+    const double *l, const double *d, const double *u, const double *K,
+    const double *H, const double *C, int *piv, double *f, const int n,
+    const int m
+) {
+  tri_lu_solve(l, d, u, f, n);
+  border_solve(K, H, C, piv, f, n, m);
+}
+
+int bordered_tri_solve(
+    const double *l, double *d, double *u, double *K, const double *H,
+    double *C, int *piv, double *f, const int n, const int m
+) {
+  const int err = bordered_tri_lu_factorise(l, d, u, K, H, C, piv, n, m);
+  if (err != 0) {
+    return err;
+  }
+  bordered_tri_lu_solve(l, d, u, K, H, C, piv, f, n, m);
+  return 0;
+}
+
+int bordered_pent_lu_factorise(
+    const double *l2, double *l1, double *d0, double *u1, double *u2,
+    double *K, const double *H, double *C, int *piv, const int n, const int m
+) {
+  pent_lu_factorise(l2, l1, d0, u1, u2, n);
+  pent_lu_solve_multi(l2, l1, d0, u1, u2, K, n, m);
+  return border_factorise(K, H, C, piv, n, m);
+}
+
+void bordered_pent_lu_solve(
+    const double *l2, const double *l1, const double *l0, const double *u1,
+    const double *u2, const double *K, const double *H, const double *C,
+    int *piv, double *f, const int n, const int m
+) {
+  pent_lu_solve(l2, l1, l0, u1, u2, f, n);
+  border_solve(K, H, C, piv, f, n, m);
+}
+
+int bordered_pent_solve(
+    const double *l2, double *l1, double *d0, double *u1, double *u2,
+    double *K, const double *H, double *C, int *piv, double *f, const int n,
+    const int m
+) {
+  const int err =
+      bordered_pent_lu_factorise(l2, l1, d0, u1, u2, K, H, C, piv, n, m);
+  if (err != 0) {
+    return err;
+  }
+  bordered_pent_lu_solve(l2, l1, d0, u1, u2, K, H, C, piv, f, n, m);
+  return 0;
+}
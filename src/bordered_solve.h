@@ -0,0 +1,151 @@
+#ifndef BORDERED_SOLVE_H
+#define BORDERED_SOLVE_H
+
+/**
+ * Solvers for bordered-banded matrices
+ *   R = [A K; H C]
+ * where A is an n x n tridiagonal or pentadiagonal core, K (n x m) and H
+ * (m x n) are dense border columns and rows, and C is a dense m x m corner.
+ * These arise, for example, from banded discretisations with a few integral
+ * constraints or Lagrange multipliers. The vectors are of size n + m, with the
+ * core unknowns first.
+ *
+ * This is the same approach as `cyclic_pent_lu_factorise` takes for its two
+ * border columns: A is factorised with `tri_lu_factorise` or
+ * `pent_lu_factorise`, all m border columns are solved in one multiple
+ * right-hand side sweep to give A^-1 K, and the small Schur complement
+ * S = C - H A^-1 K is factorised with `lu_factorise`. The factorisation takes
+ * O(nm^2 + m^3) steps and each solve O(nm + m^2), rather than the O((n+m)^3)
+ * and O((n+m)^2) of a dense LU factorisation.
+ *
+ * As for the banded solvers, A should be diagonally dominant.
+ */
+
+/**
+ * Factorises a bordered tridiagonal matrix.
+ *
+ * @param l lower diagonal of A, see `tri_lu_factorise`
+ * @param d main diagonal of A, overwritten
+ * @param u upper diagonal of A, overwritten
+ * @param K border columns (n x m), overwritten with A^-1 K
+ * @param H border rows (m x n)
+ * @param C corner (m x m), overwritten with the LU factorisation of S
+ * @param piv pivot array for S, size m
+ * @param n size of the core
+ * @param m size of the border
+ * @return 0 on success, row+1 on factorisation failure
+ */
+int bordered_tri_lu_factorise(
+    const double *l, double *d, double *u, double *K, const double *H,
+    double *C, int *piv, int n, int m
+);
+
+/**
+ * Given a factorisation from `bordered_tri_lu_factorise`, solves Rx = f in
+ * place.
+ *
+ * @param l lower diagonal of L
+ * @param d main diagonal of L
+ * @param u upper diagonal of U
+ * @param K A^-1 K
+ * @param H border rows
+ * @param C LU factorisation of S
+ * @param piv pivot array for S
+ * @param f right-hand side vector (n + m), overwritten with the solution
+ * @param n size of the core
+ * @param m size of the border
+ */
+void bordered_tri_lu_solve(
+    const double *l, const double *d, const double *u, const double *K,
+    const double *H, const double *C, int *piv, double *f, int n, int m
+);
+
+/**
+ * Solves the system Rx = f in place, where R is a bordered tridiagonal matrix.
+ * Stores the factorisation in place so that it can be reused.
+ *
+ * @param l lower diagonal of A
+ * @param d main diagonal of A, overwritten
+ * @param u upper diagonal of A, overwritten
+ * @param K border columns (n x m), overwritten with A^-1 K
+ * @param H border rows (m x n)
+ * @param C corner (m x m), overwritten with the LU factorisation of S
+ * @param piv pivot array for S, size m
+ * @param f right-hand side vector (n + m), overwritten with the solution
+ * @param n size of the core
+ * @param m size of the border
+ * @return 0 on success, row+1 on factorisation failure
+ */
+int bordered_tri_solve(
+    const double *l, double *d, double *u, double *K, const double *H,
+    double *C, int *piv, double *f, int n, int m
+);
+
+/**
+ * Factorises a bordered pentadiagonal matrix.
+ *
+ * @param l2 second lower diagonal of A, see `pent_lu_factorise`
+ * @param l1 first lower diagonal of A, overwritten
+ * @param d0 main diagonal of A, overwritten
+ * @param u1 first upper diagonal of A, overwritten
+ * @param u2 second upper diagonal of A, overwritten
+ * @param K border columns (n x m), overwritten with A^-1 K
+ * @param H border rows (m x n)
+ * @param C corner (m x m), overwritten with the LU factorisation of S
+ * @param piv pivot array for S, size m
+ * @param n size of the core
+ * @param m size of the border
+ * @return 0 on success, row+1 on factorisation failure
+ */
+int bordered_pent_lu_factorise(
+    const double *l2, double *l1, double *d0, double *u1, double *u2,
+    double *K, const double *H, double *C, int *piv, int n, int m
+);
+
+/**
+ * Given a factorisation from `bordered_pent_lu_factorise`, solves Rx = f in
+ * place.
+ *
+ * @param l2 second lower diagonal of L
+ * @param l1 first lower diagonal of L
+ * @param l0 main diagonal of L
+ * @param u1 first upper diagonal of U
+ * @param u2 second upper diagonal of U
+ * @param K A^-1 K
+ * @param H border rows
+ * @param C LU factorisation of S
+ * @param piv pivot array for S
+ * @param f right-hand side vector (n + m), overwritten with the solution
+ * @param n size of the core
+ * @param m size of the border
+ */
+void bordered_pent_lu_solve(
+    const double *l2, const double *l1, const double *l0, const double *u1,
+    const double *u2, const double *K, const double *H, const double *C,
+    int *piv, double *f, int n, int m
+);
+
+/**
+ * Solves the system Rx = f in place, where R is a bordered pentadiagonal
+ * matrix. Stores the factorisation in place so that it can be reused.
+ *
+ * @param l2 second lower diagonal of A
+ * @param l1 first lower diagonal of A, overwritten
+ * @param d0 main diagonal of A, overwritten
+ * @param u1 first upper diagonal of A, overwritten
+ * @param u2 second upper diagonal of A, overwritten
+ * @param K border columns (n x m), overwritten with A^-1 K
+ * @param H border rows (m x n)
+ * @param C corner (m x m), overwritten with the LU factorisation of S
+ * @param piv pivot array for S, size m
+ * @param f right-hand side vector (n + m), overwritten with the solution
+ * @param n size of the core
+ * @param m size of the border
+ * @return 0 on success, row+1 on factorisation failure
+ */
+int bordered_pent_solve(
+    const double *l2, double *l1, double *d0, double *u1, double *u2,
+    double *K, const double *H, double *C, int *piv, double *f, int n, int m
+);
+
+#endif // BORDERED_SOLVE_H
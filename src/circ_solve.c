@@ -0,0 +1,179 @@
+/**
+ * A circulant matrix has eigenvectors exp(2 pi i j k / n), so its eigenvalues
+ * are the discrete Fourier transform of its first column. See
+ *   https://en.wikipedia.org/wiki/Circulant_matrix
+ */
+
+#include "circ_solve.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define PI (3.14159265358979323846)
+#define CIRC_TOL (1e-10)
+
+/**
+ * Factorises a cyclic pentadiagonal matrix with constant diagonals (the
+ * tridiagonal case has l2 = u2 = 0).
+ */
+static int circ_factorise(
+    circ_factor *circ, const double l2, const double l1, const double d0,
+    const double u1, const double u2, const int n
+) {
+  memset(circ, 0, sizeof(circ_factor));
+  circ->n = n;
+
+  if (rfft_plan_init(&circ->fft, n) != 0) {
+    return -1;
+  }
+
+#ifdef _OPENMP
+  circ->nthreads = omp_get_max_threads();
+#else
+  circ->nthreads = 1;
+#endif
+  circ->nwork = n + circ->fft.nwork; // a column of the rhs plus the FFT
+  circ->ilam = malloc(n * sizeof(double));
+  circ->work = malloc(circ->nthreads * circ->nwork * sizeof(double));
+  if (!circ->ilam || !circ->work) {
+    circ_factor_free(circ);
+    return -1;
+  }
+
+  // compute the eigenvalues in half-complex order and store their reciprocals
+  for (int k = 0; 2 * k <= n; k++) {
+    const double theta = 2.0 * PI * k / n;
+    const double re =
+        d0 + (l1 + u1) * cos(theta) + (l2 + u2) * cos(2.0 * theta);
+    const double im = (u1 - l1) * sin(theta) + (u2 - l2) * sin(2.0 * theta);
+    const double mag2 = re * re + im * im;
+    if (sqrt(mag2) < CIRC_TOL) {
+      circ_factor_free(circ);
+      return k + 1; // return the index of the first zero eigenvalue
+    }
+
+    if (k == 0) {
+      circ->ilam[0] = 1.0 / re;
+    } else if (2 * k == n) {
+      circ->ilam[n - 1] = 1.0 / re; // the Nyquist eigenvalue is real
+    } else {
+      circ->ilam[2 * k - 1] = re / mag2;
+      circ->ilam[2 * k] = -im / mag2;
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * Solves a single system using the given workspace.
+ */
+static void circ_solve_work(const circ_factor *circ, double *f, double *work) {
+  const int n = circ->n;
+  const double *ilam = circ->ilam;
+
+  rfft_forward(&circ->fft, f, work);
+
+  // divide by the eigenvalues (i.e. multiply by their reciprocals)
+  f[0] *= ilam[0];
+  for (int k = 1; 2 * k < n; k++) {
+    const double re = f[2 * k - 1];
+    const double im = f[2 * k];
+    f[2 * k - 1] = re * ilam[2 * k - 1] - im * ilam[2 * k];
+    f[2 * k] = re * ilam[2 * k] + im * ilam[2 * k - 1];
+  }
+  if (n % 2 == 0) {
+    f[n - 1] *= ilam[n - 1];
+  }
+
+  rfft_inverse(&circ->fft, f, work);
+}
+
+int cyclic_tri_const_factorise(
+    circ_factor *circ, const double l, const double d, const double u,
+    const int n
+) {
+  return circ_factorise(circ, 0.0, l, d, u, 0.0, n);
+}
+
+int cyclic_pent_const_factorise(
+    circ_factor *circ, const double l2, const double l1, const double d0,
+    const double u1, const double u2, const int n
+) {
+  return circ_factorise(circ, l2, l1, d0, u1, u2, n);
+}
+
+void circ_factor_free(circ_factor *circ) {
+  rfft_plan_free(&circ->fft);
+  free(circ->ilam);
+  free(circ->work);
+  memset(circ, 0, sizeof(circ_factor));
+}
+
+void circ_solve_factorised(circ_factor *circ, double *f) {
+  circ_solve_work(circ, f, circ->work + circ->n);
+}
+
+void circ_solve_factorised_multi(circ_factor *circ, double *F, const int m) {
+  const int n = circ->n;
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(circ->nthreads)
+#endif
+  {
+#ifdef _OPENMP
+    double *work = circ->work + omp_get_thread_num() * circ->nwork;
+#else
+    double *work = circ->work;
+#endif
+    double *f = work;
+
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+    for (int j = 0; j < m; j++) {
+      // copy the column into contiguous memory, solve, and copy it back
+      for (int i = 0; i < n; i++) {
+        f[i] = F[(size_t)i * m + j];
+      }
+      circ_solve_work(circ, f, work + n);
+      for (int i = 0; i < n; i++) {
+        F[(size_t)i * m + j] = f[i];
+      }
+    }
+  }
+}
+
+int cyclic_tri_const_solve(
+    const double l, const double d, const double u, double *f, const int n
+) {
+  circ_factor circ;
+  const int err = cyclic_tri_const_factorise(&circ, l, d, u, n);
+  if (err != 0) {
+    return err;
+  }
+
+  circ_solve_factorised(&circ, f);
+  circ_factor_free(&circ);
+  return 0;
+}
+
+int cyclic_pent_const_solve(
+    const double l2, const double l1, const double d0, const double u1,
+    const double u2, double *f, const int n
+) {
+  circ_factor circ;
+  const int err = cyclic_pent_const_factorise(&circ, l2, l1, d0, u1, u2, n);
+  if (err != 0) {
+    return err;
+  }
+
+  circ_solve_factorised(&circ, f);
+  circ_factor_free(&circ);
+  return 0;
+}
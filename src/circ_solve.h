@@ -0,0 +1,132 @@
+#ifndef CIRC_SOLVE_H
+#define CIRC_SOLVE_H
+
+#include "fft.h"
+
+/**
+ * Factorisation of a circulant matrix, i.e. a cyclic banded matrix whose
+ * diagonals are constant.
+ *
+ * A circulant matrix is diagonalised by the discrete Fourier transform, so if
+ * lam[k] are its eigenvalues then Ax = f can be solved by transforming f,
+ * dividing the kth coefficient by lam[k], and transforming back. This takes
+ * O(n log n) steps and, unlike `cyclic_tri_lu_solve` and
+ * `cyclic_pent_lu_solve`, has no serial recurrence, so many right-hand sides
+ * can be solved independently (and in parallel if OpenMP is enabled).
+ *
+ * The factorisation owns a workspace for each thread, so while it can be reused
+ * for as many solves as required, it should not be used by two solves at once.
+ */
+typedef struct {
+  int n; // size of the matrix
+  rfft_plan fft; // real transform of length n
+  double *ilam; // reciprocal eigenvalues in half-complex order (see fft.h)
+  double *work; // per-thread workspace
+  int nwork; // size of the workspace for each thread
+  int nthreads; // number of per-thread workspaces
+} circ_factor;
+
+/**
+ * Factorises a cyclic, tridiagonal, square matrix A with constant diagonals.
+ *
+ * This is the constant-coefficient case of `cyclic_tri_solve`, i.e.
+ *    d  u  0  0 ...  0  l
+ *    l  d  u  0 ...  0  0
+ *    0  l  d  u ...  0  0
+ *          ...
+ *    u  0  0  0 ...  l  d
+ * with eigenvalues d + l exp(-2 pi i k / n) + u exp(2 pi i k / n).
+ *
+ * @param circ factorisation, must be freed with circ_factor_free
+ * @param l lower diagonal
+ * @param d main diagonal
+ * @param u upper diagonal
+ * @param n size of the matrix
+ * @return 0 on success, k+1 if the kth eigenvalue is zero, -1 on other error
+ */
+int cyclic_tri_const_factorise(
+    circ_factor *circ, double l, double d, double u, int n
+);
+
+/**
+ * Factorises a cyclic, pentadiagonal, square matrix A with constant diagonals.
+ *
+ * This is the constant-coefficient case of `cyclic_pent_solve`.
+ *
+ * @param circ factorisation, must be freed with circ_factor_free
+ * @param l2 second lower diagonal
+ * @param l1 first lower diagonal
+ * @param d0 main diagonal
+ * @param u1 first upper diagonal
+ * @param u2 second upper diagonal
+ * @param n size of the matrix
+ * @return 0 on success, k+1 if the kth eigenvalue is zero, -1 on other error
+ */
+int cyclic_pent_const_factorise(
+    circ_factor *circ, double l2, double l1, double d0, double u1, double u2,
+    int n
+);
+
+/**
+ * Frees the memory held by a circulant factorisation.
+ *
+ * @param circ factorisation to free
+ */
+void circ_factor_free(circ_factor *circ);
+
+/**
+ * Given the factorisation of a circulant matrix A, solves Ax = f in place.
+ *
+ * The factorisation is not const since its workspace is overwritten, so two
+ * solves with the same factorisation must not run at once.
+ *
+ * @param circ factorisation of A
+ * @param f right-hand side vector, overwritten with the solution
+ */
+void circ_solve_factorised(circ_factor *circ, double *f);
+
+/**
+ * Given the factorisation of a circulant matrix A, solves AX = F in place.
+ *
+ * As for `circ_solve_factorised` but for multiple right-hand side vectors,
+ * which are solved in parallel if OpenMP is enabled.
+ *
+ * @param circ factorisation of A
+ * @param F right-hand side vectors (n x m), overwritten with the solution
+ * @param m number of right-hand side vectors
+ */
+void circ_solve_factorised_multi(circ_factor *circ, double *F, int m);
+
+/**
+ * Solves the system Ax = f in place, where A is a cyclic, tridiagonal matrix
+ * with constant diagonals.
+ *
+ * See `cyclic_tri_const_factorise` for the layout of the matrix.
+ *
+ * @param l lower diagonal
+ * @param d main diagonal
+ * @param u upper diagonal
+ * @param f right-hand side vector, overwritten with the solution
+ * @param n size of the matrix
+ * @return 0 on success, k+1 if the kth eigenvalue is zero, -1 on other error
+ */
+int cyclic_tri_const_solve(double l, double d, double u, double *f, int n);
+
+/**
+ * Solves the system Ax = f in place, where A is a cyclic, pentadiagonal matrix
+ * with constant diagonals.
+ *
+ * @param l2 second lower diagonal
+ * @param l1 first lower diagonal
+ * @param d0 main diagonal
+ * @param u1 first upper diagonal
+ * @param u2 second upper diagonal
+ * @param f right-hand side vector, overwritten with the solution
+ * @param n size of the matrix
+ * @return 0 on success, k+1 if the kth eigenvalue is zero, -1 on other error
+ */
+int cyclic_pent_const_solve(
+    double l2, double l1, double d0, double u1, double u2, double *f, int n
+);
+
+#endif // CIRC_SOLVE_H
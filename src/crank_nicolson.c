@@ -0,0 +1,236 @@
+/**
+ * The fused step is the forward substitution of `tri_lu_solve` or
+ * `pent_lu_solve`, where the right-hand side of each row is computed from the
+ * explicit operator just before it is needed. Since forward substitution
+ * overwrites x[i] with y[i], the old values of x[i-1] and x[i-2] are carried
+ * along in registers, and the old values needed to wrap around the corners of
+ * a cyclic matrix are saved before the sweep starts.
+ */
+
+#include "crank_nicolson.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "pent_solve.h"
+#include "tri_solve.h"
+
+/**
+ * Allocates the stepper and forms the explicit and implicit operators from the
+ * 2w+1 diagonals of L.
+ */
+static int cn_stepper_init(
+    cn_stepper *s, const double *const *L, const int w, const double dt,
+    const double theta, const int cyclic, const int n
+) {
+  memset(s, 0, sizeof(cn_stepper));
+  // the cyclic pentadiagonal factorisation needs a row clear of both corners
+  if (n < 2 * w + 1 || (cyclic && w == 2 && n < 6)) {
+    return -1;
+  }
+  s->n = n;
+  s->w = w;
+  s->cyclic = cyclic;
+
+  const int ndiag = 2 * w + 1;
+  s->mem = malloc((2 * ndiag + 2) * n * sizeof(double));
+  if (!s->mem) {
+    return -1;
+  }
+  for (int k = 0; k < ndiag; k++) {
+    s->e[k] = s->mem + k * n;
+    s->a[k] = s->mem + (ndiag + k) * n;
+  }
+  s->k0 = s->mem + 2 * ndiag * n;
+  s->k1 = s->k0 + n;
+
+  // E = I + (1 - theta) dt L and A = I - theta dt L
+  for (int k = 0; k < ndiag; k++) {
+    const double diag = (k == w) ? 1.0 : 0.0;
+    for (int i = 0; i < n; i++) {
+      s->e[k][i] = diag + (1.0 - theta) * dt * L[k][i];
+      s->a[k][i] = diag - theta * dt * L[k][i];
+    }
+  }
+
+  // zero the entries which fall outside a non-cyclic matrix, so that the step
+  // can treat every row in the same way
+  if (!cyclic) {
+    for (int k = 0; k < w; k++) {
+      for (int i = 0; i < w - k; i++) {
+        s->e[k][i] = 0.0;
+        s->a[k][i] = 0.0;
+        s->e[ndiag - 1 - k][n - 1 - i] = 0.0;
+      }
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * Fused explicit product and implicit solve for the tridiagonal case.
+ */
+static void cn_step_tri(const cn_stepper *s, double *x) {
+  const int n = s->n;
+  const int c = s->cyclic;
+  const double *el = s->e[0], *ed = s->e[1], *eu = s->e[2];
+  const double *l = s->a[0], *d = s->a[1], *u = s->a[2];
+
+  // old values needed to wrap around the corners
+  const double x0 = x[0];
+  double xm1 = c ? x[n - 1] : 0.0; // old x[i-1]
+  double y1 = 0.0; // y[i-1]
+
+  // compute the rhs and solve Ly = rhs via forward substitution
+  for (int i = 0; i < n; i++) {
+    const double xi = x[i];
+    const double xp1 = (i + 1 < n) ? x[i + 1] : (c ? x0 : 0.0);
+    const double rhs = el[i] * xm1 + ed[i] * xi + eu[i] * xp1;
+    const double y = (rhs - l[i] * y1) / d[i];
+    x[i] = y;
+    xm1 = xi;
+    y1 = y;
+  }
+
+  // solve Ux = y via backward substitution
+  for (int i = n - 2; i >= 0; i--) {
+    x[i] -= u[i] * x[i + 1];
+  }
+
+  if (c) {
+    // Sherman-Morrison correction, as in cyclic_tri_lu_solve
+    const double *q = s->k0;
+    const double gamma = -0.5 * d[0];
+    const double vn_1 = l[0] / gamma;
+    const double scale =
+        (x[0] + vn_1 * x[n - 1]) / (1.0 + q[0] + vn_1 * q[n - 1]);
+    for (int i = 0; i < n; i++) {
+      x[i] -= q[i] * scale;
+    }
+  }
+}
+
+/**
+ * Fused explicit product and implicit solve for the pentadiagonal case.
+ */
+static void cn_step_pent(const cn_stepper *s, double *x) {
+  const int n = s->n;
+  const int c = s->cyclic;
+  const int m = c ? n - 2 : n; // size of the pentadiagonal LU factorisation
+  const double *const *e = (const double *const *)s->e;
+  const double *l2 = s->a[0], *l1 = s->a[1], *l0 = s->a[2];
+  const double *u1 = s->a[3], *u2 = s->a[4];
+
+  // old values needed to wrap around the corners
+  const double x0 = x[0];
+  const double x1 = x[1];
+  const double xn2 = x[n - 2];
+  const double xn1 = x[n - 1];
+  double xm2 = c ? xn2 : 0.0; // old x[i-2]
+  double xm1 = c ? xn1 : 0.0; // old x[i-1]
+  double y2 = 0.0; // y[i-2]
+  double y1 = 0.0; // y[i-1]
+
+  // compute the rhs and solve Ly = rhs via forward substitution
+  for (int i = 0; i < m; i++) {
+    const double xi = x[i];
+    const double xp1 = (i + 1 < n) ? x[i + 1] : 0.0;
+    const double xp2 = (i + 2 < n) ? x[i + 2] : 0.0;
+    const double rhs = e[0][i] * xm2 + e[1][i] * xm1 + e[2][i] * xi +
+                       e[3][i] * xp1 + e[4][i] * xp2;
+    const double y = (rhs - l1[i] * y1 - l2[i] * y2) / l0[i];
+    x[i] = y;
+    xm2 = xm1;
+    xm1 = xi;
+    y2 = y1;
+    y1 = y;
+  }
+
+  if (c) {
+    // rhs of the final two rows, which were split off into the 2x2 block
+    x[n - 2] = e[0][n - 2] * xm2 + e[1][n - 2] * xm1 + e[2][n - 2] * xn2 +
+               e[3][n - 2] * xn1 + e[4][n - 2] * x0;
+    x[n - 1] = e[0][n - 1] * xm1 + e[1][n - 1] * xn2 + e[2][n - 1] * xn1 +
+               e[3][n - 1] * x0 + e[4][n - 1] * x1;
+  }
+
+  // solve Ux = y via backward substitution
+  x[m - 2] -= u1[m - 2] * x[m - 1];
+  for (int i = m - 3; i >= 0; i--) {
+    x[i] -= u1[i] * x[i + 1] + u2[i] * x[i + 2];
+  }
+
+  if (c) {
+    // the remainder of cyclic_pent_lu_solve
+    const double *k0 = s->k0;
+    const double *k1 = s->k1;
+    x[n - 2] -= u2[n - 2] * x[0] + l2[n - 2] * x[n - 4] + l1[n - 2] * x[n - 3];
+    x[n - 1] -= u1[n - 1] * x[0] + u2[n - 1] * x[1] + l2[n - 1] * x[n - 3];
+
+    const double det = l0[n - 2] * l0[n - 1] - u1[n - 2] * l1[n - 1];
+    const double tmp = (l0[n - 1] * x[n - 2] - u1[n - 2] * x[n - 1]) / det;
+    x[n - 1] = (l0[n - 2] * x[n - 1] - l1[n - 1] * x[n - 2]) / det;
+    x[n - 2] = tmp;
+
+    for (int i = 0; i < n - 2; i++) {
+      x[i] -= k0[i] * x[n - 2] + k1[i] * x[n - 1];
+    }
+  }
+}
+
+int cn_stepper_init_tri(
+    cn_stepper *s, const double *l, const double *d, const double *u,
+    const double dt, const double theta, const int cyclic, const int n
+) {
+  const double *const L[3] = {l, d, u};
+  if (cn_stepper_init(s, L, 1, dt, theta, cyclic, n) != 0) {
+    return -1;
+  }
+
+  if (cyclic) {
+    cyclic_tri_lu_factorise(s->a[0], s->a[1], s->a[2], s->k0, n);
+  } else {
+    tri_lu_factorise(s->a[0], s->a[1], s->a[2], n);
+  }
+
+  return 0;
+}
+
+int cn_stepper_init_pent(
+    cn_stepper *s, const double *l2, const double *l1, const double *d0,
+    const double *u1, const double *u2, const double dt, const double theta,
+    const int cyclic, const int n
+) {
+  const double *const L[5] = {l2, l1, d0, u1, u2};
+  if (cn_stepper_init(s, L, 2, dt, theta, cyclic, n) != 0) {
+    return -1;
+  }
+
+  double **a = s->a;
+  if (cyclic) {
+    cyclic_pent_lu_factorise(a[0], a[1], a[2], a[3], a[4], s->k0, s->k1, n);
+
+    // the corner entries now live in k0 and k1, so clear them for the sweep
+    a[0][0] = 0.0;
+    a[0][1] = 0.0;
+    a[1][0] = 0.0;
+  } else {
+    pent_lu_factorise(a[0], a[1], a[2], a[3], a[4], n);
+  }
+
+  return 0;
+}
+
+void cn_stepper_free(cn_stepper *s) {
+  free(s->mem);
+  memset(s, 0, sizeof(cn_stepper));
+}
+
+void cn_step(const cn_stepper *s, double *x) {
+  if (s->w == 1) {
+    cn_step_tri(s, x);
+  } else {
+    cn_step_pent(s, x);
+  }
+}
@@ -0,0 +1,89 @@
+#ifndef CRANK_NICOLSON_H
+#define CRANK_NICOLSON_H
+
+/**
+ * Time-stepper for the linear system dx/dt = L x, where L is a (cyclic)
+ * tridiagonal or pentadiagonal matrix, using the theta method
+ *   (I - theta dt L) x[t+1] = (I + (1 - theta) dt L) x[t].
+ * Setting theta = 0.5 gives the Crank-Nicolson method, and theta = 1 gives
+ * backward Euler.
+ *
+ * The implicit operator is factorised once when the stepper is created, and
+ * the caller's copy of L is left untouched, so there is no need to refactorise
+ * or restore the diagonals between steps. Each step applies the explicit
+ * operator on the fly during the forward substitution of the implicit solve,
+ * so the explicit and implicit halves of the step share a single pass over x
+ * (followed by the usual backward substitution), with no allocation or copies.
+ */
+typedef struct {
+  int n; // size of the matrix
+  int w; // half-bandwidth: 1 for tridiagonal, 2 for pentadiagonal
+  int cyclic; // whether the diagonals wrap around the corners
+  double *e[5]; // explicit operator I + (1 - theta) dt L, lowest diagonal first
+  double *a[5]; // LU factorisation of the implicit operator I - theta dt L
+  double *k0; // q (cyclic tridiagonal) or first column of E^-1 K (cyclic pent)
+  double *k1; // second column of E^-1 K (cyclic pentadiagonal)
+  double *mem; // memory backing all of the above
+} cn_stepper;
+
+/**
+ * Prepares a time-stepper for a tridiagonal operator L.
+ *
+ * See `tri_solve` and `cyclic_tri_solve` for the layout of the diagonals. Like
+ * those solvers, the implicit operator should be diagonally dominant.
+ *
+ * @param s stepper to initialise, must be freed with cn_stepper_free
+ * @param l lower diagonal of L
+ * @param d main diagonal of L
+ * @param u upper diagonal of L
+ * @param dt time step
+ * @param theta implicitness (0.5 for Crank-Nicolson)
+ * @param cyclic 1 if L is cyclic, 0 otherwise
+ * @param n size of the matrix (at least 3)
+ * @return 0 on success, -1 on error
+ */
+int cn_stepper_init_tri(
+    cn_stepper *s, const double *l, const double *d, const double *u,
+    double dt, double theta, int cyclic, int n
+);
+
+/**
+ * Prepares a time-stepper for a pentadiagonal operator L.
+ *
+ * See `pent_solve` and `cyclic_pent_solve` for the layout of the diagonals.
+ * Like those solvers, the implicit operator should be diagonally dominant.
+ *
+ * @param s stepper to initialise, must be freed with cn_stepper_free
+ * @param l2 second lower diagonal of L
+ * @param l1 first lower diagonal of L
+ * @param d0 main diagonal of L
+ * @param u1 first upper diagonal of L
+ * @param u2 second upper diagonal of L
+ * @param dt time step
+ * @param theta implicitness (0.5 for Crank-Nicolson)
+ * @param cyclic 1 if L is cyclic, 0 otherwise
+ * @param n size of the matrix (at least 5, or 6 if cyclic)
+ * @return 0 on success, -1 on error
+ */
+int cn_stepper_init_pent(
+    cn_stepper *s, const double *l2, const double *l1, const double *d0,
+    const double *u1, const double *u2, double dt, double theta, int cyclic,
+    int n
+);
+
+/**
+ * Frees the memory held by a time-stepper.
+ *
+ * @param s stepper to free
+ */
+void cn_stepper_free(cn_stepper *s);
+
+/**
+ * Advances x by one time step in place.
+ *
+ * @param s time-stepper
+ * @param x state vector, overwritten with the state at the next time step
+ */
+void cn_step(const cn_stepper *s, double *x);
+
+#endif // CRANK_NICOLSON_H
@@ -0,0 +1,398 @@
+/**
+ * The radix-2 transform is the iterative Cooley-Tukey algorithm, see
+ *   https://en.wikipedia.org/wiki/Cooley%E2%80%93Tukey_FFT_algorithm
+ *
+ * Other lengths use Bluestein's algorithm, see
+ *   https://en.wikipedia.org/wiki/Chirp_Z-transform#Bluestein's_algorithm
+ *
+ * The real transform packs an even-length real vector into a half-length
+ * complex vector and then separates the transforms of the even and odd entries,
+ * as described in 'Numerical Recipes in C', section 12.3.
+ *
+ * The sine transform uses the odd extension of the input, as described in
+ * section 12.4 of the same book (although we use the simpler, but twice as
+ * expensive, version that transforms the whole extension).
+ */
+
+#include "fft.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PI (3.14159265358979323846)
+
+/**
+ * Applies an in-place radix-2 transform of length m.
+ *
+ * @param rev bit-reversal permutation
+ * @param w twiddle factors exp(-2 pi i k / m)
+ * @param m transform length, must be a power of two
+ * @param z complex vector of length m, overwritten with its transform
+ * @param sign -1 for the forward transform, +1 for the (unscaled) inverse
+ */
+static void radix2(
+    const int *rev, const double *w, const int m, double *z, const int sign
+) {
+  // put the entries into bit-reversed order
+  for (int i = 0; i < m; i++) {
+    const int j = rev[i];
+    if (i < j) {
+      const double re = z[2 * i];
+      const double im = z[2 * i + 1];
+      z[2 * i] = z[2 * j];
+      z[2 * i + 1] = z[2 * j + 1];
+      z[2 * j] = re;
+      z[2 * j + 1] = im;
+    }
+  }
+
+  // combine pairs of transforms of length len/2 into transforms of length len
+  for (int len = 2; len <= m; len *= 2) {
+    const int half = len / 2;
+    const int step = m / len;
+    for (int s = 0; s < m; s += len) {
+      for (int k = 0; k < half; k++) {
+        const double wr = w[2 * k * step];
+        const double wi = -sign * w[2 * k * step + 1];
+        double *a = z + 2 * (s + k);
+        double *b = a + 2 * half;
+        const double tr = wr * b[0] - wi * b[1];
+        const double ti = wr * b[1] + wi * b[0];
+        b[0] = a[0] - tr;
+        b[1] = a[1] - ti;
+        a[0] += tr;
+        a[1] += ti;
+      }
+    }
+  }
+}
+
+/**
+ * Applies the forward Bluestein transform of length n.
+ *
+ * @param plan transform plan
+ * @param z complex vector of length n, overwritten with its transform
+ * @param work workspace of 2m doubles
+ */
+static void bluestein(const fft_plan *plan, double *z, double *work) {
+  const int n = plan->n;
+  const int m = plan->m;
+  const double *c = plan->chirp;
+  const double *b = plan->kernel;
+
+  // a = z * chirp, zero padded to length m
+  double *a = work;
+  for (int k = 0; k < n; k++) {
+    a[2 * k] = z[2 * k] * c[2 * k] - z[2 * k + 1] * c[2 * k + 1];
+    a[2 * k + 1] = z[2 * k] * c[2 * k + 1] + z[2 * k + 1] * c[2 * k];
+  }
+  memset(a + 2 * n, 0, 2 * (m - n) * sizeof(double));
+
+  // convolve a with the kernel
+  radix2(plan->rev, plan->w, m, a, -1);
+  for (int k = 0; k < m; k++) {
+    const double re = a[2 * k] * b[2 * k] - a[2 * k + 1] * b[2 * k + 1];
+    const double im = a[2 * k] * b[2 * k + 1] + a[2 * k + 1] * b[2 * k];
+    a[2 * k] = re;
+    a[2 * k + 1] = im;
+  }
+  radix2(plan->rev, plan->w, m, a, 1);
+
+  // X = chirp * (a conv b) / m
+  const double scale = 1.0 / m;
+  for (int k = 0; k < n; k++) {
+    z[2 * k] = scale * (a[2 * k] * c[2 * k] - a[2 * k + 1] * c[2 * k + 1]);
+    z[2 * k + 1] = scale * (a[2 * k] * c[2 * k + 1] + a[2 * k + 1] * c[2 * k]);
+  }
+}
+
+int fft_plan_init(fft_plan *plan, const int n) {
+  memset(plan, 0, sizeof(fft_plan));
+  if (n < 1) {
+    return -1;
+  }
+  plan->n = n;
+
+  // find the radix-2 length, which must fit the Bluestein convolution if n is
+  // not a power of two
+  int bits = 0;
+  while ((1 << bits) < n) {
+    bits++;
+  }
+  if ((1 << bits) != n) {
+    while ((1 << bits) < 2 * n - 1) {
+      bits++;
+    }
+  }
+  const int m = 1 << bits;
+  plan->m = m;
+
+  // bit-reversal permutation and twiddle factors
+  plan->rev = malloc(m * sizeof(int));
+  plan->w = malloc((m / 2 + 1) * 2 * sizeof(double));
+  if (!plan->rev || !plan->w) {
+    fft_plan_free(plan);
+    return -1;
+  }
+  for (int i = 0; i < m; i++) {
+    int r = 0;
+    for (int b = 0; b < bits; b++) {
+      r |= ((i >> b) & 1) << (bits - 1 - b);
+    }
+    plan->rev[i] = r;
+  }
+  for (int k = 0; k < m / 2; k++) {
+    plan->w[2 * k] = cos(2.0 * PI * k / m);
+    plan->w[2 * k + 1] = -sin(2.0 * PI * k / m);
+  }
+
+  if (m == n) {
+    plan->nwork = 0;
+    return 0;
+  }
+
+  // Bluestein chirp and the transform of its conjugate (the kernel)
+  plan->chirp = malloc(2 * n * sizeof(double));
+  plan->kernel = calloc(2 * m, sizeof(double));
+  if (!plan->chirp || !plan->kernel) {
+    fft_plan_free(plan);
+    return -1;
+  }
+  for (int k = 0; k < n; k++) {
+    // reduce k^2 modulo 2n first so that the angle stays accurate for large k
+    const long long k2 = ((long long)k * k) % (2LL * n);
+    const double theta = PI * (double)k2 / n;
+    plan->chirp[2 * k] = cos(theta);
+    plan->chirp[2 * k + 1] = -sin(theta);
+  }
+  plan->kernel[0] = plan->chirp[0];
+  plan->kernel[1] = -plan->chirp[1];
+  for (int k = 1; k < n; k++) {
+    plan->kernel[2 * k] = plan->chirp[2 * k];
+    plan->kernel[2 * k + 1] = -plan->chirp[2 * k + 1];
+    plan->kernel[2 * (m - k)] = plan->chirp[2 * k];
+    plan->kernel[2 * (m - k) + 1] = -plan->chirp[2 * k + 1];
+  }
+  radix2(plan->rev, plan->w, m, plan->kernel, -1);
+
+  plan->nwork = 2 * m;
+  return 0;
+}
+
+void fft_plan_free(fft_plan *plan) {
+  free(plan->rev);
+  free(plan->w);
+  free(plan->chirp);
+  free(plan->kernel);
+  memset(plan, 0, sizeof(fft_plan));
+}
+
+void fft_forward(const fft_plan *plan, double *z, double *work) {
+  if (plan->m == plan->n) {
+    radix2(plan->rev, plan->w, plan->m, z, -1);
+  } else {
+    bluestein(plan, z, work);
+  }
+}
+
+void fft_inverse(const fft_plan *plan, double *z, double *work) {
+  const int n = plan->n;
+
+  if (plan->m == n) {
+    radix2(plan->rev, plan->w, n, z, 1);
+    const double scale = 1.0 / n;
+    for (int k = 0; k < 2 * n; k++) {
+      z[k] *= scale;
+    }
+    return;
+  }
+
+  // the inverse transform is conj(F(conj(z))) / n
+  for (int k = 0; k < n; k++) {
+    z[2 * k + 1] = -z[2 * k + 1];
+  }
+  bluestein(plan, z, work);
+  const double scale = 1.0 / n;
+  for (int k = 0; k < n; k++) {
+    z[2 * k] *= scale;
+    z[2 * k + 1] *= -scale;
+  }
+}
+
+int rfft_plan_init(rfft_plan *plan, const int n) {
+  memset(plan, 0, sizeof(rfft_plan));
+  if (n < 1) {
+    return -1;
+  }
+  plan->n = n;
+
+  // odd lengths fall back to a full complex transform
+  if (n % 2 != 0) {
+    if (fft_plan_init(&plan->cplx, n) != 0) {
+      return -1;
+    }
+    plan->nwork = 2 * n + plan->cplx.nwork;
+    return 0;
+  }
+
+  const int h = n / 2;
+  if (fft_plan_init(&plan->cplx, h) != 0) {
+    return -1;
+  }
+  plan->w = malloc(2 * h * sizeof(double));
+  if (!plan->w) {
+    rfft_plan_free(plan);
+    return -1;
+  }
+  for (int k = 0; k < h; k++) {
+    plan->w[2 * k] = cos(2.0 * PI * k / n);
+    plan->w[2 * k + 1] = -sin(2.0 * PI * k / n);
+  }
+  plan->nwork = n + plan->cplx.nwork;
+
+  return 0;
+}
+
+void rfft_plan_free(rfft_plan *plan) {
+  fft_plan_free(&plan->cplx);
+  free(plan->w);
+  memset(plan, 0, sizeof(rfft_plan));
+}
+
+void rfft_forward(const rfft_plan *plan, double *x, double *work) {
+  const int n = plan->n;
+
+  if (n % 2 != 0) {
+    // transform a complex copy with zero imaginary part
+    double *z = work;
+    for (int j = 0; j < n; j++) {
+      z[2 * j] = x[j];
+      z[2 * j + 1] = 0.0;
+    }
+    fft_forward(&plan->cplx, z, work + 2 * n);
+
+    x[0] = z[0];
+    for (int k = 1; 2 * k < n; k++) {
+      x[2 * k - 1] = z[2 * k];
+      x[2 * k] = z[2 * k + 1];
+    }
+    return;
+  }
+
+  // treat the even and odd entries as the real and imaginary parts of a
+  // complex vector of length h, which has exactly the same memory layout
+  const int h = n / 2;
+  double *z = work;
+  memcpy(z, x, n * sizeof(double));
+  fft_forward(&plan->cplx, z, work + n);
+
+  // separate the even (E) and odd (O) transforms, then X = E + w^k O
+  x[0] = z[0] + z[1];
+  x[n - 1] = z[0] - z[1];
+  for (int k = 1; k < h; k++) {
+    const double *zk = z + 2 * k;
+    const double *zh = z + 2 * (h - k);
+    const double e_r = 0.5 * (zk[0] + zh[0]);
+    const double e_i = 0.5 * (zk[1] - zh[1]);
+    const double o_r = 0.5 * (zk[1] + zh[1]);
+    const double o_i = -0.5 * (zk[0] - zh[0]);
+    const double wr = plan->w[2 * k];
+    const double wi = plan->w[2 * k + 1];
+    x[2 * k - 1] = e_r + wr * o_r - wi * o_i;
+    x[2 * k] = e_i + wr * o_i + wi * o_r;
+  }
+}
+
+void rfft_inverse(const rfft_plan *plan, double *x, double *work) {
+  const int n = plan->n;
+
+  if (n % 2 != 0) {
+    // rebuild the full conjugate-symmetric spectrum and transform it back
+    double *z = work;
+    z[0] = x[0];
+    z[1] = 0.0;
+    for (int k = 1; 2 * k < n; k++) {
+      z[2 * k] = x[2 * k - 1];
+      z[2 * k + 1] = x[2 * k];
+      z[2 * (n - k)] = x[2 * k - 1];
+      z[2 * (n - k) + 1] = -x[2 * k];
+    }
+    fft_inverse(&plan->cplx, z, work + 2 * n);
+
+    for (int j = 0; j < n; j++) {
+      x[j] = z[2 * j];
+    }
+    return;
+  }
+
+  // recombine the even (E) and odd (O) transforms into Z = E + i O
+  const int h = n / 2;
+  double *z = work;
+  const double x0 = x[0];
+  const double xh = x[n - 1];
+  z[0] = 0.5 * (x0 + xh);
+  z[1] = 0.5 * (x0 - xh);
+  for (int k = 1; k < h; k++) {
+    // X[k] and X[h-k] in half-complex order
+    const double xr = x[2 * k - 1];
+    const double xi = x[2 * k];
+    const double yr = x[2 * (h - k) - 1];
+    const double yi = x[2 * (h - k)];
+
+    const double e_r = 0.5 * (xr + yr);
+    const double e_i = 0.5 * (xi - yi);
+    const double d_r = 0.5 * (xr - yr);
+    const double d_i = 0.5 * (xi + yi);
+    const double wr = plan->w[2 * k];
+    const double wi = -plan->w[2 * k + 1]; // conjugate twiddle
+    const double o_r = d_r * wr - d_i * wi;
+    const double o_i = d_r * wi + d_i * wr;
+
+    z[2 * k] = e_r - o_i;
+    z[2 * k + 1] = e_i + o_r;
+  }
+  fft_inverse(&plan->cplx, z, work + n);
+
+  memcpy(x, z, n * sizeof(double));
+}
+
+int dst_plan_init(dst_plan *plan, const int n) {
+  memset(plan, 0, sizeof(dst_plan));
+  if (n < 1) {
+    return -1;
+  }
+  plan->n = n;
+
+  if (rfft_plan_init(&plan->fft, 2 * (n + 1)) != 0) {
+    return -1;
+  }
+  plan->nwork = 2 * (n + 1) + plan->fft.nwork;
+
+  return 0;
+}
+
+void dst_plan_free(dst_plan *plan) {
+  rfft_plan_free(&plan->fft);
+  memset(plan, 0, sizeof(dst_plan));
+}
+
+void dst1(const dst_plan *plan, double *x, double *work) {
+  const int n = plan->n;
+  const int len = 2 * (n + 1);
+
+  // form the odd extension [0, x, 0, -reverse(x)]
+  double *y = work;
+  y[0] = 0.0;
+  y[n + 1] = 0.0;
+  for (int j = 0; j < n; j++) {
+    y[j + 1] = x[j];
+    y[len - 1 - j] = -x[j];
+  }
+
+  // the transform of the odd extension is Y[k] = -2i X[k - 1]
+  rfft_forward(&plan->fft, y, work + len);
+  for (int k = 1; k <= n; k++) {
+    x[k - 1] = -0.5 * y[2 * k];
+  }
+}
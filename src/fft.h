@@ -0,0 +1,161 @@
+#ifndef FFT_H
+#define FFT_H
+
+/**
+ * Plan for a complex discrete Fourier transform of length n.
+ *
+ * Complex vectors are stored as interleaved doubles, so the kth entry of z has
+ * real part z[2*k] and imaginary part z[2*k+1].
+ *
+ * Power-of-two lengths use an iterative radix-2 Cooley-Tukey transform. Any
+ * other length is handled with Bluestein's algorithm, which rewrites the DFT as
+ * a convolution that is evaluated with a radix-2 transform of length
+ * m >= 2n - 1. Either way the transform takes O(n log n) steps.
+ *
+ * A plan is read-only once it has been initialised, so it can be shared
+ * between threads as long as each thread uses its own workspace.
+ */
+typedef struct {
+  int n; // transform length
+  int m; // length of the underlying radix-2 transform
+  int *rev; // bit-reversal permutation of length m
+  double *w; // twiddle factors exp(-2 pi i k / m), m / 2 complex entries
+  double *chirp; // Bluestein chirp exp(-pi i k^2 / n), n complex entries
+  double *kernel; // transformed Bluestein kernel, m complex entries
+  int nwork; // number of doubles of workspace needed by a transform
+} fft_plan;
+
+/**
+ * Plan for a real discrete Fourier transform of length n.
+ *
+ * The transform of a real vector is conjugate symmetric, so only the first
+ * n/2 + 1 coefficients need to be stored. These are packed into a real array of
+ * length n in 'half-complex' order (as in FFTPACK):
+ *   [Re X0, Re X1, Im X1, Re X2, Im X2, ..., Re X(n/2)]
+ * where the final entry is only present when n is even (since X(n/2) is then
+ * real). Put another way, entry j > 0 belongs to wavenumber k = (j + 1) / 2.
+ *
+ * When n is even the real vector is packed into a complex vector of length n/2
+ * so the transform costs half as much as the equivalent complex transform.
+ */
+typedef struct {
+  int n; // transform length
+  fft_plan cplx; // complex plan of length n/2 (n even) or n (n odd)
+  double *w; // unpacking twiddle factors exp(-2 pi i k / n), n / 2 complex
+  int nwork; // number of doubles of workspace needed by a transform
+} rfft_plan;
+
+/**
+ * Prepares a plan for complex transforms of length n.
+ *
+ * @param plan plan to initialise, must be freed with fft_plan_free
+ * @param n transform length
+ * @return 0 on success, -1 on error
+ */
+int fft_plan_init(fft_plan *plan, int n);
+
+/**
+ * Frees the memory held by a complex transform plan.
+ *
+ * @param plan plan to free
+ */
+void fft_plan_free(fft_plan *plan);
+
+/**
+ * Computes the forward transform X[k] = sum_j z[j] exp(-2 pi i j k / n) in
+ * place.
+ *
+ * @param plan transform plan
+ * @param z complex vector of length n, overwritten with its transform
+ * @param work workspace of at least plan->nwork doubles (may be NULL if zero)
+ */
+void fft_forward(const fft_plan *plan, double *z, double *work);
+
+/**
+ * Computes the inverse transform z[j] = 1/n sum_k X[k] exp(2 pi i j k / n) in
+ * place, so that fft_inverse undoes fft_forward.
+ *
+ * @param plan transform plan
+ * @param z complex vector of length n, overwritten with its inverse transform
+ * @param work workspace of at least plan->nwork doubles (may be NULL if zero)
+ */
+void fft_inverse(const fft_plan *plan, double *z, double *work);
+
+/**
+ * Prepares a plan for real transforms of length n.
+ *
+ * @param plan plan to initialise, must be freed with rfft_plan_free
+ * @param n transform length
+ * @return 0 on success, -1 on error
+ */
+int rfft_plan_init(rfft_plan *plan, int n);
+
+/**
+ * Frees the memory held by a real transform plan.
+ *
+ * @param plan plan to free
+ */
+void rfft_plan_free(rfft_plan *plan);
+
+/**
+ * Computes the forward transform of a real vector in place, leaving the result
+ * in half-complex order (see rfft_plan).
+ *
+ * @param plan transform plan
+ * @param x real vector of length n, overwritten with its half-complex transform
+ * @param work workspace of at least plan->nwork doubles
+ */
+void rfft_forward(const rfft_plan *plan, double *x, double *work);
+
+/**
+ * Computes the inverse transform of a half-complex vector in place, so that
+ * rfft_inverse undoes rfft_forward.
+ *
+ * @param plan transform plan
+ * @param x half-complex vector of length n, overwritten with the real result
+ * @param work workspace of at least plan->nwork doubles
+ */
+void rfft_inverse(const rfft_plan *plan, double *x, double *work);
+
+/**
+ * Plan for a type-I discrete sine transform (DST-I) of length n:
+ *   X[k] = sum_j x[j] sin(pi (j + 1) (k + 1) / (n + 1))
+ * The DST-I is its own inverse up to a factor of 2 / (n + 1).
+ *
+ * This diagonalises the second-difference operator with homogeneous Dirichlet
+ * boundary conditions, just as the DFT does for periodic conditions. It is
+ * computed with a real transform of the odd extension of x, which has length
+ * 2(n + 1).
+ */
+typedef struct {
+  int n; // transform length
+  rfft_plan fft; // real plan of length 2(n + 1)
+  int nwork; // number of doubles of workspace needed by a transform
+} dst_plan;
+
+/**
+ * Prepares a plan for DST-I transforms of length n.
+ *
+ * @param plan plan to initialise, must be freed with dst_plan_free
+ * @param n transform length
+ * @return 0 on success, -1 on error
+ */
+int dst_plan_init(dst_plan *plan, int n);
+
+/**
+ * Frees the memory held by a DST-I plan.
+ *
+ * @param plan plan to free
+ */
+void dst_plan_free(dst_plan *plan);
+
+/**
+ * Computes the (unscaled) DST-I of a real vector in place.
+ *
+ * @param plan transform plan
+ * @param x real vector of length n, overwritten with its transform
+ * @param work workspace of at least plan->nwork doubles
+ */
+void dst1(const dst_plan *plan, double *x, double *work);
+
+#endif // FFT_H
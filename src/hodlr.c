@@ -0,0 +1,462 @@
+/**
+ * The HODLR factorisation follows "An O(N log^2 N) fast direct solver for
+ * partial hierarchically semi-separable matrices" by Ambikasaran and Darve
+ * 2013 (https://doi.org/10.1007/s10915-013-9714-z). The adaptive cross
+ * approximation with partial pivoting is described in "Approximation of
+ * boundary element matrices" by Bebendorf 2000
+ * (https://doi.org/10.1007/PL00005410).
+ *
+ * At each node A = D + U W^T, where D = diag(A11, A22), U = diag(U1, U2) and
+ * W = [0 V2; V1 0], so that
+ *   A^-1 = D^-1 - D^-1 U (I + W^T D^-1 U)^-1 W^T D^-1
+ * with
+ *   I + W^T D^-1 U = [I V1^T A22^-1 U2; V2^T A11^-1 U1 I].
+ * The factorisation overwrites U1 and U2 with A11^-1 U1 and A22^-1 U2 (using
+ * the factorisations of the children) and stores the LU factorisation of the
+ * small matrix above.
+ */
+
+#include "hodlr.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lu_solve.h"
+
+/**
+ * Context for hodlr_init_dense.
+ */
+typedef struct {
+  const double *A;
+  int n;
+} dense_ctx;
+
+static double dense_entry(const int i, const int j, void *ctx) {
+  const dense_ctx *d = ctx;
+  return d->A[(size_t)i * d->n + j];
+}
+
+/**
+ * Counts the nodes in the tree for a diagonal block of the given size.
+ */
+static int count_nodes(const int size, const int leaf) {
+  if (size <= leaf) {
+    return 1;
+  }
+  return 1 + count_nodes(size / 2, leaf) + count_nodes(size - size / 2, leaf);
+}
+
+/**
+ * Temporary storage used while compressing the off-diagonal blocks.
+ */
+typedef struct {
+  hodlr_entry entry;
+  void *ctx;
+  double tol;
+  int max_rank;
+  double *U; // (n / 2 + 1) x max_rank
+  double *V; // (n / 2 + 1) x max_rank
+  int *used; // n / 2 + 1 flags marking the rows which have been pivots
+} aca_state;
+
+/**
+ * Computes a low-rank approximation A[r0:r0+p, c0:c0+q] ~ U V^T with adaptive
+ * cross approximation, storing U (p x k) and V (q x k) in newly allocated
+ * arrays.
+ *
+ * @return the rank k, or -1 on error
+ */
+static int aca(
+    aca_state *s, const int r0, const int p, const int c0, const int q,
+    double **U_out, double **V_out
+) {
+  int cap = s->max_rank;
+  if (cap > p) {
+    cap = p;
+  }
+  if (cap > q) {
+    cap = q;
+  }
+
+  double *U = s->U;
+  double *V = s->V;
+  memset(s->used, 0, p * sizeof(int));
+
+  int k = 0;
+  int i = 0; // pivot row
+  double norm2 = 0.0; // estimate of the squared Frobenius norm of U V^T
+  for (int tries = 0; tries < p && k < cap; tries++) {
+    s->used[i] = 1;
+
+    // residual of row i, stored in column k of V
+    int jmax = 0;
+    double vmax = 0.0;
+    for (int j = 0; j < q; j++) {
+      double v = s->entry(r0 + i, c0 + j, s->ctx);
+      for (int l = 0; l < k; l++) {
+        v -= U[i * cap + l] * V[j * cap + l];
+      }
+      V[j * cap + k] = v;
+      if (fabs(v) > fabs(vmax)) {
+        vmax = v;
+        jmax = j;
+      }
+    }
+
+    if (fabs(vmax) > 0.0) {
+      for (int j = 0; j < q; j++) {
+        V[j * cap + k] /= vmax;
+      }
+
+      // residual of column jmax, stored in column k of U
+      for (int r = 0; r < p; r++) {
+        double u = s->entry(r0 + r, c0 + jmax, s->ctx);
+        for (int l = 0; l < k; l++) {
+          u -= U[r * cap + l] * V[jmax * cap + l];
+        }
+        U[r * cap + k] = u;
+      }
+
+      // update the estimate of the norm of the approximation
+      double nu2 = 0.0;
+      double nv2 = 0.0;
+      for (int r = 0; r < p; r++) {
+        nu2 += U[r * cap + k] * U[r * cap + k];
+      }
+      for (int j = 0; j < q; j++) {
+        nv2 += V[j * cap + k] * V[j * cap + k];
+      }
+      for (int l = 0; l < k; l++) {
+        double uu = 0.0;
+        double vv = 0.0;
+        for (int r = 0; r < p; r++) {
+          uu += U[r * cap + l] * U[r * cap + k];
+        }
+        for (int j = 0; j < q; j++) {
+          vv += V[j * cap + l] * V[j * cap + k];
+        }
+        norm2 += 2.0 * uu * vv;
+      }
+      norm2 += nu2 * nv2;
+      k++;
+
+      if (nu2 * nv2 <= s->tol * s->tol * norm2) {
+        break; // converged
+      }
+    }
+
+    // the next pivot row is the largest entry of the last column of U among
+    // the rows not used so far (or just the next unused row if the residual
+    // was zero)
+    int inext = -1;
+    double umax = -1.0;
+    for (int r = 0; r < p; r++) {
+      if (s->used[r]) {
+        continue;
+      }
+      const double u = (k > 0) ? fabs(U[r * cap + k - 1]) : 0.0;
+      if (u > umax) {
+        umax = u;
+        inext = r;
+      }
+    }
+    if (inext < 0) {
+      break;
+    }
+    i = inext;
+  }
+
+  // copy the factors into arrays of the right size
+  *U_out = malloc((size_t)(p + q) * (size_t)(k > 0 ? k : 1) * sizeof(double));
+  if (!*U_out) {
+    return -1;
+  }
+  *V_out = *U_out + p * k;
+  for (int r = 0; r < p; r++) {
+    memcpy(*U_out + r * k, U + r * cap, k * sizeof(double));
+  }
+  for (int j = 0; j < q; j++) {
+    memcpy(*V_out + j * k, V + j * cap, k * sizeof(double));
+  }
+
+  return k;
+}
+
+/**
+ * Recursively builds the node covering [start, start + size), returning its
+ * index or -1 on error.
+ */
+static int build_node(
+    hodlr *h, aca_state *s, const int start, const int size, const int leaf
+) {
+  const int idx = h->nnodes++;
+  hodlr_node *node = h->nodes + idx;
+  node->start = start;
+  node->size = size;
+  node->child[0] = -1;
+  node->child[1] = -1;
+
+  if (size <= leaf) {
+    // dense leaf block
+    node->M = malloc((size_t)size * (size_t)size * sizeof(double));
+    node->piv = malloc(size * sizeof(int));
+    if (!node->M || !node->piv) {
+      return -1;
+    }
+    for (int i = 0; i < size; i++) {
+      for (int j = 0; j < size; j++) {
+        node->M[i * size + j] = s->entry(start + i, start + j, s->ctx);
+      }
+    }
+    return idx;
+  }
+
+  const int n1 = size / 2;
+  const int n2 = size - n1;
+  const int c0 = build_node(h, s, start, n1, leaf);
+  const int c1 = (c0 < 0) ? -1 : build_node(h, s, start + n1, n2, leaf);
+  if (c1 < 0) {
+    return -1;
+  }
+
+  node->child[0] = c0;
+  node->child[1] = c1;
+
+  // compress the upper right block A12 ~ U1 V1^T and the lower left block
+  // A21 ~ U2 V2^T
+  node->k[0] = aca(s, start, n1, start + n1, n2, &node->U[0], &node->V[0]);
+  node->k[1] = aca(s, start + n1, n2, start, n1, &node->U[1], &node->V[1]);
+  if (node->k[0] < 0 || node->k[1] < 0) {
+    return -1;
+  }
+
+  const int K = node->k[0] + node->k[1];
+  node->M = malloc((K > 0 ? (size_t)K * (size_t)K : 1) * sizeof(double));
+  node->piv = malloc((K > 0 ? K : 1) * sizeof(int));
+  if (!node->M || !node->piv) {
+    return -1;
+  }
+  if (K > h->kmax) {
+    h->kmax = K;
+  }
+
+  return idx;
+}
+
+int hodlr_init(
+    hodlr *h, hodlr_entry entry, void *ctx, const int n, const int leaf,
+    const double tol, const int max_rank
+) {
+  memset(h, 0, sizeof(hodlr));
+  if (n < 1 || leaf < 1 || max_rank < 1) {
+    return -1;
+  }
+  h->n = n;
+
+  const int nnodes = count_nodes(n, leaf);
+  h->nodes = calloc(nnodes, sizeof(hodlr_node));
+  if (!h->nodes) {
+    return -1;
+  }
+
+  aca_state s;
+  s.entry = entry;
+  s.ctx = ctx;
+  s.tol = tol;
+  s.max_rank = max_rank;
+  const int half = n / 2 + 1;
+  s.U = malloc(2 * (size_t)half * (size_t)max_rank * sizeof(double));
+  s.used = malloc(half * sizeof(int));
+  if (!s.U || !s.used) {
+    free(s.U);
+    free(s.used);
+    hodlr_free(h);
+    return -1;
+  }
+  s.V = s.U + half * max_rank;
+
+  const int err = build_node(h, &s, 0, n, leaf);
+  free(s.U);
+  free(s.used);
+  if (err < 0) {
+    hodlr_free(h);
+    return -1;
+  }
+
+  return 0;
+}
+
+int hodlr_init_dense(
+    hodlr *h, const double *A, const int n, const int leaf, const double tol,
+    const int max_rank
+) {
+  dense_ctx ctx = {A, n};
+  return hodlr_init(h, dense_entry, &ctx, n, leaf, tol, max_rank);
+}
+
+void hodlr_free(hodlr *h) {
+  for (int i = 0; i < h->nnodes; i++) {
+    free(h->nodes[i].U[0]); // U[0] and V[0] share an allocation
+    free(h->nodes[i].U[1]);
+    free(h->nodes[i].M);
+    free(h->nodes[i].piv);
+  }
+  free(h->nodes);
+  memset(h, 0, sizeof(hodlr));
+}
+
+/**
+ * Solves A_node X = F in place, where F has m columns, using the
+ * factorisations of the node and its descendants.
+ */
+static void solve_node(
+    const hodlr *h, const int idx, double *F, const int m, double *work
+) {
+  const hodlr_node *node = h->nodes + idx;
+  if (node->child[0] < 0) {
+    lu_solve_factorised_multi(node->M, node->piv, F, node->size, m);
+    return;
+  }
+
+  const int n1 = h->nodes[node->child[0]].size;
+  const int n2 = h->nodes[node->child[1]].size;
+  const int k1 = node->k[0];
+  const int k2 = node->k[1];
+  double *F1 = F;
+  double *F2 = F + n1 * m;
+
+  // apply D^-1
+  solve_node(h, node->child[0], F1, m, work);
+  solve_node(h, node->child[1], F2, m, work);
+  if (k1 + k2 == 0) {
+    return;
+  }
+
+  // t = W^T D^-1 F = [V1^T F2; V2^T F1]
+  double *t1 = work;
+  double *t2 = work + k1 * m;
+  memset(work, 0, (k1 + k2) * m * sizeof(double));
+  for (int r = 0; r < n2; r++) {
+    for (int a = 0; a < k1; a++) { // apply to entire row
+      const double v = node->V[0][r * k1 + a];
+      for (int j = 0; j < m; j++) {
+        t1[a * m + j] += v * F2[r * m + j];
+      }
+    }
+  }
+  for (int r = 0; r < n1; r++) {
+    for (int a = 0; a < k2; a++) { // apply to entire row
+      const double v = node->V[1][r * k2 + a];
+      for (int j = 0; j < m; j++) {
+        t2[a * m + j] += v * F1[r * m + j];
+      }
+    }
+  }
+
+  // t = (I + W^T D^-1 U)^-1 t
+  lu_solve_factorised_multi(node->M, node->piv, work, k1 + k2, m);
+
+  // F = D^-1 F - D^-1 U t
+  for (int r = 0; r < n1; r++) {
+    for (int a = 0; a < k1; a++) { // apply to entire row
+      const double y = node->U[0][r * k1 + a];
+      for (int j = 0; j < m; j++) {
+        F1[r * m + j] -= y * t1[a * m + j];
+      }
+    }
+  }
+  for (int r = 0; r < n2; r++) {
+    for (int a = 0; a < k2; a++) { // apply to entire row
+      const double y = node->U[1][r * k2 + a];
+      for (int j = 0; j < m; j++) {
+        F2[r * m + j] -= y * t2[a * m + j];
+      }
+    }
+  }
+}
+
+/**
+ * Factorises the node and its descendants, returning 0 on success or row+1
+ * on failure.
+ */
+static int factorise_node(hodlr *h, const int idx, double *work) {
+  hodlr_node *node = h->nodes + idx;
+  if (node->child[0] < 0) {
+    const int err = lu_factorise(node->M, node->piv, node->size);
+    return (err > 0) ? node->start + err : err;
+  }
+
+  for (int c = 0; c < 2; c++) {
+    const int err = factorise_node(h, node->child[c], work);
+    if (err != 0) {
+      return err;
+    }
+  }
+
+  const int n1 = h->nodes[node->child[0]].size;
+  const int n2 = h->nodes[node->child[1]].size;
+  const int k1 = node->k[0];
+  const int k2 = node->k[1];
+  const int K = k1 + k2;
+
+  // overwrite U1 and U2 with Y1 = A11^-1 U1 and Y2 = A22^-1 U2
+  if (k1 > 0) {
+    solve_node(h, node->child[0], node->U[0], k1, work);
+  }
+  if (k2 > 0) {
+    solve_node(h, node->child[1], node->U[1], k2, work);
+  }
+
+  // M = [I V1^T Y2; V2^T Y1 I]
+  double *M = node->M;
+  memset(M, 0, K * K * sizeof(double));
+  for (int a = 0; a < K; a++) {
+    M[a * K + a] = 1.0;
+  }
+  for (int r = 0; r < n2; r++) {
+    for (int a = 0; a < k1; a++) {
+      const double v = node->V[0][r * k1 + a];
+      for (int b = 0; b < k2; b++) {
+        M[a * K + k1 + b] += v * node->U[1][r * k2 + b];
+      }
+    }
+  }
+  for (int r = 0; r < n1; r++) {
+    for (int a = 0; a < k2; a++) {
+      const double v = node->V[1][r * k2 + a];
+      for (int b = 0; b < k1; b++) {
+        M[(k1 + a) * K + b] += v * node->U[0][r * k1 + b];
+      }
+    }
+  }
+
+  const int err = lu_factorise(M, node->piv, K);
+  return (err > 0) ? node->start + 1 : err;
+}
+
+int hodlr_factorise(hodlr *h) {
+  // solves with up to kmax right-hand sides need up to kmax^2 workspace
+  const int kmax = (h->kmax > 0) ? h->kmax : 1;
+  double *work = malloc((size_t)kmax * (size_t)kmax * sizeof(double));
+  if (!work) {
+    return -1;
+  }
+
+  const int err = factorise_node(h, 0, work);
+  free(work);
+  return err;
+}
+
+void hodlr_solve(const hodlr *h, double *f, double *work) {
+  solve_node(h, 0, f, 1, work);
+}
+
+size_t hodlr_solve_work_size(const hodlr *h, const int m) {
+  const size_t kmax = (size_t)((h->kmax > 0) ? h->kmax : 1);
+  return kmax * (size_t)((m > 1) ? m : 1);
+}
+
+void hodlr_solve_multi(const hodlr *h, double *F, const int m, double *work) {
+  solve_node(h, 0, F, m, work);
+}
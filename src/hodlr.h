@@ -0,0 +1,138 @@
+#ifndef HODLR_H
+#define HODLR_H
+
+#include <stddef.h>
+
+/**
+ * Hierarchical off-diagonal low-rank (HODLR) fast direct solver for dense
+ * matrices whose off-diagonal blocks are numerically low-rank, such as those
+ * arising from boundary integral equations or smooth kernels.
+ *
+ * The matrix is split recursively in half,
+ *   A = [A11 U1 V1^T; U2 V2^T A22]
+ * until the diagonal blocks are at most `leaf` in size, where they are stored
+ * densely. Each off-diagonal block is compressed with adaptive cross
+ * approximation (ACA) with partial pivoting, which only evaluates O(k(p + q))
+ * entries of a p x q block of rank k, so the matrix never needs to be formed.
+ *
+ * Each level is then the 2x2 block solve of `block_solve`, except that the
+ * off-diagonal blocks are low-rank. Writing A = diag(A11, A22) + U W^T, the
+ * Sherman-Morrison-Woodbury formula reduces the solve to solves with the
+ * diagonal blocks (performed recursively) and a small dense (k1 + k2) x
+ * (k1 + k2) LU factorisation. For bounded ranks, the factorisation takes
+ * O(n log^2 n) steps and each solve O(n log n), rather than the O(n^3) and
+ * O(n^2) of `lu_solve`.
+ *
+ * As in `block_solve`, the diagonal blocks at every level are assumed to be
+ * invertible.
+ */
+
+/**
+ * Function returning the entry A[i][j] of the matrix.
+ */
+typedef double (*hodlr_entry)(int i, int j, void *ctx);
+
+/**
+ * A node in the HODLR tree, covering rows and columns [start, start + size).
+ */
+typedef struct {
+  int start; // first row/column of the diagonal block
+  int size; // size of the diagonal block
+  int child[2]; // indices of the two children, or -1 for a leaf
+  int k[2]; // ranks of the upper right and lower left blocks
+  double *U[2]; // U1 and U2, overwritten with A11^-1 U1 and A22^-1 U2
+  double *V[2]; // V1 and V2, such that A12 ~ U1 V1^T and A21 ~ U2 V2^T
+  double *M; // LU factorisation of the SMW matrix, or of the dense leaf
+  int *piv; // pivot array for M
+} hodlr_node;
+
+/**
+ * HODLR representation of an n x n matrix.
+ */
+typedef struct {
+  int n; // size of the matrix
+  int nnodes; // number of nodes in the tree
+  hodlr_node *nodes; // nodes of the tree, with the root first
+  int kmax; // largest value of k1 + k2 over all the nodes
+} hodlr;
+
+/**
+ * Builds the HODLR representation of a matrix from a function which computes
+ * its entries.
+ *
+ * @param h HODLR matrix to initialise, must be freed with hodlr_free
+ * @param entry function returning A[i][j]
+ * @param ctx context passed to entry
+ * @param n size of the matrix
+ * @param leaf maximum size of the dense diagonal blocks
+ * @param tol relative tolerance of the low-rank approximations
+ * @param max_rank maximum rank of the low-rank approximations
+ * @return 0 on success, -1 on error
+ */
+int hodlr_init(
+    hodlr *h, hodlr_entry entry, void *ctx, int n, int leaf, double tol,
+    int max_rank
+);
+
+/**
+ * Builds the HODLR representation of a dense, flattened, matrix.
+ *
+ * @param h HODLR matrix to initialise, must be freed with hodlr_free
+ * @param A flattened matrix (n x n), left unchanged
+ * @param n size of the matrix
+ * @param leaf maximum size of the dense diagonal blocks
+ * @param tol relative tolerance of the low-rank approximations
+ * @param max_rank maximum rank of the low-rank approximations
+ * @return 0 on success, -1 on error
+ */
+int hodlr_init_dense(
+    hodlr *h, const double *A, int n, int leaf, double tol, int max_rank
+);
+
+/**
+ * Frees the memory held by a HODLR matrix.
+ *
+ * @param h HODLR matrix to free
+ */
+void hodlr_free(hodlr *h);
+
+/**
+ * Factorises a HODLR matrix in place.
+ *
+ * @param h HODLR matrix, overwritten with its factorisation
+ * @return 0 on success, row+1 on factorisation failure (the first row of the
+ * block which could not be factorised), -1 on other error
+ */
+int hodlr_factorise(hodlr *h);
+
+/**
+ * Given a factorised HODLR matrix, solves Ax = f in place.
+ *
+ * @param h factorised HODLR matrix
+ * @param f right-hand side vector, overwritten with the solution
+ * @param work interim workspace, should be at least size h->kmax (see
+ * `hodlr_solve_work_size`)
+ */
+void hodlr_solve(const hodlr *h, double *f, double *work);
+
+/**
+ * Given a factorised HODLR matrix, solves AX = F in place.
+ *
+ * @param h factorised HODLR matrix
+ * @param F right-hand side vectors (n x m), overwritten with the solution
+ * @param m number of right-hand side vectors
+ * @param work interim workspace, should be at least size h->kmax * m
+ */
+void hodlr_solve_multi(const hodlr *h, double *F, int m, double *work);
+
+/**
+ * Computes the size of the workspace needed by `hodlr_solve_multi` (or, with
+ * m = 1, by `hodlr_solve`).
+ *
+ * @param h HODLR matrix
+ * @param m number of right-hand side vectors
+ * @return the number of doubles needed for the workspace
+ */
+size_t hodlr_solve_work_size(const hodlr *h, int m);
+
+#endif // HODLR_H
@@ -1,16 +1,515 @@
 #include "io.h"
 
-void mat_fprintf(
-    FILE *stream, const char *fmt, const double *A, const int n, const int m
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define IO_MMAP
+#endif
+
+#define IO_CHUNK ((size_t)1 << 22) // size of the blocks read by mat_input
+#define IO_PARALLEL_MIN ((size_t)1 << 20) // smallest text parsed in parallel
+#define IO_MAX_PIECES (256) // largest number of pieces parsed in parallel
+#define IO_MAX_TOKEN (64) // longest token converted without allocating
+#define IO_WRITE_BLOCK ((size_t)1 << 22) // text formatted before each write
+
+#define MAT_BIN_MAGIC "LAMATRIX"
+#define MAT_BIN_ENDIAN (0x01020304u)
+
+#define BAND_MAGIC "LABANDED"
+#define BAND_MAX_HEADER (64) // longest header line of a banded text file
+
+#define NPY_MAGIC "\x93NUMPY"
+#define NPY_PREFIX (10) // magic, version and header length of a version 1 file
+#define NPY_ALIGN (64) // alignment of the data in .npy files
+#define NPY_MAX_HEADER (256) // longest header written or parsed on the stack
+
+#define ZIP_LOCAL (30) // fixed part of a local file header
+#define ZIP_CENTRAL (46) // fixed part of a central directory entry
+#define ZIP_MAX_NAME (256) // longest name of an array written to an archive
+#define ZIP_MAX_EXTRA (4 + 16 + 6 + NPY_ALIGN) // zip64 and alignment fields
+#define ZIP_LIMIT (0xffffffffu) // sizes and offsets at least this need zip64
+#define ZIP_DATE (0x21) // 1 January 1980, the earliest date a zip can store
+#define ZIP_ALIGN_ID (0xd935) // id of the alignment extra field (as zipalign)
+
+/**
+ * A growable text buffer, reused for every block formatted by one thread.
+ */
+typedef struct {
+  char *buf;
+  size_t len;
+  size_t cap;
+} text_buf;
+
+/**
+ * Makes room for at least extra more characters in the buffer.
+ */
+static int text_reserve(text_buf *b, const size_t extra) {
+  if (b->len + extra <= b->cap) {
+    return 0;
+  }
+  size_t cap = (b->cap) ? b->cap : 4096;
+  while (cap < b->len + extra) {
+    cap *= 2;
+  }
+  char *buf = realloc(b->buf, cap);
+  if (!buf) {
+    return 1;
+  }
+  b->buf = buf;
+  b->cap = cap;
+  return 0;
+}
+
+/**
+ * Writes the decimal digits of k to s, returning the number written.
+ */
+static size_t format_uint(char *s, uint64_t k) {
+  char tmp[20];
+  size_t n = 0;
+  do {
+    tmp[n++] = (char)('0' + k % 10);
+    k /= 10;
+  } while (k);
+  for (size_t i = 0; i < n; i++) {
+    s[i] = tmp[n - 1 - i];
+  }
+  return n;
+}
+
+/**
+ * A floating-point number f * 2^e with a 64-bit significand, as used by Grisu.
+ */
+typedef struct {
+  uint64_t f;
+  int e;
+} diy_fp;
+
+/**
+ * Normalised approximations of 10^k for k = -348, -340, ..., 340, each
+ * rounded to 64 bits, with their binary exponents.
+ */
+static const uint64_t cached_f[87] = {
+    0xfa8fd5a0081c0288u, 0xbaaee17fa23ebf76u, 0x8b16fb203055ac76u,
+    0xcf42894a5dce35eau, 0x9a6bb0aa55653b2du, 0xe61acf033d1a45dfu,
+    0xab70fe17c79ac6cau, 0xff77b1fcbebcdc4fu, 0xbe5691ef416bd60cu,
+    0x8dd01fad907ffc3cu, 0xd3515c2831559a83u, 0x9d71ac8fada6c9b5u,
+    0xea9c227723ee8bcbu, 0xaecc49914078536du, 0x823c12795db6ce57u,
+    0xc21094364dfb5637u, 0x9096ea6f3848984fu, 0xd77485cb25823ac7u,
+    0xa086cfcd97bf97f4u, 0xef340a98172aace5u, 0xb23867fb2a35b28eu,
+    0x84c8d4dfd2c63f3bu, 0xc5dd44271ad3cdbau, 0x936b9fcebb25c996u,
+    0xdbac6c247d62a584u, 0xa3ab66580d5fdaf6u, 0xf3e2f893dec3f126u,
+    0xb5b5ada8aaff80b8u, 0x87625f056c7c4a8bu, 0xc9bcff6034c13053u,
+    0x964e858c91ba2655u, 0xdff9772470297ebdu, 0xa6dfbd9fb8e5b88fu,
+    0xf8a95fcf88747d94u, 0xb94470938fa89bcfu, 0x8a08f0f8bf0f156bu,
+    0xcdb02555653131b6u, 0x993fe2c6d07b7facu, 0xe45c10c42a2b3b06u,
+    0xaa242499697392d3u, 0xfd87b5f28300ca0eu, 0xbce5086492111aebu,
+    0x8cbccc096f5088ccu, 0xd1b71758e219652cu, 0x9c40000000000000u,
+    0xe8d4a51000000000u, 0xad78ebc5ac620000u, 0x813f3978f8940984u,
+    0xc097ce7bc90715b3u, 0x8f7e32ce7bea5c70u, 0xd5d238a4abe98068u,
+    0x9f4f2726179a2245u, 0xed63a231d4c4fb27u, 0xb0de65388cc8ada8u,
+    0x83c7088e1aab65dbu, 0xc45d1df942711d9au, 0x924d692ca61be758u,
+    0xda01ee641a708deau, 0xa26da3999aef774au, 0xf209787bb47d6b85u,
+    0xb454e4a179dd1877u, 0x865b86925b9bc5c2u, 0xc83553c5c8965d3du,
+    0x952ab45cfa97a0b3u, 0xde469fbd99a05fe3u, 0xa59bc234db398c25u,
+    0xf6c69a72a3989f5cu, 0xb7dcbf5354e9beceu, 0x88fcf317f22241e2u,
+    0xcc20ce9bd35c78a5u, 0x98165af37b2153dfu, 0xe2a0b5dc971f303au,
+    0xa8d9d1535ce3b396u, 0xfb9b7cd9a4a7443cu, 0xbb764c4ca7a44410u,
+    0x8bab8eefb6409c1au, 0xd01fef10a657842cu, 0x9b10a4e5e9913129u,
+    0xe7109bfba19c0c9du, 0xac2820d9623bf429u, 0x80444b5e7aa7cf85u,
+    0xbf21e44003acdd2du, 0x8e679c2f5e44ff8fu, 0xd433179d9c8cb841u,
+    0x9e19db92b4e31ba9u, 0xeb96bf6ebadf77d9u, 0xaf87023b9bf0ee6bu
+};
+static const int16_t cached_e[87] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954,
+    -927, -901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635,
+    -608, -582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316,
+    -289, -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30, 56,
+    83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348, 375, 402, 428, 455,
+    481, 508, 534, 561, 588, 614, 641, 667, 694, 720, 747, 774, 800, 827, 853,
+    880, 907, 933, 960, 986, 1013, 1039, 1066
+};
+
+/**
+ * Computes p = x * y, rounding the product to 64 bits.
+ */
+static void diy_mul(diy_fp *p, const diy_fp *x, const diy_fp *y) {
+  const uint64_t mask = 0xffffffffu;
+  const uint64_t a = x->f >> 32, b = x->f & mask;
+  const uint64_t c = y->f >> 32, d = y->f & mask;
+  const uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+  uint64_t tmp = (bd >> 32) + (ad & mask) + (bc & mask);
+  tmp += (uint64_t)1 << 31; // round
+  p->f = ac + (ad >> 32) + (bc >> 32) + (tmp >> 32);
+  p->e = x->e + y->e + 64;
+}
+
+/**
+ * Shifts x so that the top bit of its significand is set.
+ */
+static void diy_normalize(diy_fp *x) {
+  while (!(x->f & ((uint64_t)1 << 63))) {
+    x->f <<= 1;
+    x->e--;
+  }
+}
+
+/**
+ * Moves the last digit of the buffer towards w while it stays within the
+ * rounding interval, so that the result is as close to w as possible.
+ */
+static void grisu_round(
+    char *buf, const int len, const uint64_t delta, uint64_t rest,
+    const uint64_t ten_kappa, const uint64_t wp_w
+) {
+  while (rest < wp_w && delta - rest >= ten_kappa &&
+         (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+    buf[len - 1]--;
+    rest += ten_kappa;
+  }
+}
+
+/**
+ * Writes the digits of the positive finite double v to buf, returning the
+ * number of digits, so that v is digits * 10^k.
+ *
+ * This is Grisu2 (Loitsch 2010): the rounding interval of v is scaled by a
+ * cached power of ten so that its upper end has its binary point within a
+ * 64-bit word, and digits are generated until what remains falls inside the
+ * interval. The result always reads back to exactly v, and is the shortest
+ * such decimal for all but a small fraction of doubles.
+ */
+static int grisu2(const double v, char *buf, int *k) {
+  static const uint64_t pow10[20] = {
+      1u,
+      10u,
+      100u,
+      1000u,
+      10000u,
+      100000u,
+      1000000u,
+      10000000u,
+      100000000u,
+      1000000000u,
+      10000000000u,
+      100000000000u,
+      1000000000000u,
+      10000000000000u,
+      100000000000000u,
+      1000000000000000u,
+      10000000000000000u,
+      100000000000000000u,
+      1000000000000000000u,
+      10000000000000000000u};
+  const uint64_t hidden = (uint64_t)1 << 52;
+
+  // v = w.f * 2^w.e, and its neighbours are half an ulp either side
+  uint64_t bits;
+  memcpy(&bits, &v, sizeof(double));
+  const int biased = (int)((bits >> 52) & 0x7ff);
+  diy_fp w = {bits & (hidden - 1), -1074};
+  if (biased) {
+    w.f += hidden;
+    w.e = biased - 1075;
+  }
+  diy_fp plus = {(w.f << 1) + 1, w.e - 1};
+  diy_normalize(&plus);
+  diy_fp minus = {(w.f << 1) - 1, w.e - 1};
+  if (w.f == hidden) {
+    minus.f = (w.f << 2) - 1; // the gap below a power of two is smaller
+    minus.e = w.e - 2;
+  }
+  minus.f <<= minus.e - plus.e;
+  minus.e = plus.e;
+
+  // scale by a power of ten which puts the exponent in [-60, -32]
+  const double dk = (-61 - plus.e) * 0.30102999566398114 + 347;
+  int kk = (int)dk;
+  if (dk - kk > 0.0) {
+    kk++;
+  }
+  const int index = (kk >> 3) + 1;
+  *k = 348 - index * 8;
+  const diy_fp c = {cached_f[index], cached_e[index]};
+  diy_fp W, Wp, Wm;
+  diy_normalize(&w);
+  diy_mul(&W, &w, &c);
+  diy_mul(&Wp, &plus, &c);
+  diy_mul(&Wm, &minus, &c);
+  Wm.f++;
+  Wp.f--;
+
+  // generate digits from the integer part of Wp, then the fractional part
+  const int shift = -Wp.e;
+  const uint64_t one = (uint64_t)1 << shift;
+  const uint64_t wp_w = Wp.f - W.f;
+  uint64_t delta = Wp.f - Wm.f;
+  uint64_t p1 = Wp.f >> shift; // fits in 32 bits
+  uint64_t p2 = Wp.f & (one - 1);
+  int len = 0;
+  int kappa = 10;
+  while (kappa > 1 && p1 < pow10[kappa - 1]) {
+    kappa--;
+  }
+  while (kappa > 0) {
+    const uint64_t d = p1 / pow10[kappa - 1];
+    p1 %= pow10[kappa - 1];
+    if (d || len) {
+      buf[len++] = (char)('0' + d);
+    }
+    kappa--;
+    const uint64_t rest = ((uint64_t)p1 << shift) + p2;
+    if (rest <= delta) {
+      *k += kappa;
+      grisu_round(buf, len, delta, rest, pow10[kappa] << shift, wp_w);
+      return len;
+    }
+  }
+  for (;;) {
+    p2 *= 10;
+    delta *= 10;
+    const char d = (char)(p2 >> shift);
+    if (d || len) {
+      buf[len++] = (char)('0' + d);
+    }
+    p2 &= one - 1;
+    kappa--;
+    if (p2 < delta) {
+      *k += kappa;
+      const uint64_t scale = (-kappa < 20) ? pow10[-kappa] : 0;
+      grisu_round(buf, len, delta, p2, one, wp_w * scale);
+      return len;
+    }
+  }
+}
+
+/**
+ * Integers below 10^15 are written directly and everything else goes through
+ * grisu2. As with %.17g, scientific notation is used for exponents below -4 or
+ * above 16.
+ */
+size_t mat_sprint_exact(char *s, double x) {
+  size_t n = 0;
+  if (signbit(x)) {
+    s[n++] = '-';
+    x = -x;
+  }
+  if (isnan(x) || isinf(x)) {
+    memcpy(s + n, isnan(x) ? "nan" : "inf", 3);
+    return n + 3;
+  }
+  if (x < 1e15) {
+    const uint64_t i = (uint64_t)x;
+    const double xi = (double)i;
+    if (memcmp(&xi, &x, sizeof(double)) == 0) {
+      return n + format_uint(s + n, i);
+    }
+  }
+
+  char digits[20];
+  int k;
+  const int len = grisu2(x, digits, &k);
+  const int exp = len + k - 1; // decimal exponent of the leading digit
+
+  if (exp < -4 || exp > 16) {
+    s[n++] = digits[0];
+    if (len > 1) {
+      s[n++] = '.';
+      memcpy(s + n, digits + 1, (size_t)(len - 1));
+      n += (size_t)(len - 1);
+    }
+    s[n++] = 'e';
+    s[n++] = (exp < 0) ? '-' : '+';
+    if (exp > -10 && exp < 10) {
+      s[n++] = '0';
+    }
+    return n + format_uint(s + n, (uint64_t)((exp < 0) ? -exp : exp));
+  }
+
+  if (exp < 0) {
+    // 0.000ddd
+    s[n++] = '0';
+    s[n++] = '.';
+    for (int i = 0; i < -exp - 1; i++) {
+      s[n++] = '0';
+    }
+    memcpy(s + n, digits, (size_t)len);
+    return n + (size_t)len;
+  }
+
+  memcpy(s + n, digits, (size_t)len);
+  if (len <= exp + 1) {
+    // ddd000
+    for (int i = len; i <= exp; i++) {
+      s[n + (size_t)i] = '0';
+    }
+    return n + (size_t)exp + 1;
+  }
+
+  // ddd.ddd
+  memmove(s + n + exp + 2, s + n + exp + 1, (size_t)(len - exp - 1));
+  s[n + (size_t)exp + 1] = '.';
+  return n + (size_t)len + 1;
+}
+
+/**
+ * Formats rows [i0, i1) of A, whose entry (i, j) is A[i * rs + j * cs], into
+ * the buffer, replacing its contents. Entries are written with fmt[0] (with a
+ * trailing space) or fmt[1] (with a trailing newline) at the end of a row, or
+ * with mat_sprint_exact if fmt is NULL.
+ */
+static int format_rows(
+    text_buf *b, char *const *fmt, const double *A, const size_t rs,
+    const size_t cs, const int i0, const int i1, const int m
+) {
+  b->len = 0;
+  if (text_reserve(b, MAT_EXACT_MAX + 1)) {
+    return 1;
+  }
+  for (int i = i0; i < i1; i++) {
+    const double *row = A + (size_t)i * rs;
+    for (int j = 0; j < m; j++) {
+      const double x = row[(size_t)j * cs];
+      if (fmt) {
+        const char *f = fmt[j == m - 1];
+        size_t avail = b->cap - b->len;
+        int len = snprintf(b->buf + b->len, avail, f, x);
+        if (len < 0) {
+          return 1;
+        }
+        if ((size_t)len >= avail) {
+          // too long for the space left, so grow the buffer and try again
+          if (text_reserve(b, (size_t)len + 1)) {
+            return 1;
+          }
+          avail = b->cap - b->len;
+          len = snprintf(b->buf + b->len, avail, f, x);
+        }
+        b->len += (size_t)len;
+      } else {
+        b->len += mat_sprint_exact(b->buf + b->len, x);
+        b->buf[b->len++] = (j < m - 1) ? ' ' : '\n';
+      }
+      if (text_reserve(b, MAT_EXACT_MAX + 1)) {
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+/**
+ * Writes the n x m matrix A, whose entry (i, j) is A[i * rs + j * cs], to a
+ * stream, so a transposed matrix is written with rs = 1.
+ *
+ * Rows are formatted into large buffers and written with a single fwrite per
+ * buffer, rather than with a call to fprintf for every entry. If OpenMP is
+ * enabled and the matrix is large, each block of rows is split into one
+ * contiguous range per thread, the ranges are formatted in parallel, and the
+ * buffers are then written in order.
+ */
+static int write_text(
+    FILE *stream, const char *fmt, const double *A, const size_t rs,
+    const size_t cs, const int n, const int m
 ) {
-  for (int i = 0; i < n; i++) {
-    for (int j = 0; j < m - 1; j++) {
-      fprintf(stream, fmt, A[i * m + j]);
-      fprintf(stream, " ");
+  if (n <= 0 || m <= 0) {
+    return 0;
+  }
+
+  // rows formatted into each buffer, assuming around 16 characters per entry
+  const size_t row_len = (size_t)m * 16 + 1;
+  const size_t rows = (row_len < IO_WRITE_BLOCK) ? IO_WRITE_BLOCK / row_len : 1;
+
+  int nbuf = 1;
+#ifdef _OPENMP
+  if ((size_t)n * row_len >= IO_PARALLEL_MIN) {
+    nbuf = omp_get_max_threads();
+    nbuf = (nbuf < IO_MAX_PIECES) ? nbuf : IO_MAX_PIECES;
+  }
+#endif
+  const int step = (rows * (size_t)nbuf < (size_t)n) ? (int)rows * nbuf : n;
+
+  // append the separators to the format, so each entry needs a single call
+  char *fmts[2] = {NULL, NULL};
+  if (fmt) {
+    const size_t len = strlen(fmt);
+    fmts[0] = malloc(2 * (len + 2));
+    if (!fmts[0]) {
+      return 1;
+    }
+    fmts[1] = fmts[0] + len + 2;
+    memcpy(fmts[0], fmt, len);
+    memcpy(fmts[1], fmt, len);
+    memcpy(fmts[0] + len, " ", 2);
+    memcpy(fmts[1] + len, "\n", 2);
+  }
+
+  text_buf bufs[IO_MAX_PIECES];
+  memset(bufs, 0, sizeof(bufs));
+
+  int err = 0;
+  for (int i0 = 0; i0 < n && !err; i0 = (n - i0 > step) ? i0 + step : n) {
+    const int nb = (n - i0 > step) ? step : n - i0;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) reduction(| : err) if (nbuf > 1)
+#endif
+    for (int t = 0; t < nbuf; t++) {
+      const int r0 = i0 + (int)((long)nb * t / nbuf);
+      const int r1 = i0 + (int)((long)nb * (t + 1) / nbuf);
+      err |= format_rows(&bufs[t], fmt ? fmts : NULL, A, rs, cs, r0, r1, m);
+    }
+
+    for (int t = 0; t < nbuf && !err; t++) {
+      if (fwrite(bufs[t].buf, 1, bufs[t].len, stream) != bufs[t].len) {
+        err = 1;
+      }
     }
-    fprintf(stream, fmt, A[i * m + m - 1]);
-    fprintf(stream, "\n");
   }
+
+  for (int t = 0; t < nbuf; t++) {
+    free(bufs[t].buf);
+  }
+  free(fmts[0]);
+  return err;
+}
+
+/**
+ * Writes a matrix to a new text file.
+ */
+static int output_text(
+    const char *filename, const char *fmt, const double *A, const size_t rs,
+    const size_t cs, const int n, const int m
+) {
+  FILE *fp = fopen(filename, "w");
+  if (fp == NULL) {
+    return 1;
+  }
+
+  int err = write_text(fp, fmt, A, rs, cs, n, m);
+
+  if (fclose(fp) != 0) {
+    err = 1;
+  }
+
+  return err;
+}
+
+void mat_fprintf(
+    FILE *stream, const char *fmt, const double *A, const int n, const int m
+) {
+  write_text(stream, fmt, A, (size_t)m, 1, n, m);
 }
 
 void mat_fprint(FILE *stream, const double *A, const int n, const int m) {
@@ -25,43 +524,1735 @@ void mat_print(const double *A, const int n, const int m) {
   mat_fprint(stdout, A, n, m);
 }
 
+void mat_fprint_exact(
+    FILE *stream, const double *A, const int n, const int m
+) {
+  write_text(stream, NULL, A, (size_t)m, 1, n, m);
+}
+
 int mat_outputf(
     const char *filename, const char *fmt, const double *A, const int n,
     const int m
 ) {
-  FILE *fp = fopen(filename, "w");
-  if (fp == NULL) {
+  return output_text(filename, fmt, A, (size_t)m, 1, n, m);
+}
+
+int mat_output(
+    const char *filename, const double *A, const int n, const int m
+) {
+  return output_text(filename, NULL, A, (size_t)m, 1, n, m);
+}
+
+/**
+ * Checks for the whitespace accepted between entries (as for isspace in the C
+ * locale).
+ */
+static int is_space(const char c) {
+  return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' ||
+         c == '\f';
+}
+
+/**
+ * Converts a token which the fast path could not handle with strtod, which is
+ * exactly rounded and also accepts hexadecimal, infinities and NaNs.
+ */
+static int parse_double_slow(const char *s, const size_t len, double *x) {
+  char small[IO_MAX_TOKEN + 1];
+  char *tok = (len <= IO_MAX_TOKEN) ? small : malloc(len + 1);
+  if (!tok) {
     return 1;
   }
+  memcpy(tok, s, len);
+  tok[len] = '\0';
 
-  mat_fprintf(fp, fmt, A, n, m);
+  char *end;
+  *x = strtod(tok, &end);
+  const int err = (end != tok + len);
 
-  fclose(fp);
+  if (tok != small) {
+    free(tok);
+  }
+  return err;
+}
+
+/**
+ * Converts the token s[0..len) to a double, rounding exactly.
+ *
+ * Most tokens have at most 19 significant digits and a small exponent, in
+ * which case the digits are exactly representable as an integer m < 2^53 and
+ * the value is m * 10^e or m / 10^-e for |e| <= 22. Both operands are then
+ * exact, so a single correctly rounded IEEE multiplication or division gives
+ * the exactly rounded result (Clinger 1990). Anything else falls back to
+ * strtod.
+ */
+static int parse_double(const char *s, const size_t len, double *x) {
+  static const double pow10[23] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                   1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                   1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                   1e18, 1e19, 1e20, 1e21, 1e22};
+  size_t i = 0;
+
+  // sign
+  const int neg = (len > 0 && s[0] == '-');
+  if (len > 0 && (s[0] == '-' || s[0] == '+')) {
+    i++;
+  }
 
+  // digits, with an optional decimal point
+  uint64_t mant = 0;
+  int ndigits = 0; // number of digits in mant, ignoring leading zeros
+  int nseen = 0; // number of digits in the token
+  int e = 0;
+  int point = 0;
+  for (; i < len; i++) {
+    const char c = s[i];
+    if (c >= '0' && c <= '9') {
+      nseen++;
+      if (mant == 0 && c == '0') {
+        e -= point; // leading zeros only shift the exponent
+        continue;
+      }
+      if (ndigits == 19) {
+        return parse_double_slow(s, len, x); // too many digits
+      }
+      mant = mant * 10 + (uint64_t)(c - '0');
+      ndigits++;
+      e -= point;
+    } else if (c == '.' && !point) {
+      point = 1;
+    } else {
+      break;
+    }
+  }
+  if (nseen == 0) {
+    return parse_double_slow(s, len, x); // e.g. inf or nan
+  }
+
+  // exponent
+  if (i < len && (s[i] == 'e' || s[i] == 'E')) {
+    i++;
+    const int eneg = (i < len && s[i] == '-');
+    if (i < len && (s[i] == '-' || s[i] == '+')) {
+      i++;
+    }
+    if (i == len) {
+      return 1;
+    }
+    int exp = 0;
+    for (; i < len && s[i] >= '0' && s[i] <= '9'; i++) {
+      if (exp < 100000) {
+        exp = exp * 10 + (s[i] - '0');
+      }
+    }
+    e += eneg ? -exp : exp;
+  }
+  if (i != len) {
+    return parse_double_slow(s, len, x); // e.g. hexadecimal, or not a number
+  }
+
+  if (mant == 0) {
+    *x = neg ? -0.0 : 0.0;
+    return 0;
+  }
+  if (mant > ((uint64_t)1 << 53) || e < -22 || e > 22) {
+    return parse_double_slow(s, len, x);
+  }
+
+  const double v = (double)mant;
+  *x = (e >= 0) ? v * pow10[e] : v / pow10[-e];
+  if (neg) {
+    *x = -*x;
+  }
   return 0;
 }
 
-int mat_output(
+/**
+ * Counts the whitespace-separated tokens in text[0..len).
+ */
+static size_t count_tokens(const char *text, const size_t len) {
+  size_t count = 0;
+  int in_token = 0;
+  for (size_t i = 0; i < len; i++) {
+    const int space = is_space(text[i]);
+    count += (!space && !in_token);
+    in_token = !space;
+  }
+  return count;
+}
+
+/**
+ * Parses up to count tokens from text[0..len) into A, serially.
+ */
+static int parse_serial(
+    const char *text, const size_t len, double *A, const size_t count,
+    size_t *nread
+) {
+  size_t k = 0;
+  size_t i = 0;
+  while (k < count) {
+    while (i < len && is_space(text[i])) {
+      i++;
+    }
+    if (i == len) {
+      break;
+    }
+    size_t j = i;
+    while (j < len && !is_space(text[j])) {
+      j++;
+    }
+    if (parse_double(text + i, j - i, &A[k]) != 0) {
+      *nread = k;
+      return 1;
+    }
+    k++;
+    i = j;
+  }
+
+  *nread = k;
+  return 0;
+}
+
+int mat_parse(
+    const char *text, const size_t len, double *A, const size_t count,
+    size_t *nread
+) {
+  int npieces = 1;
+#ifdef _OPENMP
+  if (len >= IO_PARALLEL_MIN) {
+    npieces = omp_get_max_threads();
+    npieces = (npieces > IO_MAX_PIECES) ? IO_MAX_PIECES : npieces;
+  }
+#endif
+  if (npieces == 1) {
+    return parse_serial(text, len, A, count, nread);
+  }
+
+  // split the text into pieces at whitespace, so no token is cut in two
+  size_t bounds[IO_MAX_PIECES + 1];
+  size_t start[IO_MAX_PIECES + 1];
+  bounds[0] = 0;
+  for (int t = 1; t < npieces; t++) {
+    size_t b = len / (size_t)npieces * (size_t)t;
+    b = (b < bounds[t - 1]) ? bounds[t - 1] : b;
+    while (b < len && !is_space(text[b])) {
+      b++;
+    }
+    bounds[t] = b;
+  }
+  bounds[npieces] = len;
+
+  // find where each piece's entries start, then parse the pieces in parallel
+  start[0] = 0;
+  for (int t = 0; t < npieces; t++) {
+    const size_t piece = bounds[t + 1] - bounds[t];
+    start[t + 1] = start[t] + count_tokens(text + bounds[t], piece);
+  }
+
+  size_t first_bad = count; // index of the first token which failed to parse
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) num_threads(npieces)
+#endif
+  for (int t = 0; t < npieces; t++) {
+    if (start[t] >= count) {
+      continue;
+    }
+    const size_t limit = (start[t + 1] < count) ? start[t + 1] : count;
+    size_t k;
+    if (parse_serial(
+            text + bounds[t], bounds[t + 1] - bounds[t], A + start[t],
+            limit - start[t], &k
+        ) != 0) {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+      if (start[t] + k < first_bad) {
+        first_bad = start[t] + k;
+      }
+    }
+  }
+
+  if (first_bad < count) {
+    *nread = first_bad;
+    return 1;
+  }
+  *nread = (start[npieces] < count) ? start[npieces] : count;
+  return 0;
+}
+
+/**
+ * Reverses the bytes of each of count items of the given size.
+ */
+static void swap_bytes(void *data, const size_t size, const size_t count) {
+  unsigned char *p = data;
+  for (size_t k = 0; k < count; k++, p += size) {
+    for (size_t i = 0; i < size / 2; i++) {
+      const unsigned char tmp = p[i];
+      p[i] = p[size - 1 - i];
+      p[size - 1 - i] = tmp;
+    }
+  }
+}
+
+/**
+ * Copies a field out of a header, correcting its byte order if necessary.
+ */
+static void get_field(
+    void *field, const unsigned char *buf, const size_t offset,
+    const size_t size, const int swap
+) {
+  memcpy(field, buf + offset, size);
+  if (swap) {
+    swap_bytes(field, size, 1);
+  }
+}
+
+/**
+ * Writes the header, and any padding before the data, to a binary file.
+ */
+static int write_header(FILE *fp, const mat_header *h) {
+  const uint32_t version = MAT_BIN_VERSION;
+  const uint32_t dtype = MAT_BIN_F64;
+  const uint32_t endian = MAT_BIN_ENDIAN;
+  const uint32_t flags = h->cyclic ? 1u : 0u;
+  const uint64_t rows = (uint64_t)h->rows;
+  const uint64_t cols = (uint64_t)h->cols;
+  const uint64_t stride = (uint64_t)h->stride;
+  const int32_t kl = h->kl;
+  const int32_t ku = h->ku;
+  const uint64_t offset = h->data_offset;
+
+  unsigned char buf[MAT_BIN_HEADER_SIZE] = {0};
+  memcpy(buf, MAT_BIN_MAGIC, 8);
+  memcpy(buf + 8, &version, 4);
+  memcpy(buf + 12, &dtype, 4);
+  memcpy(buf + 16, &endian, 4);
+  memcpy(buf + 20, &flags, 4);
+  memcpy(buf + 24, &rows, 8);
+  memcpy(buf + 32, &cols, 8);
+  memcpy(buf + 40, &stride, 8);
+  memcpy(buf + 48, &kl, 4);
+  memcpy(buf + 52, &ku, 4);
+  memcpy(buf + 56, &offset, 8);
+  if (fwrite(buf, 1, MAT_BIN_HEADER_SIZE, fp) != MAT_BIN_HEADER_SIZE) {
+    return 1;
+  }
+
+  // pad up to the start of the data
+  for (size_t i = MAT_BIN_HEADER_SIZE; i < h->data_offset; i++) {
+    if (fputc(0, fp) == EOF) {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * Reads and checks the header of a binary file, leaving the stream at the
+ * start of the data.
+ */
+static int read_header(FILE *fp, mat_header *h) {
+  unsigned char buf[MAT_BIN_HEADER_SIZE];
+  if (fread(buf, 1, MAT_BIN_HEADER_SIZE, fp) != MAT_BIN_HEADER_SIZE ||
+      memcmp(buf, MAT_BIN_MAGIC, 8) != 0) {
+    return 1;
+  }
+
+  // detect the byte order of the file
+  uint32_t endian;
+  memcpy(&endian, buf + 16, 4);
+  const int swap = (endian != MAT_BIN_ENDIAN);
+  if (swap) {
+    swap_bytes(&endian, 4, 1);
+    if (endian != MAT_BIN_ENDIAN) {
+      return 1;
+    }
+  }
+
+  uint32_t version, dtype, flags;
+  uint64_t rows, cols, stride, offset;
+  int32_t kl, ku;
+  get_field(&version, buf, 8, 4, swap);
+  get_field(&dtype, buf, 12, 4, swap);
+  get_field(&flags, buf, 20, 4, swap);
+  get_field(&rows, buf, 24, 8, swap);
+  get_field(&cols, buf, 32, 8, swap);
+  get_field(&stride, buf, 40, 8, swap);
+  get_field(&kl, buf, 48, 4, swap);
+  get_field(&ku, buf, 52, 4, swap);
+  get_field(&offset, buf, 56, 8, swap);
+  if (version != MAT_BIN_VERSION || dtype != MAT_BIN_F64 || stride < cols ||
+      rows > INT_MAX || stride > INT_MAX || offset < MAT_BIN_HEADER_SIZE ||
+      offset > LONG_MAX) {
+    return 1;
+  }
+
+  h->version = (int)version;
+  h->dtype = (int)dtype;
+  h->swap = swap;
+  h->rows = (int)rows;
+  h->cols = (int)cols;
+  h->stride = (int)stride;
+  h->kl = kl;
+  h->ku = ku;
+  h->cyclic = (int)(flags & 1u);
+  h->data_offset = (size_t)offset;
+
+  // skip any padding before the data
+  if (fseek(fp, (long)h->data_offset, SEEK_SET) != 0) {
+    return 1;
+  }
+
+  return 0;
+}
+
+/**
+ * Reads count entries from a binary file, correcting their byte order if
+ * necessary.
+ */
+static int read_data(FILE *fp, double *A, const size_t count, const int swap) {
+  if (fread(A, sizeof(double), count, fp) != count) {
+    return 1;
+  }
+  if (swap) {
+    swap_bytes(A, sizeof(double), count);
+  }
+  return 0;
+}
+
+void mat_header_init(mat_header *h, const int n, const int m) {
+  memset(h, 0, sizeof(mat_header));
+  h->version = MAT_BIN_VERSION;
+  h->dtype = MAT_BIN_F64;
+  h->rows = n;
+  h->cols = m;
+  h->stride = m;
+  h->kl = -1;
+  h->ku = -1;
+  h->data_offset = MAT_BIN_PAGE_SIZE;
+}
+
+int mat_output_bin_header(
+    const char *filename, const mat_header *h, const double *A
+) {
+  // a band is either unset (-1 for both) or has non-negative bandwidths
+  const int dense = (h->kl == -1 && h->ku == -1);
+  if (h->rows < 0 || h->cols < 0 || h->stride < h->cols ||
+      (!dense && (h->kl < 0 || h->ku < 0)) ||
+      h->data_offset < MAT_BIN_HEADER_SIZE) {
+    return 1;
+  }
+
+  FILE *fp = fopen(filename, "wb");
+  if (fp == NULL) {
+    return 1;
+  }
+
+  const size_t count = (size_t)h->rows * (size_t)h->stride;
+  int err = write_header(fp, h);
+  if (!err && fwrite(A, sizeof(double), count, fp) != count) {
+    err = 1;
+  }
+
+  if (fclose(fp) != 0) {
+    err = 1;
+  }
+
+  return err;
+}
+
+int mat_output_bin(
     const char *filename, const double *A, const int n, const int m
 ) {
-  return mat_outputf(filename, "%.8f", A, n, m);
+  mat_header h;
+  mat_header_init(&h, n, m);
+  return mat_output_bin_header(filename, &h, A);
 }
 
-int mat_input(const char *filename, double *A, const int n, const int m) {
-  FILE *fp = fopen(filename, "r");
+int mat_input_bin_header(const char *filename, mat_header *h) {
+  FILE *fp = fopen(filename, "rb");
   if (fp == NULL) {
     return 1;
   }
 
-  for (int i = 0; i < n; i++) {
-    for (int j = 0; j < m; j++) {
-      int ret = fscanf(fp, "%lf", &A[i * m + j]);
-      if (ret != 1) {
-        fclose(fp);
-        return 1;
-      }
+  const int err = read_header(fp, h);
+  fclose(fp);
+
+  return err;
+}
+
+int mat_input_bin_raw(const char *filename, double *A, const size_t size) {
+  FILE *fp = fopen(filename, "rb");
+  if (fp == NULL) {
+    return 1;
+  }
+
+  mat_header h;
+  int err = read_header(fp, &h);
+  if (!err) {
+    const size_t count = (size_t)h.rows * (size_t)h.stride;
+    err = (count > size) || read_data(fp, A, count, h.swap);
+  }
+
+  fclose(fp);
+
+  return err;
+}
+
+/**
+ * Finds the end of the first count tokens in text[0..len), and stores how many
+ * tokens there were (at most count) in ntok.
+ */
+static size_t skip_tokens(
+    const char *text, const size_t len, const size_t count, size_t *ntok
+) {
+  size_t k = 0;
+  size_t i = 0;
+  while (k < count) {
+    while (i < len && is_space(text[i])) {
+      i++;
+    }
+    if (i == len) {
+      break;
+    }
+    while (i < len && !is_space(text[i])) {
+      i++;
     }
+    k++;
   }
 
+  *ntok = k;
+  return i;
+}
+
+/**
+ * Reads the next count entries of a text file, refilling the buffer from the
+ * file as needed and carrying any token cut off at the end of the buffer over
+ * to the next block.
+ */
+static int stream_text(mat_stream *s, double *A, const size_t count) {
+  size_t done = 0;
+  while (done < count) {
+    // unless the file has ended, only the text up to the last whitespace is
+    // known to hold whole tokens
+    size_t cut = s->end;
+    if (!s->eof) {
+      while (cut > s->start && !is_space(s->buf[cut - 1])) {
+        cut--;
+      }
+    }
+
+    // each token takes at least two characters, so if fewer than half of the
+    // remaining entries can be in the text, parse all of it in one pass, and
+    // otherwise find where the last entry wanted ends first
+    const char *text = s->buf + s->start;
+    size_t len = cut - s->start;
+    size_t ntok, nread;
+    const size_t want = count - done;
+    const int scan = (want < len / 2);
+    if (scan) {
+      len = skip_tokens(text, len, want, &ntok);
+    }
+    if (mat_parse(text, len, A + done, want, &nread) != 0) {
+      return 1;
+    }
+    if (!scan && nread == want) {
+      len = skip_tokens(text, len, want, &ntok); // leave the rest for later
+    }
+    done += nread;
+    s->start += len;
+    if (done == count) {
+      break;
+    }
+    if (s->eof) {
+      return 1; // too few entries
+    }
+
+    const size_t keep = s->end - s->start;
+    if (keep == IO_CHUNK) {
+      return 1; // a single token fills the whole block
+    }
+    memmove(s->buf, s->buf + s->start, keep);
+    const size_t got = fread(s->buf + keep, 1, IO_CHUNK - keep, s->fp);
+    s->start = 0;
+    s->end = keep + got;
+    s->eof = (got < IO_CHUNK - keep);
+  }
+
+  return 0;
+}
+
+/**
+ * Reads the next rows of a binary file, skipping the padding at the end of
+ * each stored row.
+ */
+static int stream_bin(mat_stream *s, double *A, const int rows) {
+  const size_t m = (size_t)s->cols;
+  if (s->stride == s->cols) {
+    return read_data(s->fp, A, (size_t)rows * m, s->swap);
+  }
+
+  const long pad = (long)(s->stride - s->cols) * (long)sizeof(double);
+  for (int i = 0; i < rows; i++) {
+    if (read_data(s->fp, A + (size_t)i * m, m, s->swap) != 0 ||
+        fseek(s->fp, pad, SEEK_CUR) != 0) {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+int mat_stream_open(
+    mat_stream *s, const char *filename, const int n, const int m
+) {
+  memset(s, 0, sizeof(mat_stream));
+  if (n < 0 || m < 0) {
+    return 1;
+  }
+
+  s->fp = fopen(filename, "r");
+  s->buf = malloc(IO_CHUNK);
+  if (s->fp == NULL || s->buf == NULL) {
+    mat_stream_close(s);
+    return 1;
+  }
+  s->rows = n;
+  s->cols = m;
+  s->stride = m;
+
+  return 0;
+}
+
+int mat_stream_open_bin(mat_stream *s, const char *filename) {
+  memset(s, 0, sizeof(mat_stream));
+  s->fp = fopen(filename, "rb");
+  if (s->fp == NULL) {
+    return 1;
+  }
+
+  mat_header h;
+  if (read_header(s->fp, &h) != 0) {
+    mat_stream_close(s);
+    return 1;
+  }
+  s->binary = 1;
+  s->swap = h.swap;
+  s->rows = h.rows;
+  s->cols = h.cols;
+  s->stride = h.stride;
+
+  return 0;
+}
+
+int mat_stream_read(mat_stream *s, double *A, const int k, int *nrows) {
+  *nrows = 0;
+  if (s->fp == NULL || k < 0) {
+    return 1;
+  }
+
+  const int rows = (k < s->rows - s->row) ? k : s->rows - s->row;
+  const int err = s->binary
+                      ? stream_bin(s, A, rows)
+                      : stream_text(s, A, (size_t)rows * (size_t)s->cols);
+  if (err) {
+    return 1;
+  }
+
+  s->row += rows;
+  *nrows = rows;
+  return 0;
+}
+
+void mat_stream_close(mat_stream *s) {
+  if (s->fp != NULL) {
+    fclose(s->fp);
+  }
+  free(s->buf);
+  memset(s, 0, sizeof(mat_stream));
+}
+
+int mat_input(const char *filename, double *A, const int n, const int m) {
+  mat_stream s;
+  if (mat_stream_open(&s, filename, n, m) != 0) {
+    return 1;
+  }
+
+  int nrows;
+  const int err = mat_stream_read(&s, A, n, &nrows);
+  mat_stream_close(&s);
+
+  return err;
+}
+
+int mat_input_bin(const char *filename, double *A, const int n, const int m) {
+  mat_stream s;
+  if (mat_stream_open_bin(&s, filename) != 0) {
+    return 1;
+  }
+
+  int nrows;
+  int err = (s.rows != n || s.cols != m);
+  if (!err) {
+    err = mat_stream_read(&s, A, n, &nrows);
+  }
+  mat_stream_close(&s);
+
+  return err;
+}
+
+/**
+ * Copies the data of the file described by map->h into memory, correcting its
+ * byte order if necessary.
+ */
+static int copy_file(const char *filename, mat_map *map) {
+  const size_t size = (size_t)map->h.rows * (size_t)map->h.stride;
+  double *mem = malloc((size > 0 ? size : 1) * sizeof(double));
+  FILE *fp = fopen(filename, "rb");
+  if (!mem || !fp || map->h.data_offset > LONG_MAX ||
+      fseek(fp, (long)map->h.data_offset, SEEK_SET) != 0 ||
+      read_data(fp, mem, size, map->h.swap) != 0) {
+    free(mem);
+    if (fp) {
+      fclose(fp);
+    }
+    return 1;
+  }
+  fclose(fp);
+
+  map->mem = mem;
+  map->len = size * sizeof(double);
+  map->data = mem;
+  map->copied = 1;
+
+  return 0;
+}
+
+/**
+ * Maps the file described by map->h into memory, or copies its data if it
+ * cannot be mapped.
+ */
+static int map_file(const char *filename, mat_map *map) {
+#ifdef IO_MMAP
+  if (map->h.swap || map->h.data_offset % sizeof(double) != 0) {
+    return copy_file(filename, map); // needs converting, or misaligned
+  }
+
+  const size_t size = (size_t)map->h.rows * (size_t)map->h.stride;
+  const size_t len = map->h.data_offset + size * sizeof(double);
+  const int fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    return 1;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < len) {
+    close(fd);
+    return 1;
+  }
+
+  void *mem = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd); // the mapping keeps the file open
+  if (mem == MAP_FAILED) {
+    return 1;
+  }
+
+#ifdef MADV_WILLNEED
+  // start reading ahead from the first page of data
+  const size_t start =
+      map->h.data_offset / MAT_BIN_PAGE_SIZE * MAT_BIN_PAGE_SIZE;
+  madvise((unsigned char *)mem + start, len - start, MADV_WILLNEED);
+#endif
+
+  map->mem = mem;
+  map->len = len;
+  map->data = (const void *)((unsigned char *)mem + map->h.data_offset);
+
+  return 0;
+#else
+  return copy_file(filename, map);
+#endif
+}
+
+int mat_map_bin(const char *filename, mat_map *map) {
+  memset(map, 0, sizeof(mat_map));
+  if (mat_input_bin_header(filename, &map->h) != 0 ||
+      map_file(filename, map) != 0) {
+    memset(map, 0, sizeof(mat_map));
+    return 1;
+  }
+  return 0;
+}
+
+void mat_unmap_bin(mat_map *map) {
+  if (map->copied) {
+    free(map->mem);
+  } else if (map->mem) {
+#ifdef IO_MMAP
+    munmap(map->mem, map->len);
+#endif
+  }
+  memset(map, 0, sizeof(mat_map));
+}
+
+/**
+ * Whether this machine stores numbers least significant byte first.
+ */
+static int is_little_endian(void) {
+  const uint16_t one = 1;
+  unsigned char first;
+  memcpy(&first, &one, 1);
+  return first == 1;
+}
+
+/**
+ * Little-endian fields of .npy and zip headers, independent of the byte order
+ * of the machine.
+ */
+static void put_le(unsigned char *p, uint64_t x, const size_t size) {
+  for (size_t i = 0; i < size; i++, x >>= 8) {
+    p[i] = (unsigned char)(x & 0xff);
+  }
+}
+
+static uint64_t get_le(const unsigned char *p, const size_t size) {
+  uint64_t x = 0;
+  for (size_t i = size; i > 0; i--) {
+    x = (x << 8) | p[i - 1];
+  }
+  return x;
+}
+
+/**
+ * Writes the header of an .npy file holding an n x m matrix (or a vector of
+ * length n if m < 0) to buf, returning its length. The header is padded with
+ * spaces to a multiple of NPY_ALIGN bytes.
+ */
+static size_t npy_header(char *buf, const int n, const int m) {
+  char shape[32];
+  if (m < 0) {
+    snprintf(shape, sizeof(shape), "(%d,)", n);
+  } else {
+    snprintf(shape, sizeof(shape), "(%d, %d)", n, m);
+  }
+  const int len = snprintf(
+      buf + NPY_PREFIX, NPY_MAX_HEADER - NPY_PREFIX,
+      "{'descr': '%cf8', 'fortran_order': False, 'shape': %s, }",
+      is_little_endian() ? '<' : '>', shape
+  );
+
+  // pad with spaces, and end with a newline
+  size_t total = NPY_PREFIX + (size_t)len + 1;
+  total = (total + NPY_ALIGN - 1) / NPY_ALIGN * NPY_ALIGN;
+  memset(buf + NPY_PREFIX + len, ' ', total - NPY_PREFIX - (size_t)len);
+  buf[total - 1] = '\n';
+
+  memcpy(buf, NPY_MAGIC, 6);
+  buf[6] = 1; // version 1.0
+  buf[7] = 0;
+  unsigned char hlen[2];
+  put_le(hlen, total - NPY_PREFIX, 2);
+  memcpy(buf + 8, hlen, 2);
+
+  return total;
+}
+
+/**
+ * Finds the value of a key in the dictionary of an .npy header, returning a
+ * pointer to its first character, or NULL if the key is missing.
+ */
+static const char *npy_value(const char *dict, const char *key) {
+  const size_t klen = strlen(key);
+  for (const char *p = dict; *p; p++) {
+    if ((*p == '\'' || *p == '"') && strncmp(p + 1, key, klen) == 0 &&
+        p[klen + 1] == *p) {
+      p += klen + 2;
+      while (*p == ' ' || *p == ':') {
+        p++;
+      }
+      return p;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Parses the dictionary of an .npy header, which must be null-terminated.
+ */
+static int npy_parse_dict(const char *dict, mat_header *h) {
+  // float64, in either byte order
+  const char *descr = npy_value(dict, "descr");
+  if (!descr || (descr[0] != '\'' && descr[0] != '"') ||
+      (descr[1] != '<' && descr[1] != '>') || strncmp(descr + 2, "f8", 2) ||
+      descr[4] != descr[0]) {
+    return 1;
+  }
+  h->swap = ((descr[1] == '<') != is_little_endian());
+
+  // the shape, as a tuple of integers
+  const char *shape = npy_value(dict, "shape");
+  if (!shape || *shape != '(') {
+    return 1;
+  }
+  uint64_t dims[2] = {1, 1}; // rows, then the product of the other dims
+  int ndim = 0;
+  const char *p = shape + 1;
+  for (;;) {
+    while (*p == ' ' || *p == ',') {
+      p++;
+    }
+    if (*p == ')') {
+      break;
+    }
+    char *end;
+    const unsigned long long d = strtoull(p, &end, 10);
+    if (end == p || d > INT_MAX) {
+      return 1;
+    }
+    dims[ndim > 0] *= d;
+    if (dims[ndim > 0] > INT_MAX) {
+      return 1;
+    }
+    ndim++;
+    p = end;
+  }
+
+  // C order is needed unless the layout is the same either way
+  const char *order = npy_value(dict, "fortran_order");
+  if (!order || (strncmp(order, "False", 5) != 0 &&
+                 (strncmp(order, "True", 4) != 0 || ndim > 1))) {
+    return 1;
+  }
+
+  h->dtype = MAT_BIN_F64;
+  h->rows = (int)dims[0];
+  h->cols = (int)dims[1];
+  h->stride = h->cols;
+  h->kl = -1;
+  h->ku = -1;
+  h->cyclic = 0;
+  return 0;
+}
+
+/**
+ * Reads the header of an .npy file (which may be inside an archive) starting at
+ * the current position of the stream, which is left at the start of the data.
+ */
+static int npy_read_header(FILE *fp, mat_header *h) {
+  memset(h, 0, sizeof(mat_header));
+  const long start = ftell(fp);
+  unsigned char pre[12];
+  if (start < 0 || fread(pre, 1, 8, fp) != 8 || memcmp(pre, NPY_MAGIC, 6)) {
+    return 1;
+  }
+
+  // version 1 has a 2-byte header length, and versions 2 and 3 a 4-byte one
+  h->version = pre[6];
+  const size_t nlen = (pre[6] == 1) ? 2 : 4;
+  if (pre[6] < 1 || pre[6] > 3 || fread(pre + 8, 1, nlen, fp) != nlen) {
+    return 1;
+  }
+  const size_t len = (size_t)get_le(pre + 8, nlen);
+
+  char small[NPY_MAX_HEADER + 1];
+  char *dict = (len <= NPY_MAX_HEADER) ? small : malloc(len + 1);
+  if (!dict) {
+    return 1;
+  }
+  int err = (fread(dict, 1, len, fp) != len);
+  if (!err) {
+    dict[len] = '\0';
+    err = npy_parse_dict(dict, h);
+  }
+  if (dict != small) {
+    free(dict);
+  }
+
+  h->data_offset = (size_t)start + 8 + nlen + len;
+  return err;
+}
+
+int mat_output_npy(
+    const char *filename, const double *A, const int n, const int m
+) {
+  FILE *fp = fopen(filename, "wb");
+  if (fp == NULL) {
+    return 1;
+  }
+
+  char header[NPY_MAX_HEADER];
+  const size_t hlen = npy_header(header, n, m);
+  const size_t count = (size_t)n * (size_t)(m < 0 ? 1 : m);
+  int err = (fwrite(header, 1, hlen, fp) != hlen ||
+             fwrite(A, sizeof(double), count, fp) != count);
+
+  if (fclose(fp) != 0) {
+    err = 1;
+  }
+
+  return err;
+}
+
+int mat_output_npy_vector(const char *filename, const double *x, const int n) {
+  return mat_output_npy(filename, x, n, -1);
+}
+
+int mat_input_npy_header(const char *filename, mat_header *h) {
+  FILE *fp = fopen(filename, "rb");
+  if (fp == NULL) {
+    return 1;
+  }
+
+  const int err = npy_read_header(fp, h);
+  fclose(fp);
+
+  return err;
+}
+
+int mat_input_npy(const char *filename, double *A, const int n, const int m) {
+  FILE *fp = fopen(filename, "rb");
+  if (fp == NULL) {
+    return 1;
+  }
+
+  mat_header h;
+  int err = npy_read_header(fp, &h);
+  if (!err && (h.rows != n || h.cols != m)) {
+    err = 1;
+  }
+  if (!err) {
+    err = read_data(fp, A, (size_t)n * (size_t)m, h.swap);
+  }
+
+  fclose(fp);
+
+  return err;
+}
+
+int mat_map_npy(const char *filename, mat_map *map) {
+  memset(map, 0, sizeof(mat_map));
+  if (mat_input_npy_header(filename, &map->h) != 0 ||
+      map_file(filename, map) != 0) {
+    memset(map, 0, sizeof(mat_map));
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * Updates a CRC-32 (as used by zip) with the bytes data[0..len).
+ */
+static uint32_t crc32_update(
+    const uint32_t *table, uint32_t crc, const void *data, const size_t len
+) {
+  const unsigned char *p = data;
+  crc = ~crc;
+  for (size_t i = 0; i < len; i++) {
+    crc = table[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+/**
+ * Where each array of an archive was written, for the central directory.
+ */
+typedef struct {
+  uint64_t offset; // offset of the local header
+  uint64_t size; // size of the .npy file
+  uint32_t crc; // CRC-32 of the .npy file
+} npz_record;
+
+/**
+ * Writes the zip64 extra field holding the given values, returning its length.
+ */
+static size_t zip64_extra(
+    unsigned char *p, const uint64_t *values, const int count
+) {
+  put_le(p, 0x0001, 2);
+  put_le(p + 2, (uint64_t)(8 * count), 2);
+  for (int i = 0; i < count; i++) {
+    put_le(p + 4 + 8 * i, values[i], 8);
+  }
+  return 4 + 8 * (size_t)count;
+}
+
+/**
+ * Writes the local header of an archive entry, with an extra field padding the
+ * header so that the .npy file starts on a multiple of NPY_ALIGN bytes.
+ */
+static int zip_local_header(
+    FILE *fp, const char *name, const size_t nlen, const npz_record *r
+) {
+  unsigned char buf[ZIP_LOCAL + ZIP_MAX_NAME + ZIP_MAX_EXTRA];
+  const int big = (r->size >= ZIP_LIMIT);
+
+  put_le(buf, 0x04034b50, 4); // signature
+  put_le(buf + 4, big ? 45 : 20, 2); // version needed
+  put_le(buf + 6, 0, 2); // flags
+  put_le(buf + 8, 0, 2); // stored, i.e. no compression
+  put_le(buf + 10, 0, 2); // time
+  put_le(buf + 12, ZIP_DATE, 2); // date
+  put_le(buf + 14, r->crc, 4);
+  put_le(buf + 18, big ? ZIP_LIMIT : r->size, 4); // compressed size
+  put_le(buf + 22, big ? ZIP_LIMIT : r->size, 4); // uncompressed size
+  put_le(buf + 26, nlen, 2);
+  memcpy(buf + ZIP_LOCAL, name, nlen);
+
+  size_t len = ZIP_LOCAL + nlen;
+  if (big) {
+    const uint64_t sizes[2] = {r->size, r->size};
+    len += zip64_extra(buf + len, sizes, 2);
+  }
+
+  // alignment extra field: a 2-byte alignment, then zeros
+  const uint64_t end = r->offset + len + 6; // end of the field before padding
+  const size_t pad = (size_t)((NPY_ALIGN - end % NPY_ALIGN) % NPY_ALIGN);
+  put_le(buf + len, ZIP_ALIGN_ID, 2);
+  put_le(buf + len + 2, 2 + pad, 2);
+  put_le(buf + len + 4, NPY_ALIGN, 2);
+  memset(buf + len + 6, 0, pad);
+  len += 6 + pad;
+  put_le(buf + 28, len - ZIP_LOCAL - nlen, 2); // extra field length
+
+  return fwrite(buf, 1, len, fp) != len;
+}
+
+/**
+ * Writes the central directory entry of an archive entry, returning its length
+ * (or 0 on failure).
+ */
+static size_t zip_central_header(
+    FILE *fp, const char *name, const size_t nlen, const npz_record *r
+) {
+  unsigned char buf[ZIP_CENTRAL + ZIP_MAX_NAME + ZIP_MAX_EXTRA];
+  uint64_t big[3];
+  int nbig = 0;
+  if (r->size >= ZIP_LIMIT) {
+    big[nbig++] = r->size; // uncompressed
+    big[nbig++] = r->size; // compressed
+  }
+  if (r->offset >= ZIP_LIMIT) {
+    big[nbig++] = r->offset;
+  }
+
+  put_le(buf, 0x02014b50, 4); // signature
+  put_le(buf + 4, 45, 2); // version made by
+  put_le(buf + 6, nbig ? 45 : 20, 2); // version needed
+  put_le(buf + 8, 0, 2); // flags
+  put_le(buf + 10, 0, 2); // stored
+  put_le(buf + 12, 0, 2); // time
+  put_le(buf + 14, ZIP_DATE, 2); // date
+  put_le(buf + 16, r->crc, 4);
+  put_le(buf + 20, (r->size >= ZIP_LIMIT) ? ZIP_LIMIT : r->size, 4);
+  put_le(buf + 24, (r->size >= ZIP_LIMIT) ? ZIP_LIMIT : r->size, 4);
+  put_le(buf + 28, nlen, 2);
+  put_le(buf + 30, nbig ? 4 + 8 * (uint64_t)nbig : 0, 2); // extra length
+  put_le(buf + 32, 0, 2); // comment length
+  put_le(buf + 34, 0, 2); // disk number
+  put_le(buf + 36, 0, 2); // internal attributes
+  put_le(buf + 38, 0, 4); // external attributes
+  put_le(buf + 42, (r->offset >= ZIP_LIMIT) ? ZIP_LIMIT : r->offset, 4);
+  memcpy(buf + ZIP_CENTRAL, name, nlen);
+
+  size_t len = ZIP_CENTRAL + nlen;
+  if (nbig) {
+    len += zip64_extra(buf + len, big, nbig);
+  }
+
+  return (fwrite(buf, 1, len, fp) == len) ? len : 0;
+}
+
+/**
+ * Writes the end of the central directory, using the zip64 records if any
+ * field is too large for the original ones.
+ */
+static int zip_end(
+    FILE *fp, const uint64_t entries, const uint64_t cd_offset,
+    const uint64_t cd_size
+) {
+  unsigned char buf[56 + 20 + 22];
+  size_t len = 0;
+  const int big =
+      (entries >= 0xffff || cd_offset >= ZIP_LIMIT || cd_size >= ZIP_LIMIT);
+
+  if (big) {
+    // zip64 end of central directory record, then its locator
+    put_le(buf, 0x06064b50, 4);
+    put_le(buf + 4, 44, 8); // size of the rest of the record
+    put_le(buf + 12, 45, 2); // version made by
+    put_le(buf + 14, 45, 2); // version needed
+    put_le(buf + 16, 0, 4); // disk number
+    put_le(buf + 20, 0, 4); // disk with the central directory
+    put_le(buf + 24, entries, 8); // entries on this disk
+    put_le(buf + 32, entries, 8); // total entries
+    put_le(buf + 40, cd_size, 8);
+    put_le(buf + 48, cd_offset, 8);
+    put_le(buf + 56, 0x07064b50, 4);
+    put_le(buf + 60, 0, 4); // disk with the zip64 record
+    put_le(buf + 64, cd_offset + cd_size, 8); // offset of the zip64 record
+    put_le(buf + 72, 1, 4); // total disks
+    len = 76;
+  }
+
+  unsigned char *p = buf + len;
+  put_le(p, 0x06054b50, 4);
+  put_le(p + 4, 0, 2); // disk number
+  put_le(p + 6, 0, 2); // disk with the central directory
+  put_le(p + 8, big ? 0xffff : entries, 2);
+  put_le(p + 10, big ? 0xffff : entries, 2);
+  put_le(p + 12, big ? ZIP_LIMIT : cd_size, 4);
+  put_le(p + 16, big ? ZIP_LIMIT : cd_offset, 4);
+  put_le(p + 20, 0, 2); // comment length
+  len += 22;
+
+  return fwrite(buf, 1, len, fp) != len;
+}
+
+int mat_output_npz(
+    const char *filename, const mat_npz_entry *entries, const int count
+) {
+  for (int k = 0; k < count; k++) {
+    if (strlen(entries[k].name) + 4 > ZIP_MAX_NAME) {
+      return 1;
+    }
+  }
+  npz_record *records = malloc((count > 0 ? (size_t)count : 1) *
+                               sizeof(npz_record));
+  FILE *fp = fopen(filename, "wb");
+  if (!records || !fp) {
+    free(records);
+    if (fp) {
+      fclose(fp);
+    }
+    return 1;
+  }
+
+  uint32_t table[256];
+  for (uint32_t i = 0; i < 256; i++) {
+    uint32_t c = i;
+    for (int b = 0; b < 8; b++) {
+      c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+    }
+    table[i] = c;
+  }
+
+  // each entry: local header, .npy header, then the data
+  char name[ZIP_MAX_NAME + 1];
+  uint64_t offset = 0;
+  int err = 0;
+  for (int k = 0; k < count && !err; k++) {
+    const mat_npz_entry *e = &entries[k];
+    const int m = (e->cols > 0) ? e->cols : -1;
+    const size_t bytes =
+        (size_t)e->rows * (size_t)(m < 0 ? 1 : m) * sizeof(double);
+    char header[NPY_MAX_HEADER];
+    const size_t hlen = npy_header(header, e->rows, m);
+    const size_t nlen = (size_t)snprintf(name, sizeof(name), "%s.npy", e->name);
+
+    npz_record *r = &records[k];
+    r->offset = offset;
+    r->size = hlen + bytes;
+    r->crc = crc32_update(table, 0, header, hlen);
+    r->crc = crc32_update(table, r->crc, e->data, bytes);
+
+    const long start = ftell(fp);
+    err = (zip_local_header(fp, name, nlen, r) ||
+           fwrite(header, 1, hlen, fp) != hlen ||
+           fwrite(e->data, 1, bytes, fp) != bytes);
+    const long end = ftell(fp);
+    if (start < 0 || end < 0) {
+      err = 1;
+    }
+    offset += (uint64_t)(end - start);
+  }
+
+  // then the central directory
+  uint64_t cd_size = 0;
+  for (int k = 0; k < count && !err; k++) {
+    const size_t nlen =
+        (size_t)snprintf(name, sizeof(name), "%s.npy", entries[k].name);
+    const size_t len = zip_central_header(fp, name, nlen, &records[k]);
+    err = (len == 0);
+    cd_size += len;
+  }
+  if (!err) {
+    err = zip_end(fp, (uint64_t)count, offset, cd_size);
+  }
+
+  if (fclose(fp) != 0) {
+    err = 1;
+  }
+  free(records);
+
+  return err;
+}
+
+/**
+ * Finds an array in an .npz archive, leaving the stream at the start of its
+ * .npy file.
+ */
+static int npz_find(FILE *fp, const char *name, uint64_t *size) {
+  // the end of central directory record is in the last 64 kB of the file
+  if (fseek(fp, 0, SEEK_END) != 0) {
+    return 1;
+  }
+  const long file_size = ftell(fp);
+  if (file_size < 22) {
+    return 1;
+  }
+  const long tail = (file_size < 22 + 0xffff) ? file_size : 22 + 0xffff;
+  unsigned char *buf = malloc((size_t)tail);
+  if (!buf || fseek(fp, file_size - tail, SEEK_SET) != 0 ||
+      fread(buf, 1, (size_t)tail, fp) != (size_t)tail) {
+    free(buf);
+    return 1;
+  }
+  long eocd = tail - 22;
+  while (eocd >= 0 && get_le(buf + eocd, 4) != 0x06054b50) {
+    eocd--;
+  }
+  if (eocd < 0) {
+    free(buf);
+    return 1;
+  }
+
+  uint64_t entries = get_le(buf + eocd + 10, 2);
+  uint64_t cd_size = get_le(buf + eocd + 12, 4);
+  uint64_t cd_offset = get_le(buf + eocd + 16, 4);
+  if (entries == 0xffff || cd_size == ZIP_LIMIT || cd_offset == ZIP_LIMIT) {
+    // the real values are in the zip64 record, found through its locator
+    unsigned char z[56];
+    const long loc = file_size - tail + eocd - 20;
+    int err = (eocd < 20 || get_le(buf + eocd - 20, 4) != 0x07064b50);
+    const uint64_t z_offset = err ? 0 : get_le(buf + eocd - 12, 8);
+    err = err || z_offset > (uint64_t)loc ||
+          fseek(fp, (long)z_offset, SEEK_SET) != 0 ||
+          fread(z, 1, 56, fp) != 56 || get_le(z, 4) != 0x06064b50;
+    if (err) {
+      free(buf);
+      return 1;
+    }
+    entries = get_le(z + 32, 8);
+    cd_size = get_le(z + 40, 8);
+    cd_offset = get_le(z + 48, 8);
+  }
+  free(buf);
+
+  if (cd_offset + cd_size > (uint64_t)file_size) {
+    return 1;
+  }
+  unsigned char *cd = malloc(cd_size > 0 ? (size_t)cd_size : 1);
+  if (!cd || fseek(fp, (long)cd_offset, SEEK_SET) != 0 ||
+      fread(cd, 1, (size_t)cd_size, fp) != cd_size) {
+    free(cd);
+    return 1;
+  }
+
+  // look for the array, with or without its extension
+  const size_t len = strlen(name);
+  const int has_ext = (len >= 4 && strcmp(name + len - 4, ".npy") == 0);
+  const size_t full = has_ext ? len : len + 4;
+  int found = 0;
+  uint64_t method = 0, csize = 0, usize = 0, offset = 0;
+  size_t p = 0;
+  for (uint64_t k = 0; k < entries && !found; k++) {
+    if (p + ZIP_CENTRAL > cd_size || get_le(cd + p, 4) != 0x02014b50) {
+      break;
+    }
+    const size_t nlen = (size_t)get_le(cd + p + 28, 2);
+    const size_t xlen = (size_t)get_le(cd + p + 30, 2);
+    const size_t clen = (size_t)get_le(cd + p + 32, 2);
+    const unsigned char *ename = cd + p + ZIP_CENTRAL;
+    if (p + ZIP_CENTRAL + nlen + xlen > cd_size) {
+      break;
+    }
+    if (nlen == full && memcmp(ename, name, len) == 0 &&
+        (has_ext || memcmp(ename + len, ".npy", 4) == 0)) {
+      found = 1;
+      method = get_le(cd + p + 10, 2);
+      csize = get_le(cd + p + 20, 4);
+      usize = get_le(cd + p + 24, 4);
+      offset = get_le(cd + p + 42, 4);
+
+      // replace any overflowed fields with those of the zip64 extra field
+      const unsigned char *x = ename + nlen;
+      for (size_t q = 0; q + 4 <= xlen;) {
+        const uint64_t id = get_le(x + q, 2);
+        const size_t flen = (size_t)get_le(x + q + 2, 2);
+        if (id == 0x0001) {
+          size_t f = q + 4;
+          uint64_t *fields[3] = {&usize, &csize, &offset};
+          for (int i = 0; i < 3; i++) {
+            if (*fields[i] == ZIP_LIMIT && f + 8 <= q + 4 + flen) {
+              *fields[i] = get_le(x + f, 8);
+              f += 8;
+            }
+          }
+        }
+        q += 4 + flen;
+      }
+    }
+    p += ZIP_CENTRAL + nlen + xlen + clen;
+  }
+  free(cd);
+  if (!found || method != 0 || csize != usize) {
+    return 1; // missing or compressed
+  }
+
+  // skip the local header
+  unsigned char local[ZIP_LOCAL];
+  if (offset + ZIP_LOCAL > (uint64_t)file_size ||
+      fseek(fp, (long)offset, SEEK_SET) != 0 ||
+      fread(local, 1, ZIP_LOCAL, fp) != ZIP_LOCAL ||
+      get_le(local, 4) != 0x04034b50) {
+    return 1;
+  }
+  const long skip = (long)(get_le(local + 26, 2) + get_le(local + 28, 2));
+  if (fseek(fp, skip, SEEK_CUR) != 0) {
+    return 1;
+  }
+
+  *size = usize;
+  return 0;
+}
+
+/**
+ * Finds an array in an .npz archive and reads its header, leaving the stream
+ * at the start of its data.
+ */
+static int npz_read_header(FILE *fp, const char *name, mat_header *h) {
+  uint64_t size;
+  if (npz_find(fp, name, &size) != 0) {
+    return 1;
+  }
+  const long start = ftell(fp);
+  if (start < 0 || npy_read_header(fp, h) != 0) {
+    return 1;
+  }
+
+  // the data must fit inside the entry
+  const uint64_t bytes =
+      (uint64_t)h->rows * (uint64_t)h->cols * sizeof(double);
+  return (h->data_offset - (size_t)start + bytes > size) ? 1 : 0;
+}
+
+int mat_input_npz_header(
+    const char *filename, const char *name, mat_header *h
+) {
+  FILE *fp = fopen(filename, "rb");
+  if (fp == NULL) {
+    return 1;
+  }
+
+  const int err = npz_read_header(fp, name, h);
+  fclose(fp);
+
+  return err;
+}
+
+int mat_input_npz(
+    const char *filename, const char *name, double *A, const int n,
+    const int m
+) {
+  FILE *fp = fopen(filename, "rb");
+  if (fp == NULL) {
+    return 1;
+  }
+
+  mat_header h;
+  int err = npz_read_header(fp, name, &h);
+  if (!err && (h.rows != n || h.cols != m)) {
+    err = 1;
+  }
+  if (!err) {
+    err = read_data(fp, A, (size_t)n * (size_t)m, h.swap);
+  }
+
+  fclose(fp);
+
+  return err;
+}
+
+int mat_map_npz(const char *filename, const char *name, mat_map *map) {
+  memset(map, 0, sizeof(mat_map));
+  if (mat_input_npz_header(filename, name, &map->h) != 0 ||
+      map_file(filename, map) != 0) {
+    memset(map, 0, sizeof(mat_map));
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * Checks the size of a banded matrix.
+ */
+static int band_invalid(const int kl, const int ku, const int n) {
+  return n < 1 || kl < 0 || ku < 0 || kl >= n || ku >= n;
+}
+
+/**
+ * Finds the rows [lo, hi) in which diagonal k (of kl + ku + 1, lowest first)
+ * lies inside an n x n matrix, which is every row if the matrix is cyclic.
+ */
+static void band_range(
+    const int k, const int kl, const int cyclic, const int n, int *lo, int *hi
+) {
+  const int offset = k - kl;
+  *lo = (!cyclic && offset < 0) ? -offset : 0;
+  *hi = (!cyclic && offset > 0) ? n - offset : n;
+}
+
+/**
+ * Number of rows of a banded matrix held in a block of the text reader or
+ * writer.
+ */
+static int band_block_rows(const int w, const int n) {
+  const size_t rows = IO_CHUNK / ((size_t)w * sizeof(double));
+  if (rows < 1) {
+    return 1;
+  }
+  return (rows < (size_t)n) ? (int)rows : n;
+}
+
+/**
+ * Reads and checks the header line of a banded text file, leaving the stream
+ * at the start of the entries.
+ */
+static int band_read_header(FILE *fp, mat_header *h) {
+  char line[BAND_MAX_HEADER + 1];
+  const size_t magic = strlen(BAND_MAGIC);
+  int n, kl, ku, cyclic;
+  if (!fgets(line, sizeof(line), fp) || !strchr(line, '\n') ||
+      strncmp(line, BAND_MAGIC, magic) != 0 || !is_space(line[magic]) ||
+      sscanf(line + magic, "%d %d %d %d", &n, &kl, &ku, &cyclic) != 4 ||
+      band_invalid(kl, ku, n) || (cyclic != 0 && cyclic != 1)) {
+    return 1;
+  }
+  const long offset = ftell(fp);
+  if (offset < 0) {
+    return 1;
+  }
+
+  mat_header_init(h, kl + ku + 1, n);
+  h->kl = kl;
+  h->ku = ku;
+  h->cyclic = cyclic;
+  h->data_offset = (size_t)offset;
   return 0;
 }
+
+/**
+ * Writes count zeros to a binary file.
+ */
+static int write_zeros(FILE *fp, const int count) {
+  const double zero = 0.0;
+  for (int i = 0; i < count; i++) {
+    if (fwrite(&zero, sizeof(double), 1, fp) != 1) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int mat_output_band(
+    const char *filename, const double *const *diag, const int kl,
+    const int ku, const int cyclic, const int n
+) {
+  if (band_invalid(kl, ku, n)) {
+    return 1;
+  }
+  FILE *fp = fopen(filename, "w");
+  if (fp == NULL) {
+    return 1;
+  }
+
+  // gather the diagonals into blocks of rows of the matrix, which are written
+  // as for mat_output
+  const int w = kl + ku + 1;
+  const int rows = band_block_rows(w, n);
+  double *block = malloc((size_t)rows * (size_t)w * sizeof(double));
+  int err = !block || fprintf(
+                          fp, BAND_MAGIC " %d %d %d %d\n", n, kl, ku,
+                          cyclic ? 1 : 0
+                      ) < 0;
+  for (int i0 = 0; i0 < n && !err; i0 += rows) {
+    const int nb = (n - i0 < rows) ? n - i0 : rows;
+    for (int k = 0; k < w; k++) {
+      int lo, hi;
+      band_range(k, kl, cyclic, n, &lo, &hi);
+      for (int i = 0; i < nb; i++) {
+        const int r = i0 + i;
+        block[(size_t)i * w + k] = (r >= lo && r < hi) ? diag[k][r] : 0.0;
+      }
+    }
+    err = write_text(fp, NULL, block, (size_t)w, 1, nb, w);
+  }
+
+  free(block);
+  if (fclose(fp) != 0) {
+    err = 1;
+  }
+
+  return err;
+}
+
+int mat_output_band_bin(
+    const char *filename, const double *const *diag, const int kl,
+    const int ku, const int cyclic, const int n
+) {
+  if (band_invalid(kl, ku, n)) {
+    return 1;
+  }
+  FILE *fp = fopen(filename, "wb");
+  if (fp == NULL) {
+    return 1;
+  }
+
+  const int w = kl + ku + 1;
+  mat_header h;
+  mat_header_init(&h, w, n);
+  h.kl = kl;
+  h.ku = ku;
+  h.cyclic = cyclic ? 1 : 0;
+  int err = write_header(fp, &h);
+
+  // each diagonal is written in a single block
+  for (int k = 0; k < w && !err; k++) {
+    int lo, hi;
+    band_range(k, kl, cyclic, n, &lo, &hi);
+    const size_t count = (size_t)(hi - lo);
+    err = write_zeros(fp, lo) ||
+          fwrite(diag[k] + lo, sizeof(double), count, fp) != count ||
+          write_zeros(fp, n - hi);
+  }
+
+  if (fclose(fp) != 0) {
+    err = 1;
+  }
+
+  return err;
+}
+
+int mat_input_band_header(const char *filename, mat_header *h) {
+  FILE *fp = fopen(filename, "r");
+  if (fp == NULL) {
+    return 1;
+  }
+
+  const int err = band_read_header(fp, h);
+  fclose(fp);
+
+  return err;
+}
+
+int mat_input_band(
+    const char *filename, double *const *diag, const int kl, const int ku,
+    int *cyclic, const int n
+) {
+  if (band_invalid(kl, ku, n)) {
+    return 1;
+  }
+  const int w = kl + ku + 1;
+  mat_stream s;
+  if (mat_stream_open(&s, filename, n, w) != 0) {
+    return 1;
+  }
+
+  // the stream has not read anything yet, so the header can be read first
+  mat_header h;
+  int err = band_read_header(s.fp, &h) || h.kl != kl || h.ku != ku ||
+            h.cols != n;
+
+  // read blocks of rows of the matrix and scatter them into the diagonals
+  const int rows = band_block_rows(w, n);
+  double *block = malloc((size_t)rows * (size_t)w * sizeof(double));
+  err = err || !block;
+  for (int i0 = 0; i0 < n && !err; i0 += rows) {
+    int nb;
+    err = mat_stream_read(&s, block, rows, &nb);
+    for (int k = 0; k < w && !err; k++) {
+      for (int i = 0; i < nb; i++) {
+        diag[k][i0 + i] = block[(size_t)i * w + k];
+      }
+    }
+  }
+
+  free(block);
+  mat_stream_close(&s);
+  if (!err && cyclic) {
+    *cyclic = h.cyclic;
+  }
+
+  return err;
+}
+
+int mat_input_band_bin(
+    const char *filename, double *const *diag, const int kl, const int ku,
+    int *cyclic, const int n
+) {
+  mat_header h;
+  if (mat_input_bin_header(filename, &h) != 0 || h.kl != kl || h.ku != ku ||
+      h.rows != kl + ku + 1 || h.cols != n) {
+    return 1;
+  }
+
+  mat_stream s;
+  if (mat_stream_open_bin(&s, filename) != 0) {
+    return 1;
+  }
+
+  // each diagonal is a single stored row
+  int err = 0;
+  for (int k = 0; k < h.rows && !err; k++) {
+    int nrows;
+    err = mat_stream_read(&s, diag[k], 1, &nrows);
+  }
+
+  mat_stream_close(&s);
+  if (!err && cyclic) {
+    *cyclic = h.cyclic;
+  }
+
+  return err;
+}
+
+void matrix_fprintf(FILE *stream, const char *fmt, const matrix *A) {
+  const size_t stride = (size_t)A->stride;
+  if (A->trans) {
+    write_text(stream, fmt, A->data, 1, stride, A->rows, A->cols);
+  } else {
+    write_text(stream, fmt, A->data, stride, 1, A->rows, A->cols);
+  }
+}
+
+int matrix_output(const char *filename, const matrix *A) {
+  const size_t stride = (size_t)A->stride;
+  if (A->trans) {
+    return output_text(filename, NULL, A->data, 1, stride, A->rows, A->cols);
+  }
+  return output_text(filename, NULL, A->data, stride, 1, A->rows, A->cols);
+}
+
+int matrix_input(const char *filename, matrix *A) {
+  mat_stream s;
+  if (mat_stream_open(&s, filename, A->rows, A->cols) != 0) {
+    return 1;
+  }
+
+  // read the rows straight into place, or through a temporary row if the
+  // matrix is transposed
+  double *row = A->trans ? malloc((size_t)A->cols * sizeof(double)) : NULL;
+  int err = (A->trans && A->cols > 0 && row == NULL);
+  for (int i = 0; i < A->rows && !err; i++) {
+    int nrows;
+    double *dst = A->trans ? row : matrix_entry(A, i, 0);
+    err = mat_stream_read(&s, dst, 1, &nrows);
+    for (int j = 0; j < A->cols && A->trans && !err; j++) {
+      *matrix_entry(A, i, j) = row[j];
+    }
+  }
+
+  free(row);
+  mat_stream_close(&s);
+
+  return err;
+}
@@ -1,8 +1,13 @@
 #ifndef IO_H
 #define IO_H
 
+#include <stddef.h>
 #include <stdio.h>
 
+#include "matrix.h"
+
+#define MAT_EXACT_MAX (32) // longest number written by mat_sprint_exact
+
 /**
  * Print a matrix to a file stream in a specified format.
  *
@@ -10,6 +15,9 @@
  * in the format string. It is suggested that a fixed-width format is used, e.g.
  * "%5.1lf".
  *
+ * Rows are formatted into large buffers which are written in single blocks,
+ * and large matrices are formatted in parallel if OpenMP is enabled.
+ *
  * @param stream output stream
  * @param fmt format string
  * @param A pointer to the flattened matrix data
@@ -51,6 +59,33 @@ void mat_printf(const char *fmt, const double *A, int n, int m);
  */
 void mat_print(const double *A, int n, int m);
 
+/**
+ * Print a matrix to a file stream so that it reads back exactly.
+ *
+ * Each entry is written with at most 17 significant digits which always round
+ * back to the same double. The digits come from Grisu2, so they are the
+ * shortest such digits for all but a small fraction of values, e.g. 0.1 is
+ * written as "0.1" and integers are written without a decimal point. Output is
+ * buffered and formatted in parallel as in `mat_fprintf`.
+ *
+ * @param stream output stream
+ * @param A pointer to the flattened matrix data
+ * @param n number of rows
+ * @param m number of columns
+ */
+void mat_fprint_exact(FILE *stream, const double *A, int n, int m);
+
+/**
+ * Write a single number so that it reads back exactly, with the (almost
+ * always shortest) digits described for `mat_fprint_exact`.
+ *
+ * @param s buffer with room for at least MAT_EXACT_MAX characters, which is
+ * not null-terminated
+ * @param x number to write
+ * @return number of characters written
+ */
+size_t mat_sprint_exact(char *s, double x);
+
 /**
  * Output a matrix to a text file in a specified format.
  *
@@ -70,7 +105,8 @@ int mat_outputf(
 );
 
 /**
- * Output a matrix to a text file using the default format.
+ * Output a matrix to a text file so that it reads back exactly, as for
+ * `mat_fprint_exact`.
  *
  * @param filename name of the file to write to
  * @param A pointer to the flattened matrix data
@@ -81,13 +117,16 @@ int mat_outputf(
 int mat_output(const char *filename, const double *A, int n, int m);
 
 /**
- * Read a matrix from a text file in a specified format.
+ * Read a matrix from a text file.
  *
  * Entries are expected to be separated by whitespace. Note that this is a very
  * lax parser and will accept any whitespace, including newlines, even when not
  * at the end of a row. It will also accept files with too many entries, but
  * will error if there are too few.
  *
+ * The file is read in large blocks and parsed with `mat_parse`, rather than
+ * with one fscanf per entry, so large files load at close to disk speed.
+ *
  * @param filename name of the file to read from
  * @param A pointer to the flattened matrix data to be filled.
  * @param n number of rows
@@ -96,4 +135,512 @@ int mat_output(const char *filename, const double *A, int n, int m);
  */
 int mat_input(const char *filename, double *A, int n, int m);
 
+/**
+ * Parse whitespace-separated numbers from a block of text in memory.
+ *
+ * Numbers are accepted in any form strtod accepts, and are rounded exactly.
+ * The common case of at most 19 significant digits and a small exponent is
+ * converted directly, without strtod, and large blocks are split at whitespace
+ * into pieces which are parsed in parallel if OpenMP is enabled.
+ *
+ * @param text text to parse (need not be null-terminated)
+ * @param len length of the text
+ * @param A array to fill
+ * @param count maximum number of entries to parse, any more are ignored
+ * @param nread overwritten with the number of entries parsed
+ * @return 0 on success, 1 if a token (before the count is reached) is not a
+ * number
+ */
+int mat_parse(
+    const char *text, size_t len, double *A, size_t count, size_t *nread
+);
+
+/**
+ * Binary matrix files.
+ *
+ * A binary file is a 64-byte header followed, at data_offset bytes from the
+ * start of the file, by the raw entries in row-major order, with each stored
+ * row stride entries long. The header holds, in order:
+ *   magic        8 bytes, "LAMATRIX"
+ *   version      uint32
+ *   dtype        uint32, MAT_BIN_F64
+ *   endianness   uint32, 0x01020304 in the byte order of the writer
+ *   flags        uint32, bit 0 set if a banded matrix is cyclic
+ *   rows         uint64
+ *   cols         uint64
+ *   stride       uint64, at least cols
+ *   kl           int32, lower bandwidth of banded storage, or -1 if dense
+ *   ku           int32, upper bandwidth of banded storage, or -1 if dense
+ *   data_offset  uint64
+ * A banded matrix (see `mat_output_band_bin`) is stored as kl + ku + 1 rows,
+ * one per diagonal, lowest first, each with one entry per row of the matrix.
+ * Files are written in the byte order of the machine, and converted when read
+ * on a machine of the opposite byte order. Since the data is copied to and
+ * from the file in bulk, reading and writing run at close to disk speed, and
+ * the values round-trip exactly. By default the data starts on a page
+ * boundary, so that the file can be mapped into memory with `mat_map_bin`.
+ */
+#define MAT_BIN_VERSION (1)
+#define MAT_BIN_HEADER_SIZE (64)
+#define MAT_BIN_PAGE_SIZE (4096)
+#define MAT_BIN_F64 (1)
+
+/**
+ * Contents of the header of a binary matrix file.
+ */
+typedef struct {
+  int version; // format version
+  int dtype; // type of the entries
+  int swap; // whether the file has the opposite byte order to this machine
+  int rows; // number of stored rows
+  int cols; // number of columns
+  int stride; // length of each stored row, in entries
+  int kl; // lower bandwidth of banded storage, or -1 if dense
+  int ku; // upper bandwidth of banded storage, or -1 if dense
+  int cyclic; // whether a banded matrix is cyclic
+  size_t data_offset; // offset of the data from the start of the file
+} mat_header;
+
+/**
+ * Fills a header describing a dense, contiguous n x m matrix.
+ *
+ * @param h header to fill
+ * @param n number of rows
+ * @param m number of columns
+ */
+void mat_header_init(mat_header *h, int n, int m);
+
+/**
+ * Output a matrix to a binary file, described by the given header.
+ *
+ * The matrix must be stored as h->rows rows of h->stride entries, and is
+ * written in a single block.
+ *
+ * @param filename name of the file to write to
+ * @param h header describing the matrix
+ * @param A pointer to the flattened matrix data
+ * @return 0 on success, 1 on failure
+ */
+int mat_output_bin_header(
+    const char *filename, const mat_header *h, const double *A
+);
+
+/**
+ * Output a dense matrix to a binary file.
+ *
+ * @param filename name of the file to write to
+ * @param A pointer to the flattened matrix data
+ * @param n number of rows
+ * @param m number of columns
+ * @return 0 on success, 1 on failure
+ */
+int mat_output_bin(const char *filename, const double *A, int n, int m);
+
+/**
+ * Read the header of a binary matrix file, e.g. to find the size of the matrix
+ * before allocating memory for it.
+ *
+ * @param filename name of the file to read from
+ * @param h header to fill
+ * @return 0 on success, 1 on failure (including a file that is not a binary
+ * matrix file)
+ */
+int mat_input_bin_header(const char *filename, mat_header *h);
+
+/**
+ * Read a matrix from a binary file, exactly as it is stored, i.e. as h->rows
+ * rows of h->stride entries, where h is the header of the file.
+ *
+ * @param filename name of the file to read from
+ * @param A pointer to the flattened matrix data to be filled
+ * @param size number of entries A can hold
+ * @return 0 on success, 1 on failure (including if A is too small)
+ */
+int mat_input_bin_raw(const char *filename, double *A, size_t size);
+
+/**
+ * Read a dense matrix from a binary file into a contiguous n x m matrix. Any
+ * padding at the ends of the stored rows is dropped.
+ *
+ * @param filename name of the file to read from
+ * @param A pointer to the flattened matrix data to be filled
+ * @param n number of rows
+ * @param m number of columns
+ * @return 0 on success, 1 on failure (including if the file holds a matrix of
+ * a different size)
+ */
+int mat_input_bin(const char *filename, double *A, int n, int m);
+
+/**
+ * A binary matrix file mapped into memory.
+ */
+typedef struct {
+  mat_header h; // header of the file
+  const double *data; // first stored entry, h.rows rows of h.stride entries
+  void *mem; // start of the mapping (or of the copy, if mapping is unavailable)
+  size_t len; // length of the mapping, in bytes
+  int copied; // whether mem is a copy of the data rather than a mapping
+} mat_map;
+
+/**
+ * Maps a binary matrix file into memory, read-only, without copying it.
+ *
+ * The data is read from the file on demand by the operating system, and is
+ * shared through the page cache with every other process mapping the same
+ * file, so a large operator (or a stored factorisation, for use with
+ * `lu_solve_factorised`) is available immediately and only loaded once per
+ * machine. The kernel is advised that the whole matrix will be needed soon, so
+ * that it can start reading ahead.
+ *
+ * Where memory mapping is not available, or the file has the opposite byte
+ * order to this machine or misaligned data, the data is copied into memory
+ * (and converted) instead, and map->copied is set.
+ *
+ * @param filename name of the file to map
+ * @param map mapping to initialise, must be freed with mat_unmap_bin
+ * @return 0 on success, 1 on failure
+ */
+int mat_map_bin(const char *filename, mat_map *map);
+
+/**
+ * Unmaps a file mapped with mat_map_bin, mat_map_npy or mat_map_npz. The data
+ * must no longer be used.
+ *
+ * @param map mapping to free
+ */
+void mat_unmap_bin(mat_map *map);
+
+/**
+ * A text or binary matrix file being read a few rows at a time.
+ *
+ * Only a bounded block of the file is held in memory at once, so matrices much
+ * larger than memory can be passed through consumers which work row by row,
+ * such as a matrix-vector product. Text files are read in large blocks and
+ * parsed with `mat_parse`, as in `mat_input`, and binary files are read
+ * straight into the caller's buffer.
+ */
+typedef struct {
+  FILE *fp; // file being read
+  int binary; // whether the file is a binary matrix file
+  int swap; // whether the file has the opposite byte order to this machine
+  int rows; // number of rows in the file
+  int cols; // number of columns
+  int stride; // length of each stored row of a binary file, in entries
+  int row; // next row to be read
+  char *buf; // block of text read from the file
+  size_t start; // start of the text not yet parsed
+  size_t end; // end of the text in the block
+  int eof; // whether the end of the file has been read into the block
+} mat_stream;
+
+/**
+ * Opens a text file to be read a few rows at a time. The file is read as for
+ * `mat_input`.
+ *
+ * @param s stream to initialise, must be freed with mat_stream_close
+ * @param filename name of the file to read from
+ * @param n number of rows
+ * @param m number of columns
+ * @return 0 on success, 1 on failure
+ */
+int mat_stream_open(mat_stream *s, const char *filename, int n, int m);
+
+/**
+ * Opens a binary file to be read a few rows at a time. The size of the matrix
+ * is taken from the header, and is available in s->rows and s->cols. Any
+ * padding at the ends of the stored rows is dropped.
+ *
+ * @param s stream to initialise, must be freed with mat_stream_close
+ * @param filename name of the file to read from
+ * @return 0 on success, 1 on failure (including a file that is not a binary
+ * matrix file)
+ */
+int mat_stream_open_bin(mat_stream *s, const char *filename);
+
+/**
+ * Reads the next k rows of a stream into a contiguous block of k x s->cols
+ * entries. Fewer rows are read only once the end of the matrix is reached.
+ *
+ * @param s stream to read from
+ * @param A pointer to the flattened rows to be filled
+ * @param k number of rows to read
+ * @param nrows overwritten with the number of rows read
+ * @return 0 on success, 1 on failure (including if the file ends before the
+ * last row of the matrix)
+ */
+int mat_stream_read(mat_stream *s, double *A, int k, int *nrows);
+
+/**
+ * Closes a stream opened with mat_stream_open or mat_stream_open_bin.
+ *
+ * @param s stream to close
+ */
+void mat_stream_close(mat_stream *s);
+
+/**
+ * NumPy .npy and .npz files.
+ *
+ * An .npy file holds a single array: a short header, whose text is a Python
+ * dictionary giving the type, order and shape of the array, followed by the
+ * raw entries. Only float64 arrays in C (row-major) order are supported, in
+ * either byte order. Arrays of one dimension are read as a single column, and
+ * arrays of more than two dimensions as shape[0] rows of the product of the
+ * other dimensions. When reading, the header of an .npy file is described by
+ * a `mat_header` (with kl = ku = -1, and version the .npy format version).
+ *
+ * An .npz file is a zip archive of .npy files, one per named array, as written
+ * by numpy.savez. Only uncompressed archives are supported, i.e. not those
+ * written by numpy.savez_compressed. Archives written by `mat_output_npz`
+ * align the data of each array to 64 bytes, so that it can be mapped without
+ * copying. The checksums of an archive are written, but not checked on input.
+ */
+
+/**
+ * Output a matrix to an .npy file, as an array of shape (n, m).
+ *
+ * @param filename name of the file to write to
+ * @param A pointer to the flattened matrix data
+ * @param n number of rows
+ * @param m number of columns
+ * @return 0 on success, 1 on failure
+ */
+int mat_output_npy(const char *filename, const double *A, int n, int m);
+
+/**
+ * Output a vector (e.g. the diagonal of a banded matrix) to an .npy file, as
+ * an array of shape (n,).
+ *
+ * @param filename name of the file to write to
+ * @param x vector to write
+ * @param n length of the vector
+ * @return 0 on success, 1 on failure
+ */
+int mat_output_npy_vector(const char *filename, const double *x, int n);
+
+/**
+ * Read the header of an .npy file, e.g. to find the size of the array before
+ * allocating memory for it.
+ *
+ * @param filename name of the file to read from
+ * @param h header to fill
+ * @return 0 on success, 1 on failure (including an unsupported array type)
+ */
+int mat_input_npy_header(const char *filename, mat_header *h);
+
+/**
+ * Read a matrix from an .npy file.
+ *
+ * @param filename name of the file to read from
+ * @param A pointer to the flattened matrix data to be filled
+ * @param n number of rows
+ * @param m number of columns (1 for a vector)
+ * @return 0 on success, 1 on failure (including if the file holds an array of
+ * a different shape)
+ */
+int mat_input_npy(const char *filename, double *A, int n, int m);
+
+/**
+ * Maps an .npy file into memory, read-only, as for `mat_map_bin`.
+ *
+ * @param filename name of the file to map
+ * @param map mapping to initialise, must be freed with mat_unmap_bin
+ * @return 0 on success, 1 on failure
+ */
+int mat_map_npy(const char *filename, mat_map *map);
+
+/**
+ * One array of an .npz archive.
+ */
+typedef struct {
+  const char *name; // name of the array, without the .npy extension
+  const double *data; // flattened array data
+  int rows; // number of rows (or length of a vector)
+  int cols; // number of columns, or 0 to store a vector of length rows
+} mat_npz_entry;
+
+/**
+ * Output a set of arrays to an uncompressed .npz archive.
+ *
+ * @param filename name of the file to write to
+ * @param entries arrays to write
+ * @param count number of arrays
+ * @return 0 on success, 1 on failure
+ */
+int mat_output_npz(
+    const char *filename, const mat_npz_entry *entries, int count
+);
+
+/**
+ * Read the header of one array in an .npz archive. The data offset in the
+ * header is measured from the start of the archive.
+ *
+ * @param filename name of the archive to read from
+ * @param name name of the array (with or without the .npy extension)
+ * @param h header to fill
+ * @return 0 on success, 1 on failure (including if there is no such array, or
+ * it is compressed)
+ */
+int mat_input_npz_header(const char *filename, const char *name, mat_header *h);
+
+/**
+ * Read one array of an .npz archive into a matrix.
+ *
+ * @param filename name of the archive to read from
+ * @param name name of the array (with or without the .npy extension)
+ * @param A pointer to the flattened matrix data to be filled
+ * @param n number of rows
+ * @param m number of columns (1 for a vector)
+ * @return 0 on success, 1 on failure (including if the array has a different
+ * shape)
+ */
+int mat_input_npz(
+    const char *filename, const char *name, double *A, int n, int m
+);
+
+/**
+ * Maps one array of an .npz archive into memory, read-only, as for
+ * `mat_map_bin`. If the data is not aligned to a multiple of 8 bytes in the
+ * archive (as in archives written by numpy.savez) it is copied instead.
+ *
+ * @param filename name of the archive to map
+ * @param name name of the array (with or without the .npy extension)
+ * @param map mapping to initialise, must be freed with mat_unmap_bin
+ * @return 0 on success, 1 on failure
+ */
+int mat_map_npz(const char *filename, const char *name, mat_map *map);
+
+/**
+ * Banded matrix files.
+ *
+ * A banded n x n matrix with kl lower and ku upper diagonals is stored as its
+ * kl + ku + 1 diagonals, lowest first, so only O(n) entries are written. Each
+ * diagonal has n entries indexed by the row of the matrix, exactly as the
+ * arrays passed to `tri_solve` (l, d, u) and `pent_solve` (l2, l1, d0, u1, u2),
+ * and diag[kl] is the main diagonal. If the matrix is cyclic, the entries
+ * which would lie outside the matrix hold its corners, as in `cyclic_tri_solve`
+ * and `cyclic_pent_solve`; otherwise they are written as zero.
+ *
+ * A text file is a header line
+ *   LABANDED n kl ku cyclic
+ * followed by one line per row of the matrix, holding the entry of each
+ * diagonal in that row, e.g. "l[i] d[i] u[i]". Values are written as in
+ * `mat_output`, so they read back exactly. The rows are gathered from and
+ * scattered into the diagonals in blocks, so no copy of the whole matrix is
+ * made.
+ *
+ * A binary file is a binary matrix file (see above) with kl and ku set and one
+ * stored row per diagonal, so the diagonals are read straight into the arrays,
+ * and a file mapped with `mat_map_bin` holds diagonal k at data + k * stride.
+ */
+
+/**
+ * Output a banded matrix to a text file.
+ *
+ * @param filename name of the file to write to
+ * @param diag the kl + ku + 1 diagonals, lowest first
+ * @param kl number of lower diagonals (1 if tridiagonal, 2 if pentadiagonal)
+ * @param ku number of upper diagonals
+ * @param cyclic 1 if the matrix is cyclic, 0 otherwise
+ * @param n size of the matrix (greater than kl and ku)
+ * @return 0 on success, 1 on failure
+ */
+int mat_output_band(
+    const char *filename, const double *const *diag, int kl, int ku, int cyclic,
+    int n
+);
+
+/**
+ * Output a banded matrix to a binary file.
+ *
+ * @param filename name of the file to write to
+ * @param diag the kl + ku + 1 diagonals, lowest first
+ * @param kl number of lower diagonals (1 if tridiagonal, 2 if pentadiagonal)
+ * @param ku number of upper diagonals
+ * @param cyclic 1 if the matrix is cyclic, 0 otherwise
+ * @param n size of the matrix (greater than kl and ku)
+ * @return 0 on success, 1 on failure
+ */
+int mat_output_band_bin(
+    const char *filename, const double *const *diag, int kl, int ku, int cyclic,
+    int n
+);
+
+/**
+ * Read the header of a banded text file, e.g. to find the size of the matrix
+ * before allocating memory for it. The header is filled as for a binary file,
+ * with h->cols the size of the matrix. Use `mat_input_bin_header` for a binary
+ * file.
+ *
+ * @param filename name of the file to read from
+ * @param h header to fill
+ * @return 0 on success, 1 on failure (including a file that is not a banded
+ * text file)
+ */
+int mat_input_band_header(const char *filename, mat_header *h);
+
+/**
+ * Read a banded matrix from a text file.
+ *
+ * @param filename name of the file to read from
+ * @param diag the kl + ku + 1 diagonals to fill, lowest first
+ * @param kl number of lower diagonals, which must match the file
+ * @param ku number of upper diagonals, which must match the file
+ * @param cyclic overwritten with 1 if the matrix is cyclic and 0 otherwise (may
+ * be NULL)
+ * @param n size of the matrix, which must match the file
+ * @return 0 on success, 1 on failure
+ */
+int mat_input_band(
+    const char *filename, double *const *diag, int kl, int ku, int *cyclic,
+    int n
+);
+
+/**
+ * Read a banded matrix from a binary file.
+ *
+ * @param filename name of the file to read from
+ * @param diag the kl + ku + 1 diagonals to fill, lowest first
+ * @param kl number of lower diagonals, which must match the file
+ * @param ku number of upper diagonals, which must match the file
+ * @param cyclic overwritten with 1 if the matrix is cyclic and 0 otherwise (may
+ * be NULL)
+ * @param n size of the matrix, which must match the file
+ * @return 0 on success, 1 on failure (including a dense matrix file)
+ */
+int mat_input_band_bin(
+    const char *filename, double *const *diag, int kl, int ku, int *cyclic,
+    int n
+);
+
+/**
+ * Print a matrix descriptor (which may be a view or a transpose) to a file
+ * stream in a specified format. See `mat_fprintf`.
+ *
+ * @param stream output stream
+ * @param fmt format string
+ * @param A matrix to print
+ */
+void matrix_fprintf(FILE *stream, const char *fmt, const matrix *A);
+
+/**
+ * Output a matrix descriptor to a text file so that it reads back exactly. See
+ * `mat_output`.
+ *
+ * @param filename name of the file to write to
+ * @param A matrix to write
+ * @return 0 on success, 1 on failure
+ */
+int matrix_output(const char *filename, const matrix *A);
+
+/**
+ * Read a matrix descriptor from a text file. The size of the matrix to read is
+ * taken from A, and the entries are written through its strides, so this can
+ * be used to fill a view. See `mat_input`.
+ *
+ * @param filename name of the file to read from
+ * @param A matrix to fill
+ * @return 0 on success, 1 on failure
+ */
+int matrix_input(const char *filename, matrix *A);
+
 #endif // IO_H
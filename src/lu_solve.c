@@ -2,6 +2,7 @@
  * All the LU factorisation, pivoting, and solving algorithms are based on the
  * examples on Wikipedia:
  *   https://en.wikipedia.org/wiki/LU_decomposition
+ *   https://en.wikipedia.org/wiki/Cholesky_decomposition#LDL_decomposition
  */
 
 #include "lu_solve.h"
@@ -14,52 +15,85 @@
 /**
  * Permute the right-hand side vectors according to the permutation array.
  *
+ * Each cycle of the permutation is applied starting from its smallest index,
+ * so piv is only ever read and several threads may share it.
+ *
  * @param F right-hand side vectors, overwritten with permuted vectors
+ * @param ldf distance between consecutive rows of F
  * @param piv permutation array of length n, left unchanged
  * @param n number of rows in F
  * @param m number of right-hand side vectors
  */
-static void permute_vectors(double *F, int *piv, const int n, const int m) {
+static void permute_vectors(
+    double *F, const int ldf, const int *piv, const int n, const int m
+) {
   for (int k = 0; k < n; k++) {
-    // find the first element that is not in the right place
-    int i = k;
-    for (; i < n; i++) {
-      if (piv[i] >= 0) {
-        break;
-      }
+    // skip the cycle through k unless k is its smallest index, in which case
+    // it has not been applied yet
+    int pi = piv[k];
+    while (pi > k) {
+      pi = piv[pi];
     }
-    if (i == n) {
-      break; // all elements are in the right place
+    if (pi < k) {
+      continue;
     }
 
-    // go through the cycle starting with i until we get back to the start
-    const int ii = i; // remember the start of the cycle
-    int pi = piv[i];
-    piv[i] = -piv[i] - 1; // mark as used
-    while (pi != ii) {
+    // go through the cycle starting with k until we get back to the start
+    int i = k;
+    pi = piv[k];
+    while (pi != k) {
       // swap the rows of the right-hand side
+      double *Fi = F + (size_t)i * ldf;
+      double *Fp = F + (size_t)pi * ldf;
       for (int j = 0; j < m; j++) {
-        const double tmp = F[i * m + j];
-        F[i * m + j] = F[pi * m + j];
-        F[pi * m + j] = tmp;
+        const double tmp = Fi[j];
+        Fi[j] = Fp[j];
+        Fp[j] = tmp;
       }
 
       // move forwards in the cycle
       i = pi;
       pi = piv[pi];
-      piv[i] = -piv[i] - 1; // mark as used
     }
   }
+}
 
-  // put piv back to the original form so it can be reused
+/**
+ * Computes the LU factorisation of a matrix with row stride lda, with no
+ * pivoting.
+ */
+static int factorise_no_pivoting(double *A, const int lda, const int n) {
   for (int i = 0; i < n; i++) {
-    piv[i] = -piv[i] - 1;
+    // if the diagonal entry is too small, the matrix is singular or requires
+    // pivoting to factorise
+    const double *Ai = A + (size_t)i * lda;
+    if (fabs(Ai[i]) < LU_TOL) {
+      return i + 1; // return the row of the first zero pivot
+    }
+
+    for (int j = i + 1; j < n; j++) {
+      double *Aj = A + (size_t)j * lda;
+
+      // divide the row by the diagonal entry
+      Aj[i] /= Ai[i];
+
+      // subtract the row from the current row (Gaussian elimination)
+      for (int k = i + 1; k < n; k++) {
+        Aj[k] -= Aj[i] * Ai[k];
+      }
+    }
   }
+
+  return 0;
 }
 
 int lu_factorise(double *A, int *piv, const int n) {
+  return lu_factorise_strided(A, n, piv, n);
+}
+
+int lu_factorise_strided(double *A, const int lda, int *piv, const int n) {
   if (piv == NULL) {
-    return lu_factorise_no_pivoting(A, n);
+    return factorise_no_pivoting(A, lda, n);
   }
 
   // start with a unit pivot matrix
@@ -73,8 +107,8 @@ int lu_factorise(double *A, int *piv, const int n) {
 
     // find the largest entry in the column not above the diagonal
     for (int j = i; j < n; j++) {
-      if (fabs(A[j * n + i]) > maxA) {
-        maxA = fabs(A[j * n + i]);
+      if (fabs(A[(size_t)j * lda + i]) > maxA) {
+        maxA = fabs(A[(size_t)j * lda + i]);
         maxi = j;
       }
     }
@@ -85,6 +119,7 @@ int lu_factorise(double *A, int *piv, const int n) {
     }
 
     // pivot if necessary
+    double *Ai = A + (size_t)i * lda;
     if (maxi != i) {
       // swap the rows in the pivot array
       const int tmp = piv[i];
@@ -92,20 +127,23 @@ int lu_factorise(double *A, int *piv, const int n) {
       piv[maxi] = tmp;
 
       // swap the rows in the matrix
+      double *Am = A + (size_t)maxi * lda;
       for (int j = 0; j < n; j++) {
-        const double tmpA = A[i * n + j];
-        A[i * n + j] = A[maxi * n + j];
-        A[maxi * n + j] = tmpA;
+        const double tmpA = Ai[j];
+        Ai[j] = Am[j];
+        Am[j] = tmpA;
       }
     }
 
     for (int j = i + 1; j < n; j++) {
+      double *Aj = A + (size_t)j * lda;
+
       // divide the pivot row by the pivot element
-      A[j * n + i] /= A[i * n + i];
+      Aj[i] /= Ai[i];
 
       // subtract the pivot row from the current row (Gaussian elimination)
       for (int k = i + 1; k < n; k++) {
-        A[j * n + k] -= A[j * n + i] * A[i * n + k];
+        Aj[k] -= Aj[i] * Ai[k];
       }
     }
   }
@@ -114,75 +152,72 @@ int lu_factorise(double *A, int *piv, const int n) {
 }
 
 int lu_factorise_no_pivoting(double *A, const int n) {
-  for (int i = 0; i < n; i++) {
-    // if the diagonal entry is too small, the matrix is singular or requires
-    // pivoting to factorise
-    if (fabs(A[i * n + i]) < LU_TOL) {
-      return i + 1; // return the row of the first zero pivot
-    }
-
-    for (int j = i + 1; j < n; j++) {
-      // divide the row by the diagonal entry
-      A[j * n + i] /= A[i * n + i];
-
-      // subtract the row from the current row (Gaussian elimination)
-      for (int k = i + 1; k < n; k++) {
-        A[j * n + k] -= A[j * n + i] * A[i * n + k];
-      }
-    }
-  }
-
-  return 0;
+  return factorise_no_pivoting(A, n, n);
 }
 
 void lu_solve_factorised(const double *LU, int *piv, double *f, const int n) {
   // pivot the right-hand side to compute Pf
   if (piv != NULL) {
-    permute_vectors(f, piv, n, 1);
+    permute_vectors(f, 1, piv, n, 1);
   }
 
   // solve Ly = Pf by forward substitution
   for (int i = 0; i < n; i++) {
+    const double *LUi = LU + (size_t)i * n;
     for (int k = 0; k < i; k++) {
-      f[i] -= LU[i * n + k] * f[k];
+      f[i] -= LUi[k] * f[k];
     }
   }
 
   // solve Ux = y by back substitution
   for (int i = n - 1; i >= 0; i--) {
+    const double *LUi = LU + (size_t)i * n;
     for (int k = i + 1; k < n; k++) {
-      f[i] -= LU[i * n + k] * f[k];
+      f[i] -= LUi[k] * f[k];
     }
-    f[i] /= LU[i * n + i];
+    f[i] /= LUi[i];
   }
 }
 
 void lu_solve_factorised_multi(
     const double *LU, int *piv, double *F, const int n, const int m
+) {
+  lu_solve_factorised_multi_strided(LU, n, piv, F, m, n, m);
+}
+
+void lu_solve_factorised_multi_strided(
+    const double *LU, const int ldlu, int *piv, double *F, const int ldf,
+    const int n, const int m
 ) {
   // pivot the right-hand side to compute PF
   if (piv != NULL) {
-    permute_vectors(F, piv, n, m);
+    permute_vectors(F, ldf, piv, n, m);
   }
 
   // solve LY = PF by forward substitution
   for (int i = 0; i < n; i++) {
+    const double *LUi = LU + (size_t)i * ldlu;
+    double *Fi = F + (size_t)i * ldf;
     for (int k = 0; k < i; k++) {
+      const double *Fk = F + (size_t)k * ldf;
       for (int j = 0; j < m; j++) { // apply to entire row
-        F[i * m + j] -= LU[i * n + k] * F[k * m + j];
+        Fi[j] -= LUi[k] * Fk[j];
       }
     }
   }
 
   // solve UX = Y by back substitution
   for (int i = n - 1; i >= 0; i--) {
+    const double *LUi = LU + (size_t)i * ldlu;
+    double *Fi = F + (size_t)i * ldf;
     for (int k = i + 1; k < n; k++) {
+      const double *Fk = F + (size_t)k * ldf;
       for (int j = 0; j < m; j++) { // apply to entire row
-        F[i * m + j] -= LU[i * n + k] * F[k * m + j];
+        Fi[j] -= LUi[k] * Fk[j];
       }
     }
     for (int j = 0; j < m; j++) { // apply to entire row
-      F[i * m + j] /= LU[i * n + i];
+      Fi[j] /= LUi[i];
     }
   }
 }
@@ -210,3 +245,120 @@ int lu_solve_multi(double *A, double *F, int *piv, const int n, const int m) {
   lu_solve_factorised_multi(A, piv, F, n, m);
   return 0;
 }
+
+int matrix_lu_factorise(matrix *A, int *piv) {
+  if (A->trans || A->rows != A->cols) {
+    return -1;
+  }
+  return lu_factorise_strided(A->data, A->stride, piv, A->rows);
+}
+
+int matrix_lu_solve_factorised(const matrix *LU, int *piv, matrix *F) {
+  if (LU->trans || F->trans || LU->rows != LU->cols || F->rows != LU->rows) {
+    return -1;
+  }
+  lu_solve_factorised_multi_strided(
+      LU->data, LU->stride, piv, F->data, F->stride, F->rows, F->cols
+  );
+  return 0;
+}
+
+int matrix_lu_solve(matrix *A, matrix *F, int *piv) {
+  if (F->trans || F->rows != A->rows) {
+    return -1;
+  }
+
+  // factorise the matrix
+  const int err = matrix_lu_factorise(A, piv);
+  if (err != 0) {
+    return err;
+  }
+
+  // solve the factorised system of equations
+  return matrix_lu_solve_factorised(A, piv, F);
+}
+
+int ldlt_factorise(double *A, const int n) {
+  for (int k = 0; k < n; k++) {
+    // if the diagonal entry is too small, the matrix is singular or requires
+    // pivoting to factorise
+    const double *Ak = A + (size_t)k * n;
+    const double d = Ak[k];
+    if (fabs(d) < LU_TOL) {
+      return k + 1; // return the row of the first zero pivot
+    }
+
+    // update the lower triangle of the trailing matrix, going upwards so that
+    // column k of the rows above i has not yet been scaled
+    for (int i = n - 1; i > k; i--) {
+      double *Ai = A + (size_t)i * n;
+      const double Lik = Ai[k] / d;
+      for (int j = k + 1; j <= i; j++) {
+        Ai[j] -= Lik * A[(size_t)j * n + k];
+      }
+      Ai[k] = Lik;
+    }
+  }
+
+  return 0;
+}
+
+void ldlt_solve_lower_multi(
+    const double *LD, double *F, const int n, const int m
+) {
+  for (int i = 0; i < n; i++) {
+    const double *LDi = LD + (size_t)i * n;
+    double *Fi = F + (size_t)i * m;
+    for (int k = 0; k < i; k++) {
+      const double *Fk = F + (size_t)k * m;
+      for (int j = 0; j < m; j++) { // apply to entire row
+        Fi[j] -= LDi[k] * Fk[j];
+      }
+    }
+  }
+}
+
+void ldlt_solve_factorised(const double *LD, double *f, const int n) {
+  ldlt_solve_factorised_multi(LD, f, n, 1);
+}
+
+void ldlt_solve_factorised_multi(
+    const double *LD, double *F, const int n, const int m
+) {
+  // solve LY = F by forward substitution
+  ldlt_solve_lower_multi(LD, F, n, m);
+
+  // solve DZ = Y
+  for (int i = 0; i < n; i++) {
+    const double d = LD[(size_t)i * n + i];
+    double *Fi = F + (size_t)i * m;
+    for (int j = 0; j < m; j++) { // apply to entire row
+      Fi[j] /= d;
+    }
+  }
+
+  // solve L^TX = Z by back substitution, using the rows of L so that the
+  // matrix is accessed contiguously
+  for (int k = n - 1; k > 0; k--) {
+    const double *LDk = LD + (size_t)k * n;
+    const double *Fk = F + (size_t)k * m;
+    for (int i = 0; i < k; i++) {
+      double *Fi = F + (size_t)i * m;
+      for (int j = 0; j < m; j++) { // apply to entire row
+        Fi[j] -= LDk[i] * Fk[j];
+      }
+    }
+  }
+}
+
+int ldlt_solve(double *A, double *f, const int n) {
+  // factorise the matrix
+  const int err = ldlt_factorise(A, n);
+  if (err != 0) {
+    return err; // return the row of the first zero pivot
+  }
+
+  // solve the factorised system of equations
+  ldlt_solve_factorised(A, f, n);
+  return 0;
+}
@@ -1,6 +1,8 @@
 #ifndef LU_SOLVE_H
 #define LU_SOLVE_H
 
+#include "matrix.h"
+
 /**
  * Computes the LU factorisation of a matrix A with partial pivoting.
  *
@@ -26,6 +28,19 @@ int lu_factorise(double *A, int *piv, int n);
  */
 int lu_factorise_no_pivoting(double *A, int n);
 
+/**
+ * As for `lu_factorise`, but for a matrix whose rows are lda apart in memory,
+ * such as a submatrix of a larger matrix.
+ *
+ * @param A first entry of the matrix, overwritten with LU factorisation
+ * @param lda distance between consecutive rows of A (at least n)
+ * @param piv pivot array, overwritten with pivot indices. If NULL, assumes no
+ * pivoting.
+ * @param n size of the matrix
+ * @return 0 on success, row+1 on factorisation failure, -1 on other error
+ */
+int lu_factorise_strided(double *A, int lda, int *piv, int n);
+
 /**
  * Solves the system of equations LUx = Pf.
  *
@@ -59,6 +74,23 @@ void lu_solve_factorised_multi(
     const double *LU, int *piv, double *F, int n, int m
 );
 
+/**
+ * As for `lu_solve_factorised_multi`, but for a factorisation and right-hand
+ * side whose rows are ldlu and ldf apart in memory.
+ *
+ * @param LU first entry of the LU factorisation
+ * @param ldlu distance between consecutive rows of LU (at least n)
+ * @param piv pivot array, containing pivot indices. If NULL, assumes no
+ * pivoting.
+ * @param F right-hand side vectors, overwritten with solution
+ * @param ldf distance between consecutive rows of F (at least m)
+ * @param n number of rows of the matrix
+ * @param m number of right-hand side vectors
+ */
+void lu_solve_factorised_multi_strided(
+    const double *LU, int ldlu, int *piv, double *F, int ldf, int n, int m
+);
+
 /**
  * Solves the system of equations Ax = f using LU factorisation with partial
  * pivoting.
@@ -86,4 +118,105 @@ int lu_solve(double *A, double *f, int *piv, int n);
  */
 int lu_solve_multi(double *A, double *F, int *piv, int n, int m);
 
+/**
+ * Computes the LU factorisation of a square matrix descriptor, which may be a
+ * view into a larger matrix. See `lu_factorise`.
+ *
+ * The matrix_lu_* functions work on the stored rows in place, so they do not
+ * accept transposed descriptors, and return -1 for them rather than packing
+ * them into a copy. To use a transpose, first copy it into a matrix which is
+ * not transposed with `matrix_copy`.
+ *
+ * @param A square matrix, overwritten with LU factorisation (not transposed)
+ * @param piv pivot array, overwritten with pivot indices. If NULL, assumes no
+ * pivoting.
+ * @return 0 on success, row+1 on factorisation failure, -1 on other error
+ */
+int matrix_lu_factorise(matrix *A, int *piv);
+
+/**
+ * Solves the system of equations LUX = PF, where the factorisation and the
+ * right-hand sides are matrix descriptors. See `lu_solve_factorised_multi`.
+ *
+ * @param LU matrix containing LU factorisation (not transposed)
+ * @param piv pivot array, containing pivot indices. If NULL, assumes no
+ * pivoting.
+ * @param F right-hand side vectors, overwritten with solution (not
+ * transposed)
+ * @return 0 on success, -1 on error
+ */
+int matrix_lu_solve_factorised(const matrix *LU, int *piv, matrix *F);
+
+/**
+ * Solves the system of equations AX = F, where A and F are matrix descriptors.
+ * See `lu_solve_multi`.
+ *
+ * @param A square matrix, overwritten with LU factorisation (not transposed)
+ * @param F right-hand side vectors, overwritten with solution (not
+ * transposed)
+ * @param piv pivot array, overwritten with pivot indices. If NULL, assumes no
+ * pivoting.
+ * @return 0 on success, row+1 on factorisation failure, -1 on other error
+ */
+int matrix_lu_solve(matrix *A, matrix *F, int *piv);
+
+/**
+ * Computes the LDL^T factorisation of a symmetric matrix A with no pivoting.
+ *
+ * L is unit lower triangular and D is diagonal. Only the lower triangle of A
+ * is read, and it is overwritten with L below the diagonal and D on the
+ * diagonal. The upper triangle is left untouched. This takes O(n^3 / 3) steps,
+ * half as many as an LU factorisation. A does not need to be positive
+ * definite, but (as for `lu_factorise_no_pivoting`) the factorisation will
+ * fail if a zero pivot is encountered.
+ *
+ * @param A flattened symmetric matrix, lower triangle overwritten with LDL^T
+ * @param n size of the matrix
+ * @return 0 on success, row+1 on factorisation failure, -1 on other error
+ */
+int ldlt_factorise(double *A, int n);
+
+/**
+ * Solves the system of equations LY = F, the first stage of
+ * `ldlt_solve_factorised_multi`.
+ *
+ * @param LD flattened matrix, containing LDL^T factorisation
+ * @param F right-hand side vectors, overwritten with Y
+ * @param n number of rows of the matrix
+ * @param m number of right-hand side vectors
+ */
+void ldlt_solve_lower_multi(const double *LD, double *F, int n, int m);
+
+/**
+ * Solves the system of equations LDL^Tx = f.
+ *
+ * @param LD flattened matrix, containing LDL^T factorisation
+ * @param f right-hand side vector, overwritten with solution
+ * @param n size of the matrix
+ */
+void ldlt_solve_factorised(const double *LD, double *f, int n);
+
+/**
+ * Solves the system of equations LDL^TX = F.
+ *
+ * As for `ldlt_solve_factorised` but for multiple right-hand side vectors.
+ *
+ * @param LD flattened matrix, containing LDL^T factorisation
+ * @param F right-hand side vectors, overwritten with solution
+ * @param n number of rows of the matrix
+ * @param m number of right-hand side vectors
+ */
+void ldlt_solve_factorised_multi(const double *LD, double *F, int n, int m);
+
+/**
+ * Solves the system of equations Ax = f using LDL^T factorisation, where A is
+ * symmetric.
+ *
+ * @param A flattened symmetric matrix, lower triangle overwritten with LDL^T
+ * @param f right-hand side vector, overwritten with solution
+ * @param n size of the matrix
+ * @return 0 on success, row+1 on factorisation failure, -1 on other error
+ */
+int ldlt_solve(double *A, double *f, int n);
+
 #endif // LU_SOLVE_H
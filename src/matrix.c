@@ -0,0 +1,119 @@
+#include "matrix.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alloc.h"
+
+int matrix_alloc(matrix *A, const int rows, const int cols) {
+  memset(A, 0, sizeof(matrix));
+  if (rows < 0 || cols < 0) {
+    return -1;
+  }
+
+  const int stride = aligned_stride_d(cols);
+  size_t size = (size_t)rows * (size_t)stride * sizeof(double);
+  if (size == 0) {
+    size = ALLOC_ALIGN;
+  }
+  A->data = aligned_alloc(ALLOC_ALIGN, size);
+  if (!A->data) {
+    return -1;
+  }
+
+  A->rows = rows;
+  A->cols = cols;
+  A->stride = stride;
+  A->owner = 1;
+
+  return 0;
+}
+
+int matrix_wrap(
+    matrix *A, double *data, const int rows, const int cols, const int stride
+) {
+  memset(A, 0, sizeof(matrix));
+  if (rows < 0 || cols < 0 || stride < cols) {
+    return -1;
+  }
+
+  A->data = data;
+  A->rows = rows;
+  A->cols = cols;
+  A->stride = stride;
+
+  return 0;
+}
+
+void matrix_free(matrix *A) {
+  if (A->owner) {
+    free(A->data);
+  }
+  memset(A, 0, sizeof(matrix));
+}
+
+int matrix_view(
+    matrix *V, const matrix *A, const int i0, const int j0, const int rows,
+    const int cols
+) {
+  if (i0 < 0 || j0 < 0 || rows < 0 || cols < 0 || i0 + rows > A->rows ||
+      j0 + cols > A->cols) {
+    return -1;
+  }
+
+  *V = *A;
+  V->data = matrix_entry(A, i0, j0);
+  V->rows = rows;
+  V->cols = cols;
+  V->owner = 0;
+
+  return 0;
+}
+
+int matrix_row_range(matrix *V, const matrix *A, const int i0, const int rows) {
+  return matrix_view(V, A, i0, 0, rows, A->cols);
+}
+
+void matrix_transpose(matrix *V, const matrix *A) {
+  *V = *A;
+  V->rows = A->cols;
+  V->cols = A->rows;
+  V->trans = !A->trans;
+  V->owner = 0;
+}
+
+double *matrix_entry(const matrix *A, const int i, const int j) {
+  if (A->trans) {
+    return A->data + (size_t)j * A->stride + i;
+  }
+  return A->data + (size_t)i * A->stride + j;
+}
+
+int matrix_is_contiguous(const matrix *A) {
+  return !A->trans && (A->stride == A->cols || A->rows <= 1);
+}
+
+int matrix_copy(matrix *dst, const matrix *src) {
+  if (dst->rows != src->rows || dst->cols != src->cols) {
+    return -1;
+  }
+
+  if (!dst->trans && !src->trans) {
+    for (int i = 0; i < dst->rows; i++) {
+      memcpy(
+          dst->data + (size_t)i * dst->stride,
+          src->data + (size_t)i * src->stride, dst->cols * sizeof(double)
+      );
+    }
+    return 0;
+  }
+
+  for (int i = 0; i < dst->rows; i++) {
+    for (int j = 0; j < dst->cols; j++) {
+      *matrix_entry(dst, i, j) = *matrix_entry(src, i, j);
+    }
+  }
+
+  return 0;
+}
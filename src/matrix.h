@@ -0,0 +1,124 @@
+#ifndef MATRIX_H
+#define MATRIX_H
+
+/**
+ * Lightweight descriptor for a dense row-major matrix, or a view into part of
+ * one.
+ *
+ * Entry (i, j) lives at data[i * stride + j], or at data[j * stride + i] if the
+ * descriptor is transposed, so a submatrix, a range of rows or a transpose of
+ * a matrix can be described without copying any data: only the pointer, the
+ * sizes, the stride and the transpose flag change. This lets blocked and
+ * recursive algorithms hand sub-blocks around for free.
+ *
+ * Views never own their data, so they need not be freed, but they are only
+ * valid for as long as the matrix they point into.
+ */
+typedef struct {
+  double *data; // first entry of the matrix
+  int rows; // number of rows
+  int cols; // number of columns
+  int stride; // distance between consecutive rows of data, in doubles
+  int trans; // whether the matrix is stored transposed
+  int owner; // whether data is freed by matrix_free
+} matrix;
+
+/**
+ * Allocates a rows x cols matrix, whose rows are aligned and padded as for
+ * malloc_d2d_aligned. The entries are not initialised.
+ *
+ * @param A matrix to initialise, must be freed with matrix_free
+ * @param rows number of rows
+ * @param cols number of columns
+ * @return 0 on success, -1 on error
+ */
+int matrix_alloc(matrix *A, int rows, int cols);
+
+/**
+ * Describes existing memory as a rows x cols matrix. The memory is not
+ * copied, and is not freed by matrix_free.
+ *
+ * @param A matrix to initialise
+ * @param data first entry of the matrix
+ * @param rows number of rows
+ * @param cols number of columns
+ * @param stride distance between consecutive rows, in doubles (at least cols)
+ * @return 0 on success, -1 on error
+ */
+int matrix_wrap(matrix *A, double *data, int rows, int cols, int stride);
+
+/**
+ * Frees the memory held by a matrix, if it owns any.
+ *
+ * @param A matrix to free
+ */
+void matrix_free(matrix *A);
+
+/**
+ * Describes the rows x cols submatrix of A whose first entry is (i0, j0).
+ *
+ * @param V view to initialise
+ * @param A matrix to view
+ * @param i0 first row of the submatrix
+ * @param j0 first column of the submatrix
+ * @param rows number of rows of the submatrix
+ * @param cols number of columns of the submatrix
+ * @return 0 on success, -1 if the submatrix does not lie within A
+ */
+int matrix_view(
+    matrix *V, const matrix *A, int i0, int j0, int rows, int cols
+);
+
+/**
+ * Describes rows i0 to i0 + rows - 1 of A.
+ *
+ * @param V view to initialise
+ * @param A matrix to view
+ * @param i0 first row of the view
+ * @param rows number of rows of the view
+ * @return 0 on success, -1 if the rows do not lie within A
+ */
+int matrix_row_range(matrix *V, const matrix *A, int i0, int rows);
+
+/**
+ * Describes the transpose of A.
+ *
+ * @param V view to initialise
+ * @param A matrix to view
+ */
+void matrix_transpose(matrix *V, const matrix *A);
+
+/**
+ * Returns a pointer to the entry (i, j) of A.
+ *
+ * This is convenient but is not intended for inner loops, which should work
+ * with the data and stride directly.
+ *
+ * @param A matrix
+ * @param i row
+ * @param j column
+ * @return pointer to the entry
+ */
+double *matrix_entry(const matrix *A, int i, int j);
+
+/**
+ * Checks whether the rows of A follow on from one another in memory, so that
+ * A->data is a flattened rows x cols matrix that can be passed to the
+ * functions taking bare arrays.
+ *
+ * @param A matrix
+ * @return 1 if A is contiguous, 0 otherwise
+ */
+int matrix_is_contiguous(const matrix *A);
+
+/**
+ * Copies the entries of one matrix into another of the same size, taking
+ * account of the strides and transposes of both.
+ *
+ * @param dst matrix to copy into
+ * @param src matrix to copy from
+ * @return 0 on success, -1 if the sizes differ
+ */
+int matrix_copy(matrix *dst, const matrix *src);
+
+#endif // MATRIX_H
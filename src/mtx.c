@@ -0,0 +1,658 @@
+/**
+ * The header is read line by line with fgets. The entries are then read in
+ * blocks of MTX_CHUNK bytes, each cut at its last whitespace as in
+ * `mat_input`, and parsed with `mat_parse` into a buffer of numbers. The
+ * numbers are passed to a sink one entry at a time, which expands the symmetry
+ * and stores the entry in the destination. Any numbers left over from an entry
+ * cut in two by the end of a block are carried over to the next block.
+ *
+ * The CSR reader stores triplets with the columns and values going straight
+ * into the caller's arrays, then sorts them into rows in place with a single
+ * pass of American flag sort (an in-place counting sort).
+ */
+
+#include "mtx.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "io.h"
+
+#define MTX_CHUNK ((size_t)1 << 22) // size of the blocks read and written
+#define MTX_MAX_LINE (1024) // longest header line, as in the specification
+#define MTX_MAX_ENTRY (2 * 11 + 3 + MAT_EXACT_MAX) // longest line of entries
+
+/**
+ * Where the entries of a file are stored as they are read.
+ */
+typedef struct {
+  const mtx_info *info;
+  double *A; // dense destination, or NULL to store triplets
+  int *row; // triplet destinations
+  int *col;
+  double *val;
+  size_t size; // length of the triplet arrays
+  size_t count; // number of triplets stored
+  int i; // row of the next value of an array file
+  int j; // column of the next value of an array file
+} mtx_sink;
+
+/**
+ * A buffered output file.
+ */
+typedef struct {
+  FILE *fp;
+  char *buf;
+  size_t len;
+  int err;
+} mtx_writer;
+
+static const char *const symmetry_names[3] = {
+    "general", "symmetric", "skew-symmetric"
+};
+
+/**
+ * Reads a line into line[0..MTX_MAX_LINE], discarding the rest of a longer
+ * line.
+ */
+static int read_line(FILE *fp, char *line) {
+  if (!fgets(line, MTX_MAX_LINE + 1, fp)) {
+    return 1;
+  }
+  const size_t len = strlen(line);
+  if (len > 0 && line[len - 1] != '\n') {
+    int c;
+    do {
+      c = fgetc(fp);
+    } while (c != EOF && c != '\n');
+  }
+  return 0;
+}
+
+/**
+ * Converts a string to lower case in place.
+ */
+static void to_lower(char *s) {
+  for (; *s; s++) {
+    *s = (char)tolower((unsigned char)*s);
+  }
+}
+
+/**
+ * The first row of column j which is stored in array format.
+ */
+static int first_row(const mtx_info *info, const int j) {
+  if (info->symmetry == MTX_GENERAL) {
+    return 0;
+  }
+  return (info->symmetry == MTX_SYMMETRIC) ? j : j + 1;
+}
+
+/**
+ * Reads the banner, comments and size line, leaving fp at the first entry.
+ */
+static int read_header(FILE *fp, mtx_info *info) {
+  char line[MTX_MAX_LINE + 2];
+  char object[16], format[16], field[16], symmetry[16];
+  memset(info, 0, sizeof(mtx_info));
+
+  if (read_line(fp, line) ||
+      sscanf(
+          line, "%%%%MatrixMarket %15s %15s %15s %15s", object, format, field,
+          symmetry
+      ) != 4) {
+    return 1;
+  }
+  to_lower(object);
+  to_lower(format);
+  to_lower(field);
+  to_lower(symmetry);
+
+  if (strcmp(object, "matrix") != 0) {
+    return 1;
+  }
+
+  if (strcmp(format, "coordinate") == 0) {
+    info->format = MTX_COORDINATE;
+  } else if (strcmp(format, "array") == 0) {
+    info->format = MTX_ARRAY;
+  } else {
+    return 1;
+  }
+
+  if (strcmp(field, "pattern") == 0 && info->format == MTX_COORDINATE) {
+    info->pattern = 1;
+  } else if (strcmp(field, "real") != 0 && strcmp(field, "integer") != 0 &&
+             strcmp(field, "double") != 0) {
+    return 1; // complex, or pattern in array format
+  }
+
+  if (strcmp(symmetry, "general") == 0) {
+    info->symmetry = MTX_GENERAL;
+  } else if (strcmp(symmetry, "symmetric") == 0) {
+    info->symmetry = MTX_SYMMETRIC;
+  } else if (strcmp(symmetry, "skew-symmetric") == 0) {
+    info->symmetry = MTX_SKEW_SYMMETRIC;
+  } else {
+    return 1; // hermitian
+  }
+
+  // skip comments and blank lines
+  do {
+    if (read_line(fp, line)) {
+      return 1;
+    }
+  } while (line[0] == '%' || strspn(line, " \t\r\n") == strlen(line));
+
+  if (info->format == MTX_COORDINATE) {
+    if (sscanf(line, "%d %d %zu", &info->rows, &info->cols, &info->nnz) != 3) {
+      return 1;
+    }
+  } else if (sscanf(line, "%d %d", &info->rows, &info->cols) != 2) {
+    return 1;
+  }
+  if (info->rows < 0 || info->cols < 0) {
+    return 1;
+  }
+  if (info->symmetry != MTX_GENERAL && info->rows != info->cols) {
+    return 1;
+  }
+
+  const size_t n = (size_t)info->rows;
+  const size_t m = (size_t)info->cols;
+  if (info->format == MTX_ARRAY) {
+    if (info->symmetry == MTX_SYMMETRIC) {
+      info->nnz = n * (n + 1) / 2;
+    } else if (info->symmetry == MTX_SKEW_SYMMETRIC) {
+      info->nnz = (n > 0) ? n * (n - 1) / 2 : 0;
+    } else {
+      info->nnz = n * m;
+    }
+    info->max_entries = n * m;
+  } else {
+    info->max_entries =
+        (info->symmetry == MTX_GENERAL) ? info->nnz : 2 * info->nnz;
+  }
+
+  return 0;
+}
+
+/**
+ * Opens a file and reads its header, returning NULL on failure.
+ */
+static FILE *open_file(const char *filename, mtx_info *info) {
+  FILE *fp = fopen(filename, "r");
+  if (fp && read_header(fp, info)) {
+    fclose(fp);
+    return NULL;
+  }
+  return fp;
+}
+
+static void sink_init(mtx_sink *s, const mtx_info *info) {
+  memset(s, 0, sizeof(mtx_sink));
+  s->info = info;
+  s->i = first_row(info, 0);
+}
+
+/**
+ * Stores a single entry in the sink.
+ */
+static int sink_put(mtx_sink *s, const int i, const int j, const double v) {
+  if (s->A) {
+    s->A[(size_t)i * (size_t)s->info->cols + (size_t)j] = v;
+    return 0;
+  }
+  if (s->count == s->size) {
+    return 1;
+  }
+  s->row[s->count] = i;
+  s->col[s->count] = j;
+  s->val[s->count] = v;
+  s->count++;
+  return 0;
+}
+
+/**
+ * Stores an entry and, if the matrix is symmetric, its mirror image.
+ */
+static int sink_entry(mtx_sink *s, const int i, const int j, const double v) {
+  if (sink_put(s, i, j, v)) {
+    return 1;
+  }
+  if (s->info->symmetry != MTX_GENERAL && i != j) {
+    return sink_put(s, j, i, (s->info->symmetry == MTX_SYMMETRIC) ? v : -v);
+  }
+  return 0;
+}
+
+/**
+ * Stores the entries held in x[0..count), where count is a whole number of
+ * entries.
+ */
+static int sink_values(mtx_sink *s, const double *x, const size_t count) {
+  const mtx_info *info = s->info;
+
+  if (info->format == MTX_ARRAY) {
+    for (size_t k = 0; k < count; k++) {
+      if (sink_entry(s, s->i, s->j, x[k])) {
+        return 1;
+      }
+      // move down the column, then to the top of the next
+      if (++s->i == info->rows) {
+        s->j++;
+        s->i = first_row(info, s->j);
+      }
+    }
+    return 0;
+  }
+
+  const size_t w = info->pattern ? 2 : 3;
+  for (size_t k = 0; k < count; k += w) {
+    const double xi = x[k];
+    const double xj = x[k + 1];
+    if (!(xi >= 1 && xi <= info->rows && xj >= 1 && xj <= info->cols)) {
+      return 1;
+    }
+    const double v = info->pattern ? 1.0 : x[k + 2];
+    if (sink_entry(s, (int)xi - 1, (int)xj - 1, v)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * Reads every entry of a file (positioned after its header) into a sink.
+ */
+static int read_entries(FILE *fp, mtx_sink *s) {
+  const mtx_info *info = s->info;
+  const size_t w =
+      (info->format == MTX_ARRAY) ? 1 : ((info->pattern) ? 2 : 3);
+  const size_t total = info->nnz * w; // numbers in the file
+
+  // a block of len characters holds at most len / 2 + 1 numbers, and fewer
+  // than w are carried over from the previous block
+  char *buf = malloc(MTX_CHUNK);
+  double *x = malloc((MTX_CHUNK / 2 + w) * sizeof(double));
+  if (!buf || !x) {
+    free(buf);
+    free(x);
+    return 1;
+  }
+
+  size_t done = 0; // numbers parsed so far
+  size_t carry = 0; // numbers of an incomplete entry at the start of x
+  size_t keep = 0; // characters of an incomplete token at the start of buf
+  int err = 0;
+  while (done < total && !err) {
+    const size_t got = fread(buf + keep, 1, MTX_CHUNK - keep, fp);
+    const size_t len = keep + got;
+    const int eof = (got < MTX_CHUNK - keep);
+
+    size_t cut = len;
+    if (!eof) {
+      while (cut > 0 && !isspace((unsigned char)buf[cut - 1])) {
+        cut--;
+      }
+      if (cut == 0) {
+        err = 1; // a single token fills the whole block
+        break;
+      }
+    }
+
+    size_t nread;
+    err = mat_parse(buf, cut, x + carry, total - done, &nread);
+    done += nread;
+
+    const size_t avail = carry + nread;
+    const size_t used = avail - avail % w;
+    if (!err) {
+      err = sink_values(s, x, used);
+    }
+    carry = avail - used;
+    memmove(x, x + used, carry * sizeof(double));
+    if (eof) {
+      break;
+    }
+
+    keep = len - cut;
+    memmove(buf, buf + cut, keep);
+  }
+
+  free(buf);
+  free(x);
+
+  return (err || done < total) ? 1 : 0;
+}
+
+/**
+ * Sorts triplets into rows in place, and fills rowptr with the start of each
+ * row.
+ */
+static int sort_rows(
+    int *row, int *col, double *val, const size_t nnz, const int n,
+    size_t *rowptr
+) {
+  memset(rowptr, 0, (size_t)(n + 1) * sizeof(size_t));
+  if (n == 0) {
+    return 0;
+  }
+  size_t *next = malloc((size_t)n * sizeof(size_t)); // next free slot of a row
+  if (!next) {
+    return 1;
+  }
+
+  for (size_t k = 0; k < nnz; k++) {
+    rowptr[row[k] + 1]++;
+  }
+  for (int i = 0; i < n; i++) {
+    rowptr[i + 1] += rowptr[i];
+  }
+  memcpy(next, rowptr, (size_t)n * sizeof(size_t));
+
+  // every row before i is complete, so each swap puts an entry in its place
+  for (int i = 0; i < n; i++) {
+    while (next[i] < rowptr[i + 1]) {
+      const size_t p = next[i];
+      const int r = row[p];
+      if (r == i) {
+        next[i]++;
+        continue;
+      }
+      const size_t q = next[r]++;
+      const int tr = row[q];
+      const int tc = col[q];
+      const double tv = val[q];
+      row[q] = row[p];
+      col[q] = col[p];
+      val[q] = val[p];
+      row[p] = tr;
+      col[p] = tc;
+      val[p] = tv;
+    }
+  }
+
+  free(next);
+  return 0;
+}
+
+int mtx_read_info(const char *filename, mtx_info *info) {
+  FILE *fp = open_file(filename, info);
+  if (fp == NULL) {
+    return 1;
+  }
+  fclose(fp);
+  return 0;
+}
+
+int mtx_read_dense(const char *filename, double *A, const int n, const int m) {
+  mtx_info info;
+  FILE *fp = open_file(filename, &info);
+  if (fp == NULL) {
+    return 1;
+  }
+  if (info.rows != n || info.cols != m) {
+    fclose(fp);
+    return 1;
+  }
+
+  // every entry of a general or symmetric array file is set when it is read
+  if (info.format == MTX_COORDINATE || info.symmetry == MTX_SKEW_SYMMETRIC) {
+    memset(A, 0, (size_t)n * (size_t)m * sizeof(double));
+  }
+
+  mtx_sink s;
+  sink_init(&s, &info);
+  s.A = A;
+  const int err = read_entries(fp, &s);
+
+  fclose(fp);
+
+  return err;
+}
+
+int mtx_read_triplets(
+    const char *filename, int *row, int *col, double *val, const size_t size,
+    size_t *nnz
+) {
+  mtx_info info;
+  *nnz = 0;
+  FILE *fp = open_file(filename, &info);
+  if (fp == NULL) {
+    return 1;
+  }
+
+  mtx_sink s;
+  sink_init(&s, &info);
+  s.row = row;
+  s.col = col;
+  s.val = val;
+  s.size = size;
+  const int err = read_entries(fp, &s);
+  *nnz = s.count;
+
+  fclose(fp);
+
+  return err;
+}
+
+int mtx_read_csr(
+    const char *filename, const int n, size_t *rowptr, int *col, double *val,
+    const size_t size
+) {
+  mtx_info info;
+  FILE *fp = open_file(filename, &info);
+  if (fp == NULL) {
+    return 1;
+  }
+  const size_t cap = (size < info.max_entries) ? size : info.max_entries;
+  int *row = malloc((cap > 0 ? cap : 1) * sizeof(int));
+  if (info.rows != n || !row) {
+    free(row);
+    fclose(fp);
+    return 1;
+  }
+
+  mtx_sink s;
+  sink_init(&s, &info);
+  s.row = row;
+  s.col = col;
+  s.val = val;
+  s.size = cap;
+  int err = read_entries(fp, &s);
+  fclose(fp);
+
+  if (!err) {
+    err = sort_rows(row, col, val, s.count, n, rowptr);
+  }
+
+  free(row);
+
+  return err;
+}
+
+static int writer_open(mtx_writer *w, const char *filename) {
+  w->len = 0;
+  w->err = 0;
+  w->buf = malloc(MTX_CHUNK);
+  w->fp = (w->buf) ? fopen(filename, "w") : NULL;
+  if (w->fp == NULL) {
+    free(w->buf);
+    return 1;
+  }
+  return 0;
+}
+
+static void writer_flush(mtx_writer *w) {
+  if (fwrite(w->buf, 1, w->len, w->fp) != w->len) {
+    w->err = 1;
+  }
+  w->len = 0;
+}
+
+static int writer_close(mtx_writer *w) {
+  writer_flush(w);
+  if (fclose(w->fp) != 0) {
+    w->err = 1;
+  }
+  free(w->buf);
+  return w->err;
+}
+
+/**
+ * Writes the banner and size line.
+ */
+static void write_header(
+    mtx_writer *w, const char *format, const mtx_symmetry symmetry,
+    const int n, const int m, const size_t nnz
+) {
+  int len = snprintf(
+      w->buf, MTX_CHUNK, "%%%%MatrixMarket matrix %s real %s\n", format,
+      symmetry_names[symmetry]
+  );
+  if (strcmp(format, "array") == 0) {
+    len += snprintf(w->buf + len, MTX_CHUNK - (size_t)len, "%d %d\n", n, m);
+  } else {
+    len += snprintf(
+        w->buf + len, MTX_CHUNK - (size_t)len, "%d %d %zu\n", n, m, nnz
+    );
+  }
+  w->len = (size_t)len;
+}
+
+/**
+ * Writes the digits of a non-negative integer, returning the number written.
+ */
+static size_t format_index(char *s, int i) {
+  char tmp[12];
+  size_t n = 0;
+  do {
+    tmp[n++] = (char)('0' + i % 10);
+    i /= 10;
+  } while (i);
+  for (size_t k = 0; k < n; k++) {
+    s[k] = tmp[n - 1 - k];
+  }
+  return n;
+}
+
+/**
+ * Writes a line holding an entry, with its 0-based indices if coordinate is
+ * set.
+ */
+static void write_entry(
+    mtx_writer *w, const int i, const int j, const double v,
+    const int coordinate
+) {
+  if (w->len + MTX_MAX_ENTRY > MTX_CHUNK) {
+    writer_flush(w);
+  }
+  char *s = w->buf + w->len;
+  if (coordinate) {
+    s += format_index(s, i + 1);
+    *s++ = ' ';
+    s += format_index(s, j + 1);
+    *s++ = ' ';
+  }
+  s += mat_sprint_exact(s, v);
+  *s++ = '\n';
+  w->len = (size_t)(s - w->buf);
+}
+
+/**
+ * Whether entry (i, j) is written for the given symmetry.
+ */
+static int is_stored(const mtx_symmetry symmetry, const int i, const int j) {
+  return symmetry == MTX_GENERAL || i > j ||
+         (i == j && symmetry == MTX_SYMMETRIC);
+}
+
+/**
+ * Writes the entries of either triplets (if rowptr is NULL) or CSR arrays.
+ */
+static int write_coordinate(
+    const char *filename, const int n, const int m, const size_t *rowptr,
+    const int *row, const int *col, const double *val, const size_t nnz,
+    const mtx_symmetry symmetry
+) {
+  if (symmetry != MTX_GENERAL && n != m) {
+    return 1;
+  }
+  mtx_writer w;
+  if (writer_open(&w, filename)) {
+    return 1;
+  }
+
+  // count the entries which are stored, then write them
+  size_t count = 0;
+  for (int pass = 0; pass < 2; pass++) {
+    int i = 0;
+    for (size_t k = 0; k < nnz; k++) {
+      if (rowptr) {
+        while (k >= rowptr[i + 1]) {
+          i++;
+        }
+      } else {
+        i = row[k];
+      }
+      if (!is_stored(symmetry, i, col[k])) {
+        continue;
+      }
+      if (pass == 0) {
+        count++;
+      } else {
+        write_entry(&w, i, col[k], val[k], 1);
+      }
+    }
+    if (pass == 0) {
+      write_header(&w, "coordinate", symmetry, n, m, count);
+    }
+  }
+
+  return writer_close(&w);
+}
+
+int mtx_write_dense(
+    const char *filename, const double *A, const int n, const int m,
+    const mtx_symmetry symmetry
+) {
+  if (symmetry != MTX_GENERAL && n != m) {
+    return 1;
+  }
+  mtx_writer w;
+  if (writer_open(&w, filename)) {
+    return 1;
+  }
+  write_header(&w, "array", symmetry, n, m, 0);
+
+  const mtx_info info = {MTX_ARRAY, symmetry, 0, n, m, 0, 0};
+  for (int j = 0; j < m; j++) {
+    for (int i = first_row(&info, j); i < n; i++) {
+      write_entry(&w, i, j, A[(size_t)i * (size_t)m + (size_t)j], 0);
+    }
+  }
+
+  return writer_close(&w);
+}
+
+int mtx_write_triplets(
+    const char *filename, const int n, const int m, const int *row,
+    const int *col, const double *val, const size_t nnz,
+    const mtx_symmetry symmetry
+) {
+  return write_coordinate(
+      filename, n, m, NULL, row, col, val, nnz, symmetry
+  );
+}
+
+int mtx_write_csr(
+    const char *filename, const int n, const int m, const size_t *rowptr,
+    const int *col, const double *val, const mtx_symmetry symmetry
+) {
+  return write_coordinate(
+      filename, n, m, rowptr, NULL, col, val, rowptr[n], symmetry
+  );
+}
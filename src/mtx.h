@@ -0,0 +1,170 @@
+#ifndef MTX_H
+#define MTX_H
+
+#include <stddef.h>
+
+/**
+ * Matrix Market (.mtx) files.
+ *
+ * A Matrix Market file starts with a banner line
+ *   %%MatrixMarket matrix <format> <field> <symmetry>
+ * followed by any number of comment lines starting with '%', a size line and
+ * then the entries, separated by whitespace.
+ *
+ * In coordinate format the size line is "rows cols nnz" and each entry is
+ * "i j value" (or just "i j" for a pattern matrix), with 1-based indices. In
+ * array format the size line is "rows cols" and the values are listed in
+ * column-major order. Symmetric and skew-symmetric files only store the lower
+ * triangle (the strict lower triangle if skew-symmetric), and the upper
+ * triangle is filled in when they are read.
+ *
+ * Real, integer and pattern fields are supported (pattern entries are read as
+ * 1), but complex and Hermitian files are not. All indices in the functions
+ * below are 0-based.
+ *
+ * Entries are read from the file in large blocks and parsed with `mat_parse`,
+ * which works in parallel when OpenMP is enabled. Each entry is stored as soon
+ * as it is parsed, so memory use is bounded by the size of the block and the
+ * destination arrays, and a sparse matrix is never expanded into a dense one.
+ * Values are written with `mat_sprint_exact`, so they read back exactly.
+ */
+typedef enum { MTX_COORDINATE, MTX_ARRAY } mtx_format;
+
+typedef enum { MTX_GENERAL, MTX_SYMMETRIC, MTX_SKEW_SYMMETRIC } mtx_symmetry;
+
+/**
+ * The header of a Matrix Market file.
+ */
+typedef struct {
+  mtx_format format; // coordinate (sparse) or array (dense)
+  mtx_symmetry symmetry; // which part of the matrix is stored
+  int pattern; // whether the entries have no values
+  int rows; // number of rows
+  int cols; // number of columns
+  size_t nnz; // number of entries stored in the file
+  size_t max_entries; // most entries once the symmetry is expanded
+} mtx_info;
+
+/**
+ * Read the header of a Matrix Market file.
+ *
+ * @param filename name of the file to read from
+ * @param info overwritten with the header
+ * @return 0 on success, 1 on failure
+ */
+int mtx_read_info(const char *filename, mtx_info *info);
+
+/**
+ * Read a Matrix Market file (in either format) into a dense matrix.
+ *
+ * Entries missing from a coordinate file are set to zero. If an entry is
+ * repeated, the last value is kept.
+ *
+ * @param filename name of the file to read from
+ * @param A pointer to the flattened matrix data to be filled
+ * @param n number of rows, which must match the file
+ * @param m number of columns, which must match the file
+ * @return 0 on success, 1 on failure
+ */
+int mtx_read_dense(const char *filename, double *A, int n, int m);
+
+/**
+ * Read a Matrix Market file (in either format) into triplets, in the order the
+ * entries appear in the file.
+ *
+ * The mirror image of each off-diagonal entry of a symmetric file is stored
+ * straight after it. Every entry of an array file is stored, including any
+ * zeros.
+ *
+ * @param filename name of the file to read from
+ * @param row array to fill with the row of each entry
+ * @param col array to fill with the column of each entry
+ * @param val array to fill with the value of each entry
+ * @param size length of the arrays, at most max_entries is needed
+ * @param nnz overwritten with the number of entries stored
+ * @return 0 on success, 1 on failure (including if the arrays are too short)
+ */
+int mtx_read_triplets(
+    const char *filename, int *row, int *col, double *val, size_t size,
+    size_t *nnz
+);
+
+/**
+ * Read a Matrix Market file (in either format) into compressed sparse row
+ * (CSR) arrays, so that the entries of row i are col[k], val[k] for
+ * rowptr[i] <= k < rowptr[i + 1].
+ *
+ * The entries are read directly into col and val and then sorted into rows in
+ * place, so the only extra memory is one int per entry. The columns within
+ * each row are not sorted.
+ *
+ * @param filename name of the file to read from
+ * @param n number of rows, which must match the file
+ * @param rowptr array of length n + 1 to fill with the start of each row
+ * @param col array to fill with the column of each entry
+ * @param val array to fill with the value of each entry
+ * @param size length of col and val, at most max_entries is needed
+ * @return 0 on success, 1 on failure (including if the arrays are too short)
+ */
+int mtx_read_csr(
+    const char *filename, int n, size_t *rowptr, int *col, double *val,
+    size_t size
+);
+
+/**
+ * Write a dense matrix to a Matrix Market file in array format.
+ *
+ * For symmetric storage only the lower triangle is written (the strict lower
+ * triangle if skew-symmetric), and the rest of A is not checked.
+ *
+ * @param filename name of the file to write to
+ * @param A pointer to the flattened matrix data
+ * @param n number of rows
+ * @param m number of columns (must equal n unless the storage is general)
+ * @param symmetry which part of the matrix to store
+ * @return 0 on success, 1 on failure
+ */
+int mtx_write_dense(
+    const char *filename, const double *A, int n, int m, mtx_symmetry symmetry
+);
+
+/**
+ * Write triplets to a Matrix Market file in coordinate format.
+ *
+ * For symmetric storage only the entries in the lower triangle are written
+ * (the strict lower triangle if skew-symmetric), and the rest are skipped.
+ *
+ * @param filename name of the file to write to
+ * @param n number of rows
+ * @param m number of columns (must equal n unless the storage is general)
+ * @param row row of each entry
+ * @param col column of each entry
+ * @param val value of each entry
+ * @param nnz number of entries
+ * @param symmetry which part of the matrix to store
+ * @return 0 on success, 1 on failure
+ */
+int mtx_write_triplets(
+    const char *filename, int n, int m, const int *row, const int *col,
+    const double *val, size_t nnz, mtx_symmetry symmetry
+);
+
+/**
+ * Write CSR arrays to a Matrix Market file in coordinate format, as for
+ * `mtx_write_triplets`.
+ *
+ * @param filename name of the file to write to
+ * @param n number of rows
+ * @param m number of columns (must equal n unless the storage is general)
+ * @param rowptr start of each row in col and val (length n + 1)
+ * @param col column of each entry
+ * @param val value of each entry
+ * @param symmetry which part of the matrix to store
+ * @return 0 on success, 1 on failure
+ */
+int mtx_write_csr(
+    const char *filename, int n, int m, const size_t *rowptr, const int *col,
+    const double *val, mtx_symmetry symmetry
+);
+
+#endif // MTX_H
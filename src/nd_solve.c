@@ -0,0 +1,474 @@
+/**
+ * Nested dissection is described in "Nested dissection of a regular finite
+ * element mesh" by George 1973 (https://doi.org/10.1137/0710032), and the
+ * multifrontal elimination used here in "The multifrontal method for sparse
+ * matrix solution: theory and practice" by Liu 1992
+ * (https://doi.org/10.1137/1034004).
+ *
+ * Each node eliminates its separator s from its front [s; b], where b is the
+ * boundary of the node:
+ *   [F_ss F_sb; F_bs F_bb]
+ * with F assembled from the entries of the matrix coupling s to s and b, plus
+ * the update matrices of the children. This is exactly the 2x2 block system of
+ * `block_factorise_with`, with the Schur complement F_bb - F_bs F_ss^-1 F_sb
+ * left unfactorised to become the update matrix of the node.
+ *
+ * The solve is a forward sweep up the tree, where each node solves for its
+ * separator and passes an update vector for its boundary to its parent, and a
+ * backward sweep down the tree, where each node computes its separator from
+ * the (already known) values on its boundary.
+ */
+
+#include "nd_solve.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Rectangles with fewer points than this are processed without creating new
+ * OpenMP tasks.
+ */
+#define ND_TASK_SIZE (1024)
+
+/**
+ * Counts the nodes needed for a rectangle with h x w points.
+ */
+static int count_nodes(const int h, const int w) {
+  if (h <= 0 || w <= 0) {
+    return 0;
+  }
+  if (h == 1 || w == 1) {
+    return 1;
+  }
+  if (h >= w) {
+    return 1 + count_nodes(h / 2, w) + count_nodes(h - h / 2 - 1, w);
+  }
+  return 1 + count_nodes(h, w / 2) + count_nodes(h, w - w / 2 - 1);
+}
+
+static int compare_pairs(const void *a, const void *b) {
+  const int ga = *(const int *)a;
+  const int gb = *(const int *)b;
+  return (ga > gb) - (ga < gb);
+}
+
+/**
+ * Finds the position of the global index g in the front of the node, or -1 if
+ * it is not in the front.
+ */
+static int lookup(const nd_node *node, const int g) {
+  int lo = 0;
+  int hi = node->ns + node->nb;
+  while (lo < hi) {
+    const int mid = (lo + hi) / 2;
+    const int gm = node->order[2 * mid];
+    if (gm == g) {
+      return node->order[2 * mid + 1];
+    }
+    if (gm < g) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return -1;
+}
+
+/**
+ * Recursively builds the node for the rectangle [i0, i1) x [j0, j1), returning
+ * its index, -1 if the rectangle is empty, or -2 on error.
+ */
+static int build_node(
+    nd_factor *nd, const int i0, const int i1, const int j0, const int j1,
+    const int parent
+) {
+  const int h = i1 - i0;
+  const int w = j1 - j0;
+  if (h <= 0 || w <= 0) {
+    return -1;
+  }
+
+  const int idx = nd->nnodes++;
+  nd_node *node = nd->nodes + idx;
+  node->i0 = i0;
+  node->i1 = i1;
+  node->j0 = j0;
+  node->j1 = j1;
+  node->parent = parent;
+  node->child[0] = -1;
+  node->child[1] = -1;
+
+  // the separator is the whole rectangle for a line, otherwise the middle
+  // line across its longer side
+  const int leaf = (h == 1 || w == 1);
+  const int split_rows = (h >= w);
+  int si0 = i0, si1 = i1, sj0 = j0, sj1 = j1;
+  if (!leaf) {
+    if (split_rows) {
+      si0 = i0 + h / 2;
+      si1 = si0 + 1;
+    } else {
+      sj0 = j0 + w / 2;
+      sj1 = sj0 + 1;
+    }
+  }
+  node->ns = (si1 - si0) * (sj1 - sj0);
+
+  // the boundary consists of the neighbouring points outside the rectangle
+  const int nx = nd->nx;
+  const int ny = nd->ny;
+  const int nb = ((i0 > 0) + (i1 < nx)) * w + ((j0 > 0) + (j1 < ny)) * h;
+  node->nb = nb;
+
+  const int nf = node->ns + nb;
+  node->idx = malloc(nf * sizeof(int));
+  node->order = malloc(2 * nf * sizeof(int));
+  node->up = malloc((nb > 0 ? nb : 1) * sizeof(int));
+  if (!node->idx || !node->order || !node->up) {
+    return -2;
+  }
+
+  int k = 0;
+  for (int i = si0; i < si1; i++) {
+    for (int j = sj0; j < sj1; j++) {
+      node->idx[k++] = i * ny + j;
+    }
+  }
+  for (int j = j0; j < j1; j++) {
+    if (i0 > 0) {
+      node->idx[k++] = (i0 - 1) * ny + j;
+    }
+    if (i1 < nx) {
+      node->idx[k++] = i1 * ny + j;
+    }
+  }
+  for (int i = i0; i < i1; i++) {
+    if (j0 > 0) {
+      node->idx[k++] = i * ny + j0 - 1;
+    }
+    if (j1 < ny) {
+      node->idx[k++] = i * ny + j1;
+    }
+  }
+
+  for (int p = 0; p < nf; p++) {
+    node->order[2 * p] = node->idx[p];
+    node->order[2 * p + 1] = p;
+  }
+  qsort(node->order, nf, 2 * sizeof(int), compare_pairs);
+
+  // the boundary of every node lies in the front of its parent
+  if (parent >= 0) {
+    const nd_node *pnode = nd->nodes + parent;
+    for (int p = 0; p < nb; p++) {
+      node->up[p] = lookup(pnode, node->idx[node->ns + p]);
+      if (node->up[p] < 0) {
+        return -2;
+      }
+    }
+  }
+
+  if (leaf) {
+    return idx;
+  }
+
+  int c0, c1;
+  if (split_rows) {
+    c0 = build_node(nd, i0, si0, j0, j1, idx);
+    c1 = (c0 < -1) ? c0 : build_node(nd, si1, i1, j0, j1, idx);
+  } else {
+    c0 = build_node(nd, i0, i1, j0, sj0, idx);
+    c1 = (c0 < -1) ? c0 : build_node(nd, i0, i1, sj1, j1, idx);
+  }
+  if (c0 < -1 || c1 < -1) {
+    return -2;
+  }
+  node->child[0] = c0;
+  node->child[1] = c1;
+
+  return idx;
+}
+
+/**
+ * Adds v to entry (r, c) of the front of the node.
+ */
+static void front_add(
+    nd_node *node, double *B, const int r, const int c, const double v
+) {
+  const int ns = node->ns;
+  const int nb = node->nb;
+  if (r < ns && c < ns) {
+    if (node->piv) {
+      node->mem[r * ns + c] += v;
+    } else {
+      // tridiagonal leaf, stored as l, d, u
+      node->mem[(c - r + 1) * ns + r] += v;
+    }
+  } else if (r < ns) {
+    B[r * nb + c - ns] += v;
+  } else if (c < ns) {
+    node->C[(r - ns) * ns + c] += v;
+  } else {
+    node->U[(r - ns) * nb + c - ns] += v;
+  }
+}
+
+/**
+ * Adds the entries of the matrix which couple the separator of the node to
+ * its front.
+ */
+static void assemble(
+    const nd_factor *nd, nd_node *node, double *B, const double *const *a
+) {
+  const int nx = nd->nx;
+  const int ny = nd->ny;
+  const int di[5] = {-1, 0, 0, 0, 1};
+  const int dj[5] = {0, -1, 0, 1, 0};
+
+  for (int r = 0; r < node->ns; r++) {
+    const int p = node->idx[r];
+    const int i = p / ny;
+    const int j = p % ny;
+    for (int k = 0; k < 5; k++) {
+      const int qi = i + di[k];
+      const int qj = j + dj[k];
+      if (qi < 0 || qi >= nx || qj < 0 || qj >= ny) {
+        continue; // outside the grid
+      }
+      const int q = qi * ny + qj;
+      const int c = lookup(node, q);
+      if (c < 0) {
+        continue; // already eliminated by a descendant
+      }
+
+      front_add(node, B, r, c, a[k][p]);
+      if (c >= node->ns) {
+        front_add(node, B, c, r, a[4 - k][q]); // row q, coupling back to p
+      }
+    }
+  }
+}
+
+/**
+ * Recursively factorises the node and its descendants.
+ */
+static int
+factorise_node(nd_factor *nd, const int idx, const double *const *a) {
+  nd_node *node = nd->nodes + idx;
+  const int area = (node->i1 - node->i0) * (node->j1 - node->j0);
+
+  int errs[2] = {0, 0};
+  for (int c = 0; c < 2; c++) {
+    if (node->child[c] < 0) {
+      continue;
+    }
+#ifdef _OPENMP
+#pragma omp task shared(errs) if (area > ND_TASK_SIZE)
+#endif
+    errs[c] = factorise_node(nd, node->child[c], a);
+  }
+#ifdef _OPENMP
+#pragma omp taskwait
+#endif
+  (void)area; // only used by OpenMP
+  if (errs[0] != 0 || errs[1] != 0) {
+    return (errs[0] != 0) ? errs[0] : errs[1];
+  }
+
+  const int ns = node->ns;
+  const int nb = node->nb;
+  const int tri = (node->child[0] < 0 && node->child[1] < 0 && ns >= 3);
+
+  node->mem = calloc(tri ? 3 * ns : ns * ns, sizeof(double));
+  node->piv = tri ? NULL : malloc(ns * sizeof(int));
+  node->C = calloc(nb * ns + 1, sizeof(double));
+  node->U = calloc(nb * nb + 1, sizeof(double));
+  node->AB = malloc((ns * nb + 1) * sizeof(double));
+  node->r = malloc((ns + nb) * sizeof(double));
+  double *B = calloc(ns * nb + 1, sizeof(double));
+  if (!node->mem || (!tri && !node->piv) || !node->C || !node->U ||
+      !node->AB || !node->r || !B) {
+    free(B);
+    return -1;
+  }
+
+  // assemble the front from the matrix and the children's update matrices
+  assemble(nd, node, B, a);
+  for (int c = 0; c < 2; c++) {
+    if (node->child[c] < 0) {
+      continue;
+    }
+    nd_node *child = nd->nodes + node->child[c];
+    const int nbc = child->nb;
+    for (int p = 0; p < nbc; p++) {
+      for (int q = 0; q < nbc; q++) {
+        front_add(node, B, child->up[p], child->up[q], child->U[p * nbc + q]);
+      }
+    }
+    free(child->U);
+    child->U = NULL;
+  }
+
+  // eliminate the separator, leaving the update matrix in U
+  if (tri) {
+    block_sub_solver_tri(
+        &node->sa, node->mem, node->mem + ns, node->mem + 2 * ns
+    );
+  } else {
+    block_sub_solver_lu(&node->sa, node->mem, node->piv);
+  }
+  block_sub_solver ss;
+  block_sub_solver_identity(&ss);
+  const int err = block_factorise_with(
+      &node->sa, B, node->C, node->U, &ss, node->AB, ns, nb
+  );
+  free(B);
+  if (err > 0) {
+    return node->idx[err - 1] + 1; // return the global row of the zero pivot
+  }
+
+  return err;
+}
+
+/**
+ * Forward sweep: solves for the separator of the node given the update vectors
+ * of its children, leaving [y; u] in the node's workspace.
+ */
+static void forward(const nd_factor *nd, const int idx, const double *f) {
+  const nd_node *node = nd->nodes + idx;
+  const int area = (node->i1 - node->i0) * (node->j1 - node->j0);
+  for (int c = 0; c < 2; c++) {
+    if (node->child[c] < 0) {
+      continue;
+    }
+#ifdef _OPENMP
+#pragma omp task if (area > ND_TASK_SIZE)
+#endif
+    forward(nd, node->child[c], f);
+  }
+#ifdef _OPENMP
+#pragma omp taskwait
+#endif
+  (void)area; // only used by OpenMP
+
+  const int ns = node->ns;
+  const int nb = node->nb;
+  double *r = node->r;
+  for (int k = 0; k < ns; k++) {
+    r[k] = f[node->idx[k]];
+  }
+  for (int k = ns; k < ns + nb; k++) {
+    r[k] = 0.0;
+  }
+  for (int c = 0; c < 2; c++) {
+    if (node->child[c] < 0) {
+      continue;
+    }
+    const nd_node *child = nd->nodes + node->child[c];
+    for (int p = 0; p < child->nb; p++) {
+      r[child->up[p]] += child->r[child->ns + p];
+    }
+  }
+
+  // y = F_ss \ r_s, u = r_b - F_bs y
+  node->sa.solve(&node->sa, r, ns);
+  for (int p = 0; p < nb; p++) {
+    for (int k = 0; k < ns; k++) {
+      r[ns + p] -= node->C[p * ns + k] * r[k];
+    }
+  }
+}
+
+/**
+ * Backward sweep: computes x_s = y - F_ss^-1 F_sb x_b for the node and then its
+ * descendants.
+ */
+static void backward(const nd_factor *nd, const int idx, double *f) {
+  const nd_node *node = nd->nodes + idx;
+  const int ns = node->ns;
+  const int nb = node->nb;
+  for (int k = 0; k < ns; k++) {
+    double x = node->r[k];
+    for (int p = 0; p < nb; p++) {
+      x -= node->AB[k * nb + p] * f[node->idx[ns + p]];
+    }
+    f[node->idx[k]] = x;
+  }
+
+  const int area = (node->i1 - node->i0) * (node->j1 - node->j0);
+  for (int c = 0; c < 2; c++) {
+    if (node->child[c] < 0) {
+      continue;
+    }
+#ifdef _OPENMP
+#pragma omp task if (area > ND_TASK_SIZE)
+#endif
+    backward(nd, node->child[c], f);
+  }
+#ifdef _OPENMP
+#pragma omp taskwait
+#endif
+  (void)area; // only used by OpenMP
+}
+
+int nd_factorise(
+    nd_factor *nd, const double *l2, const double *l1, const double *d0,
+    const double *u1, const double *u2, const int nx, const int ny
+) {
+  memset(nd, 0, sizeof(nd_factor));
+  if (nx < 1 || ny < 1) {
+    return -1;
+  }
+  nd->nx = nx;
+  nd->ny = ny;
+
+  nd->nodes = calloc(count_nodes(nx, ny), sizeof(nd_node));
+  if (!nd->nodes) {
+    return -1;
+  }
+  if (build_node(nd, 0, nx, 0, ny, -1) < 0) {
+    nd_factor_free(nd);
+    return -1;
+  }
+
+  const double *const a[5] = {l2, l1, d0, u1, u2};
+  int err = 0;
+#ifdef _OPENMP
+#pragma omp parallel
+#pragma omp single
+#endif
+  err = factorise_node(nd, 0, a);
+
+  if (err != 0) {
+    nd_factor_free(nd);
+  }
+  return err;
+}
+
+void nd_factor_free(nd_factor *nd) {
+  for (int i = 0; i < nd->nnodes; i++) {
+    nd_node *node = nd->nodes + i;
+    free(node->idx);
+    free(node->order);
+    free(node->up);
+    free(node->mem);
+    free(node->piv);
+    free(node->AB);
+    free(node->C);
+    free(node->U);
+    free(node->r);
+  }
+  free(nd->nodes);
+  memset(nd, 0, sizeof(nd_factor));
+}
+
+void nd_solve_factorised(const nd_factor *nd, double *f) {
+#ifdef _OPENMP
+#pragma omp parallel
+#pragma omp single
+#endif
+  {
+    forward(nd, 0, f);
+    backward(nd, 0, f);
+  }
+}
@@ -0,0 +1,96 @@
+#ifndef ND_SOLVE_H
+#define ND_SOLVE_H
+
+#include "block_solve.h"
+
+/**
+ * A node of the nested dissection tree, covering the rectangle of grid points
+ * [i0, i1) x [j0, j1).
+ *
+ * The front of the node is its separator (eliminated at this node) followed by
+ * its boundary, the grid points just outside the rectangle, which all lie on
+ * the separators of its ancestors.
+ */
+typedef struct {
+  int i0, i1, j0, j1; // rectangle covered by the node
+  int child[2]; // indices of the children, or -1 if there is no child
+  int parent; // index of the parent, or -1 for the root
+  int ns; // number of separator points
+  int nb; // number of boundary points
+  int *idx; // global indices of the front, separator then boundary
+  int *order; // front positions sorted by global index, for lookups
+  int *up; // positions of the boundary points in the parent's front
+  block_sub_solver sa; // solver for the separator block
+  double *mem; // separator block (dense, or tridiagonal for a leaf line)
+  int *piv; // pivot array for a dense separator block
+  double *AB; // separator block \ (separator-boundary block)
+  double *C; // boundary-separator block
+  double *U; // update matrix, only held during the factorisation
+  double *r; // front workspace for the solve
+} nd_node;
+
+/**
+ * Nested dissection factorisation of the five-point operator on a 2D grid.
+ *
+ * The grid has nx x ny points, stored in row-major order so that point (i, j)
+ * has index i * ny + j. Row (i, j) of the matrix couples the point to its
+ * neighbours with the five diagonals
+ *   l2 (i-1, j), l1 (i, j-1), d0 (i, j), u1 (i, j+1), u2 (i+1, j)
+ * i.e. a pentadiagonal-like matrix with outer diagonals at offsets +/-ny.
+ * Entries which would couple to points outside the grid are ignored.
+ *
+ * The grid is split recursively into two halves and a separator line, until
+ * the pieces are single lines of points. Working up the tree, each node forms
+ * its front from the original matrix and the update matrices of its children,
+ * and eliminates its separator with `block_factorise_with`, passing the Schur
+ * complement on its boundary up to its parent. The leaves are tridiagonal and
+ * are factorised with `tri_lu_factorise`, while the separators are dense. For
+ * an N point grid the factorisation takes O(N^1.5) steps and each solve
+ * O(N log N), compared with O(N^3) and O(N^2) for `lu_solve`. If OpenMP is
+ * enabled, independent subtrees are processed in parallel as tasks.
+ *
+ * The matrix is assumed to be such that no pivoting is needed between the
+ * blocks, e.g. diagonally dominant. The factorisation holds a workspace for
+ * each node, so it should not be used by two solves at once.
+ */
+typedef struct {
+  int nx; // number of grid points in the first direction
+  int ny; // number of grid points in the second direction
+  int nnodes; // number of nodes in the tree
+  nd_node *nodes; // nodes of the tree, with the root first
+} nd_factor;
+
+/**
+ * Factorises the five-point operator on an nx x ny grid.
+ *
+ * @param nd factorisation, must be freed with nd_factor_free
+ * @param l2 coupling to (i-1, j)
+ * @param l1 coupling to (i, j-1)
+ * @param d0 diagonal
+ * @param u1 coupling to (i, j+1)
+ * @param u2 coupling to (i+1, j)
+ * @param nx number of grid points in the first direction
+ * @param ny number of grid points in the second direction
+ * @return 0 on success, row+1 on factorisation failure, -1 on other error
+ */
+int nd_factorise(
+    nd_factor *nd, const double *l2, const double *l1, const double *d0,
+    const double *u1, const double *u2, int nx, int ny
+);
+
+/**
+ * Frees the memory held by a nested dissection factorisation.
+ *
+ * @param nd factorisation to free
+ */
+void nd_factor_free(nd_factor *nd);
+
+/**
+ * Solves Ax = f in place using a nested dissection factorisation.
+ *
+ * @param nd factorisation
+ * @param f right-hand side on the grid, overwritten with the solution
+ */
+void nd_solve_factorised(const nd_factor *nd, double *f);
+
+#endif // ND_SOLVE_H
@@ -9,6 +9,8 @@
 
 #include "pent_solve.h"
 
+#include <stddef.h>
+
 void pent_lu_factorise(
     const double *l2, double *l1, double *d0, double *u1, double *u2,
     const int n
@@ -66,6 +68,36 @@ void pent_lu_solve(
   }
 }
 
+void pent_lu_solve_multi(
+    const double *l2, const double *l1, const double *l0, const double *u1,
+    const double *u2, double *F, const int n, const int m
+) {
+  // solve LY = F via forward substitution
+  double *Y = F;
+  for (int j = 0; j < m; j++) { // apply to entire row
+    Y[j] /= l0[0];
+    Y[m + j] = (Y[m + j] - l1[1] * Y[j]) / l0[1];
+  }
+  for (int i = 2; i < n; i++) {
+    double *Yi = Y + (size_t)i * m;
+    for (int j = 0; j < m; j++) { // apply to entire row
+      Yi[j] = (Yi[j] - l1[i] * Yi[j - m] - l2[i] * Yi[j - 2 * m]) / l0[i];
+    }
+  }
+
+  // solve UX = Y via backward substitution
+  double *X = Y;
+  for (int j = 0; j < m; j++) { // apply to entire row
+    X[(size_t)(n - 2) * m + j] -= u1[n - 2] * X[(size_t)(n - 1) * m + j];
+  }
+  for (int i = n - 3; i >= 0; i--) {
+    double *Xi = X + (size_t)i * m;
+    for (int j = 0; j < m; j++) { // apply to entire row
+      Xi[j] -= u1[i] * Xi[j + m] + u2[i] * Xi[j + 2 * m];
+    }
+  }
+}
+
 void pent_solve(
     const double *l2, double *l1, double *d0, double *u1, double *u2, double *f,
     const int n
@@ -142,6 +174,36 @@ void cyclic_pent_lu_solve(
   }
 }
 
+void cyclic_pent_lu_solve_multi(
+    const double *l2, const double *l1, const double *l0, const double *u1,
+    const double *u2, const double *k0, const double *k1, double *F,
+    const int n, const int m
+) {
+  // solve E \ F[:-2]
+  pent_lu_solve_multi(l2, l1, l0, u1, u2, F, n - 2, m);
+
+  // rows of the final two elements of the solution, see cyclic_pent_lu_solve
+  double *Fa = F + (size_t)(n - 2) * m;
+  double *Fb = F + (size_t)(n - 1) * m;
+  const double det = l0[n - 2] * l0[n - 1] - u1[n - 2] * l1[n - 1];
+  for (int j = 0; j < m; j++) { // apply to entire row
+    const double fa = Fa[j] - u2[n - 2] * F[j] -
+                      l2[n - 2] * F[(size_t)(n - 4) * m + j] -
+                      l1[n - 2] * F[(size_t)(n - 3) * m + j];
+    const double fb = Fb[j] - u1[n - 1] * F[j] - u2[n - 1] * F[m + j] -
+                      l2[n - 1] * F[(size_t)(n - 3) * m + j];
+    Fa[j] = (l0[n - 1] * fa - u1[n - 2] * fb) / det;
+    Fb[j] = (l0[n - 2] * fb - l1[n - 1] * fa) / det;
+  }
+
+  // X[:-2] = E \ F[:-2] - (E \ K) X[-2:]
+  for (int i = 0; i < n - 2; i++) {
+    for (int j = 0; j < m; j++) { // apply to entire row
+      F[(size_t)i * m + j] -= k0[i] * Fa[j] + k1[i] * Fb[j];
+    }
+  }
+}
+
 void cyclic_pent_solve(
     const double *l2, double *l1, double *d0, double *u1, double *u2,
     double *k0, double *k1, double *f, const int n
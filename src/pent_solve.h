@@ -45,6 +45,28 @@ void pent_lu_solve(
     const double *u2, double *f, int n
 );
 
+/**
+ * Given an LU factorisation of a pentadiagonal, square, matrix A = LU, solves
+ * AX = F in place.
+ *
+ * As for `pent_lu_solve` but for multiple right-hand side vectors. Each step of
+ * the substitution is applied to an entire row of F, so the inner loops run
+ * over the right-hand sides and can be vectorised.
+ *
+ * @param l2 second lower diagonal of L
+ * @param l1 first lower diagonal of L
+ * @param l0 main diagonal of L
+ * @param u1 first upper diagonal of U
+ * @param u2 second upper diagonal of U
+ * @param F right-hand side vectors (n x m), overwritten with the solution
+ * @param n size of the matrix
+ * @param m number of right-hand side vectors
+ */
+void pent_lu_solve_multi(
+    const double *l2, const double *l1, const double *l0, const double *u1,
+    const double *u2, double *F, int n, int m
+);
+
 /**
  * Solves the system Ax = f in place, where A is a pentadiagonal.
  *
@@ -121,6 +143,29 @@ void cyclic_pent_lu_solve(
     const double *u2, const double *k0, const double *k1, double *f, int n
 );
 
+/**
+ * Given a partial LU factorisation of a cyclic, pentadiagonal, square matrix A
+ * = LU, solves AX = F in place.
+ *
+ * As for `cyclic_pent_lu_solve` but for multiple right-hand side vectors.
+ *
+ * @param l2 second lower diagonal of L
+ * @param l1 first lower diagonal of L
+ * @param l0 main diagonal of L
+ * @param u1 first upper diagonal of U
+ * @param u2 second upper diagonal of U
+ * @param k0 the first column of E^-1 K
+ * @param k1 the second column of E^-1 K
+ * @param F right-hand side vectors (n x m), overwritten with the solution
+ * @param n size of the matrix
+ * @param m number of right-hand side vectors
+ */
+void cyclic_pent_lu_solve_multi(
+    const double *l2, const double *l1, const double *l0, const double *u1,
+    const double *u2, const double *k0, const double *k1, double *F, int n,
+    int m
+);
+
 /**
  * Given a cyclic, pentadiagonal, square matrix A = LU, solves Ax = f in place.
  * Stores the partial LU factorisation of A in place so that it can be reused.
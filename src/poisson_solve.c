@@ -0,0 +1,294 @@
+/**
+ * This is the classic 'FACR(0)' fast Poisson solver: Fourier analysis in all
+ * but one direction followed by cyclic (or tridiagonal) reduction in the last.
+ * See e.g. Swarztrauber 1977, 'The methods of cyclic reduction, Fourier
+ * analysis and the FACR algorithm for the discrete solution of Poisson's
+ * equation on a rectangle' (https://doi.org/10.1137/1019071).
+ *
+ * In a periodic direction with n points the second-difference operator has
+ * eigenvalues -4/h^2 sin^2(pi k / n), and in a Dirichlet direction with n
+ * interior points it has eigenvalues -4/h^2 sin^2(pi k / (2(n + 1))).
+ */
+
+#include "poisson_solve.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "tri_solve.h"
+
+#define PI (3.14159265358979323846)
+
+/**
+ * Returns the workspace belonging to the calling thread.
+ */
+static double *thread_work(poisson_plan *plan) {
+#ifdef _OPENMP
+  return plan->work + (size_t)omp_get_thread_num() * (size_t)plan->nwork;
+#else
+  return plan->work;
+#endif
+}
+
+/**
+ * Returns the distance between consecutive entries in direction d.
+ */
+static int direction_stride(const poisson_plan *plan, const int d) {
+  int stride = 1;
+  for (int e = d + 1; e < plan->dim; e++) {
+    stride *= plan->n[e];
+  }
+  return stride;
+}
+
+static int poisson_plan_init(
+    poisson_plan *plan, const int dim, const int *n, const double *h,
+    const poisson_bc *bc
+) {
+  memset(plan, 0, sizeof(poisson_plan));
+  plan->dim = dim;
+  for (int d = 0; d < dim; d++) {
+    if (n[d] < 1 || (d == 0 && n[d] < 3)) {
+      return -1;
+    }
+    plan->n[d] = n[d];
+    plan->h[d] = h[d];
+    plan->bc[d] = bc[d];
+  }
+
+  // prepare the transforms and 1D eigenvalues for the transformed directions
+  int nwork = 5 * n[0]; // line solve: line, l, d, u, q
+  for (int d = 1; d < dim; d++) {
+    const int nd = n[d];
+    const double scale = 4.0 / (h[d] * h[d]);
+    int err;
+    int twork;
+    plan->lam[d] = malloc(nd * sizeof(double));
+    if (!plan->lam[d]) {
+      poisson_plan_free(plan);
+      return -1;
+    }
+
+    if (bc[d] == POISSON_PERIODIC) {
+      err = rfft_plan_init(&plan->rfft[d], nd);
+      twork = plan->rfft[d].nwork;
+      for (int j = 0; j < nd; j++) {
+        const double s = sin(PI * ((j + 1) / 2) / nd); // half-complex order
+        plan->lam[d][j] = -scale * s * s;
+      }
+    } else {
+      err = dst_plan_init(&plan->dst[d], nd);
+      twork = plan->dst[d].nwork;
+      for (int j = 0; j < nd; j++) {
+        const double s = sin(PI * (j + 1) / (2.0 * (nd + 1)));
+        plan->lam[d][j] = -scale * s * s;
+      }
+    }
+    if (err != 0) {
+      poisson_plan_free(plan);
+      return -1;
+    }
+
+    if (nd + twork > nwork) {
+      nwork = nd + twork; // transform: line plus transform workspace
+    }
+  }
+
+#ifdef _OPENMP
+  plan->nthreads = omp_get_max_threads();
+#else
+  plan->nthreads = 1;
+#endif
+  plan->nwork = nwork;
+  plan->work = malloc((size_t)plan->nthreads * (size_t)nwork * sizeof(double));
+  if (!plan->work) {
+    poisson_plan_free(plan);
+    return -1;
+  }
+
+  return 0;
+}
+
+/**
+ * Transforms every line of the grid along direction d, which must not be the
+ * first direction.
+ */
+static void transform(
+    poisson_plan *plan, double *f, const int d, const int inverse
+) {
+  int total = 1;
+  for (int e = 0; e < plan->dim; e++) {
+    total *= plan->n[e];
+  }
+  const int nd = plan->n[d];
+  const int stride = direction_stride(plan, d);
+  const int nlines = total / nd;
+  const double dst_scale = 2.0 / (nd + 1);
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(plan->nthreads)
+#endif
+  {
+    double *line = thread_work(plan);
+    double *work = line + nd;
+
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+    for (int l = 0; l < nlines; l++) {
+      // the line starts at the lth position not in direction d
+      double *fl = f + (size_t)(l / stride) * nd * stride + (l % stride);
+      for (int j = 0; j < nd; j++) {
+        line[j] = fl[(size_t)j * stride];
+      }
+
+      if (plan->bc[d] == POISSON_PERIODIC) {
+        if (inverse) {
+          rfft_inverse(&plan->rfft[d], line, work);
+        } else {
+          rfft_forward(&plan->rfft[d], line, work);
+        }
+      } else {
+        dst1(&plan->dst[d], line, work);
+        if (inverse) {
+          for (int j = 0; j < nd; j++) {
+            line[j] *= dst_scale;
+          }
+        }
+      }
+
+      for (int j = 0; j < nd; j++) {
+        fl[(size_t)j * stride] = line[j];
+      }
+    }
+  }
+}
+
+/**
+ * Solves the tridiagonal system along the first direction for every mode.
+ */
+static void line_solve(poisson_plan *plan, double *f) {
+  const int n0 = plan->n[0];
+  const int nmodes = direction_stride(plan, 0);
+  const int n2 = (plan->dim == 3) ? plan->n[2] : 1;
+  const double ih2 = 1.0 / (plan->h[0] * plan->h[0]);
+
+  // the (0, 0) mode is singular if every direction is periodic
+  int singular = 1;
+  for (int d = 0; d < plan->dim; d++) {
+    singular = singular && plan->bc[d] == POISSON_PERIODIC;
+  }
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(plan->nthreads)
+#endif
+  {
+    double *line = thread_work(plan);
+    double *l = line + n0;
+    double *d = l + n0;
+    double *u = d + n0;
+    double *q = u + n0;
+
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+    for (int mode = 0; mode < nmodes; mode++) {
+      // the eigenvalue of the transformed directions for this mode
+      double lam = plan->lam[1][mode / n2];
+      if (plan->dim == 3) {
+        lam += plan->lam[2][mode % n2];
+      }
+
+      for (int i = 0; i < n0; i++) {
+        line[i] = f[(size_t)i * nmodes + mode];
+        l[i] = ih2;
+        d[i] = -2.0 * ih2 + lam;
+        u[i] = ih2;
+      }
+
+      if (plan->bc[0] == POISSON_DIRICHLET) {
+        tri_solve(l, d, u, line, n0);
+      } else if (mode != 0 || !singular) {
+        cyclic_tri_solve(l, d, u, q, line, n0);
+      } else {
+        // remove the mean so that the system is consistent, then pin the final
+        // point to zero, which leaves a nonsingular (Dirichlet) system
+        double mean = 0.0;
+        for (int i = 0; i < n0; i++) {
+          mean += line[i];
+        }
+        mean /= n0;
+        for (int i = 0; i < n0; i++) {
+          line[i] -= mean;
+        }
+        tri_solve(l, d, u, line, n0 - 1);
+        line[n0 - 1] = 0.0;
+
+        // then shift the solution to have zero mean
+        mean = 0.0;
+        for (int i = 0; i < n0; i++) {
+          mean += line[i];
+        }
+        mean /= n0;
+        for (int i = 0; i < n0; i++) {
+          line[i] -= mean;
+        }
+      }
+
+      for (int i = 0; i < n0; i++) {
+        f[(size_t)i * nmodes + mode] = line[i];
+      }
+    }
+  }
+}
+
+int poisson_plan_init_2d(
+    poisson_plan *plan, const int n0, const int n1, const double h0,
+    const double h1, const poisson_bc bc0, const poisson_bc bc1
+) {
+  const int n[2] = {n0, n1};
+  const double h[2] = {h0, h1};
+  const poisson_bc bc[2] = {bc0, bc1};
+  return poisson_plan_init(plan, 2, n, h, bc);
+}
+
+int poisson_plan_init_3d(
+    poisson_plan *plan, const int n0, const int n1, const int n2,
+    const double h0, const double h1, const double h2, const poisson_bc bc0,
+    const poisson_bc bc1, const poisson_bc bc2
+) {
+  const int n[3] = {n0, n1, n2};
+  const double h[3] = {h0, h1, h2};
+  const poisson_bc bc[3] = {bc0, bc1, bc2};
+  return poisson_plan_init(plan, 3, n, h, bc);
+}
+
+void poisson_plan_free(poisson_plan *plan) {
+  for (int d = 0; d < 3; d++) {
+    rfft_plan_free(&plan->rfft[d]);
+    dst_plan_free(&plan->dst[d]);
+    free(plan->lam[d]);
+  }
+  free(plan->work);
+  memset(plan, 0, sizeof(poisson_plan));
+}
+
+void poisson_solve(poisson_plan *plan, double *f) {
+  // diagonalise every direction except the first
+  for (int d = plan->dim - 1; d >= 1; d--) {
+    transform(plan, f, d, 0);
+  }
+
+  // solve the decoupled tridiagonal systems
+  line_solve(plan, f);
+
+  // transform back
+  for (int d = 1; d < plan->dim; d++) {
+    transform(plan, f, d, 1);
+  }
+}
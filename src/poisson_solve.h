@@ -0,0 +1,105 @@
+#ifndef POISSON_SOLVE_H
+#define POISSON_SOLVE_H
+
+#include "fft.h"
+
+/**
+ * Boundary conditions for one direction of a Poisson problem.
+ *
+ * Periodic: n grid points x[j] = j h, where the domain has length n h.
+ * Dirichlet: n interior grid points x[j] = (j + 1) h, where the domain has
+ * length (n + 1) h and the solution is zero on the boundary.
+ */
+typedef enum { POISSON_PERIODIC, POISSON_DIRICHLET } poisson_bc;
+
+/**
+ * Plan for the fast direct solution of the discrete Poisson equation
+ *   (u[i-1] - 2u[i] + u[i+1]) / h^2 + ... = f
+ * on a rectangular 2D or 3D grid, using the standard second-order stencil in
+ * each direction.
+ *
+ * The grid is stored in row-major order, so in 2D f[i * n1 + j] is the value at
+ * (i, j) and in 3D f[(i * n1 + j) * n2 + k] is the value at (i, j, k).
+ *
+ * Every direction except the first is diagonalised with a real FFT (periodic)
+ * or DST-I (Dirichlet), which decouples the problem into one tridiagonal system
+ * along the first direction for each mode. These are solved with `tri_solve`
+ * (Dirichlet) or `cyclic_tri_solve` (periodic). The whole solve takes
+ * O(N log N) steps, where N is the total number of grid points, and the
+ * transforms and line solves are performed in parallel if OpenMP is enabled.
+ *
+ * If every direction is periodic the problem is singular: the mean of f is
+ * ignored and the solution returned has zero mean.
+ *
+ * The plan owns a workspace for each thread, so it should not be used by two
+ * solves at once.
+ */
+typedef struct {
+  int dim; // number of dimensions (2 or 3)
+  int n[3]; // number of grid points in each direction
+  double h[3]; // grid spacing in each direction
+  poisson_bc bc[3]; // boundary conditions in each direction
+  rfft_plan rfft[3]; // transforms for the periodic directions (not the first)
+  dst_plan dst[3]; // transforms for the Dirichlet directions (not the first)
+  double *lam[3]; // 1D eigenvalues, in transformed order, for each direction
+  double *work; // per-thread workspace
+  int nwork; // size of the workspace for each thread
+  int nthreads; // number of per-thread workspaces
+} poisson_plan;
+
+/**
+ * Prepares a plan to solve the 2D Poisson equation on an n0 x n1 grid.
+ *
+ * @param plan plan to initialise, must be freed with poisson_plan_free
+ * @param n0 number of grid points in the first direction (at least 3)
+ * @param n1 number of grid points in the second direction
+ * @param h0 grid spacing in the first direction
+ * @param h1 grid spacing in the second direction
+ * @param bc0 boundary conditions in the first direction
+ * @param bc1 boundary conditions in the second direction
+ * @return 0 on success, -1 on error
+ */
+int poisson_plan_init_2d(
+    poisson_plan *plan, int n0, int n1, double h0, double h1, poisson_bc bc0,
+    poisson_bc bc1
+);
+
+/**
+ * Prepares a plan to solve the 3D Poisson equation on an n0 x n1 x n2 grid.
+ *
+ * @param plan plan to initialise, must be freed with poisson_plan_free
+ * @param n0 number of grid points in the first direction (at least 3)
+ * @param n1 number of grid points in the second direction
+ * @param n2 number of grid points in the third direction
+ * @param h0 grid spacing in the first direction
+ * @param h1 grid spacing in the second direction
+ * @param h2 grid spacing in the third direction
+ * @param bc0 boundary conditions in the first direction
+ * @param bc1 boundary conditions in the second direction
+ * @param bc2 boundary conditions in the third direction
+ * @return 0 on success, -1 on error
+ */
+int poisson_plan_init_3d(
+    poisson_plan *plan, int n0, int n1, int n2, double h0, double h1,
+    double h2, poisson_bc bc0, poisson_bc bc1, poisson_bc bc2
+);
+
+/**
+ * Frees the memory held by a Poisson plan.
+ *
+ * @param plan plan to free
+ */
+void poisson_plan_free(poisson_plan *plan);
+
+/**
+ * Solves the discrete Poisson equation in place.
+ *
+ * The plan is not const since its workspace is overwritten, so two solves with
+ * the same plan must not run at once.
+ *
+ * @param plan Poisson plan
+ * @param f right-hand side on the grid, overwritten with the solution
+ */
+void poisson_solve(poisson_plan *plan, double *f);
+
+#endif // POISSON_SOLVE_H
@@ -1,5 +1,7 @@
 #include "testing.h"
 
+#include <stdint.h>
+
 #include "src/alloc.h"
 
 int main(void) {
@@ -48,5 +50,54 @@ int main(void) {
     free_2d(A);
   }
 
+  /* check aligned allocation gives aligned, padded rows */
+  SUBTEST("aligned") {
+    const int widths[4] = {1, 7, 256, 512};
+    for (int w = 0; w < 4; w++) {
+      const int n = 5;
+      const int m = widths[w];
+      int stride;
+      double **A = calloc_d2d_aligned(n, m, &stride);
+      REQUIRE_BARRIER(A != NULL);
+      REQUIRE(stride >= m);
+      REQUIRE(stride * sizeof(double) % ALLOC_ALIGN == 0);
+      REQUIRE(stride * sizeof(double) % 2048 != 0);
+
+      for (int i = 0; i < n; i++) {
+        REQUIRE((uintptr_t)A[i] % ALLOC_ALIGN == 0);
+        REQUIRE(A[i] == A[0] + i * stride);
+        for (int j = 0; j < m; j++) {
+          REQUIRE(A[i][j] == 0.0);
+        }
+      }
+
+      free_2d(A);
+    }
+  }
+
+  /* check large allocation with each kind of page */
+  SUBTEST("large") {
+    const int flags[3] = {0, ALLOC_HUGE_PAGES, ALLOC_HUGETLB};
+    for (int k = 0; k < 3; k++) {
+      const int n = 300;
+      const int m = 700;
+      double **A = calloc_d2d_large(n, m, flags[k]);
+      REQUIRE_BARRIER(A != NULL);
+      REQUIRE((uintptr_t)A[0] % ALLOC_ALIGN == 0);
+
+      for (int i = 0; i < n; i++) {
+        for (int j = 0; j < m; j++) {
+          REQUIRE(A[i][j] == 0.0);
+          A[i][j] = i * m + j;
+        }
+      }
+      for (int i = 0; i < n * m; i++) {
+        REQUIRE(A[0][i] == i);
+      }
+
+      free_2d_large(A);
+    }
+  }
+
   END_TEST();
 }
@@ -0,0 +1,147 @@
+#include "testing.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "src/alloc.h"
+#include "src/arena.h"
+#include "src/block_solve.h"
+#include "src/lu_solve.h"
+
+int main(void) {
+  START_TEST("arena");
+
+  /* check allocations are aligned and bounded by the arena size */
+  SUBTEST("arena alloc") {
+    arena a;
+    REQUIRE_BARRIER(arena_init(&a, 1000) == 0);
+
+    double *x = arena_alloc_d(&a, 3);
+    double *y = arena_alloc_d(&a, 5);
+    REQUIRE_BARRIER(x != NULL && y != NULL);
+    REQUIRE((uintptr_t)x % ALLOC_ALIGN == 0);
+    REQUIRE((uintptr_t)y % ALLOC_ALIGN == 0);
+    REQUIRE(y >= x + 3);
+    for (int i = 0; i < 5; i++) {
+      y[i] = i; // should not overflow
+    }
+
+    // too large for what remains of the arena
+    REQUIRE(arena_alloc(&a, a.size) == NULL);
+
+    // resetting makes all the memory available again
+    arena_reset(&a);
+    REQUIRE(arena_alloc(&a, a.size) != NULL);
+    REQUIRE(a.peak == a.size);
+
+    arena_free(&a);
+  }
+
+  /* check that releasing to a mark reuses the same memory */
+  SUBTEST("arena mark") {
+    arena a;
+    REQUIRE_BARRIER(arena_init(&a, 4096) == 0);
+
+    double *x = arena_alloc_d(&a, 10);
+    const size_t mark = arena_mark(&a);
+    double *y = arena_alloc_d(&a, 20);
+    arena_release(&a, mark);
+    double *z = arena_alloc_d(&a, 20);
+    REQUIRE(z == y);
+    REQUIRE(x != z);
+
+    arena_free(&a);
+  }
+
+  /* check the thread arena is only reallocated when it grows */
+  SUBTEST("thread arena") {
+    arena *a = arena_thread(1000);
+    REQUIRE_BARRIER(a != NULL);
+    unsigned char *mem = a->mem;
+    REQUIRE(a->size >= 1000);
+    REQUIRE(arena_alloc(a, 1000) != NULL);
+
+    // a smaller request reuses the same memory, and resets it
+    a = arena_thread(500);
+    REQUIRE(a->mem == mem);
+    REQUIRE(a->used == 0);
+
+    // a larger request grows the arena
+    a = arena_thread(10 * a->size);
+    REQUIRE_BARRIER(a != NULL);
+    REQUIRE(a->used == 0);
+
+    arena_thread_free();
+  }
+
+  /* check repeated block solves with workspace taken from the thread arena */
+  SUBTEST("block solve from arena") {
+    const int n = 6;
+    const int m = 4;
+    const int nm = n + m;
+    double **R = malloc_d2d(nm, nm);
+    double **RR = malloc_d2d(nm, nm);
+    int *piv = malloc(nm * sizeof(int));
+    double *f = malloc(nm * sizeof(double));
+    double *x = malloc(nm * sizeof(double));
+    double **A = malloc_d2d(n, n);
+    double **B = malloc_d2d(n, m);
+    double **C = malloc_d2d(m, n);
+    double **D = malloc_d2d(m, m);
+
+    for (int i = 0; i < nm; i++) {
+      for (int j = 0; j < nm; j++) {
+        R[i][j] = (double)(rand() % 1000 - 500) / 100.0;
+      }
+    }
+
+    const size_t nwork = block_solve_work_size(n, m);
+    const size_t size = (nwork + (size_t)nm) * sizeof(double) + ALLOC_ALIGN;
+    for (int t = 0; t < 3; t++) {
+      for (int i = 0; i < nm; i++) {
+        f[i] = (double)(rand() % 1000 - 500) / 100.0;
+        x[i] = f[i];
+      }
+      memcpy(RR[0], R[0], nm * nm * sizeof(double));
+      int err = lu_solve(RR[0], f, piv, nm);
+      REQUIRE_BARRIER(err == 0);
+
+      // the blocks are overwritten by the solve, so copy them in every time
+      for (int i = 0; i < n; i++) {
+        memcpy(A[i], R[i], n * sizeof(double));
+        memcpy(B[i], R[i] + n, m * sizeof(double));
+      }
+      for (int i = 0; i < m; i++) {
+        memcpy(C[i], R[n + i], n * sizeof(double));
+        memcpy(D[i], R[n + i] + n, m * sizeof(double));
+      }
+
+      arena *ar = arena_thread(size);
+      REQUIRE_BARRIER(ar != NULL);
+      double *work = arena_alloc_d(ar, nwork);
+      REQUIRE_BARRIER(work != NULL);
+      err = block_solve(
+          A[0], B[0], C[0], D[0], x, x + n, piv, piv + n, work, n, m
+      );
+      REQUIRE_BARRIER(err == 0);
+
+      for (int i = 0; i < nm; i++) {
+        REQUIRE_CLOSE(f[i], x[i], 1e-10);
+      }
+    }
+
+    arena_thread_free();
+    free_2d(R);
+    free_2d(RR);
+    free(piv);
+    free(f);
+    free(x);
+    free_2d(A);
+    free_2d(B);
+    free_2d(C);
+    free_2d(D);
+  }
+
+  END_TEST();
+}
@@ -0,0 +1,176 @@
+#include "testing.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "src/alloc.h"
+#include "src/band_matvec.h"
+
+/**
+ * Set the elements of the full banded matrix A from its 2w+1 diagonals. If
+ * cyclic, the diagonals wrap around the corners of the matrix.
+ */
+static void
+band_to_full(double **A, double **diag, int w, int n, int cyclic) {
+  memset(A[0], 0, n * n * sizeof(double));
+  for (int i = 0; i < n; i++) {
+    for (int k = -w; k <= w; k++) {
+      const int j = i + k;
+      if (j >= 0 && j < n) {
+        A[i][j] = diag[k + w][i];
+      } else if (cyclic) {
+        A[i][(j + n) % n] = diag[k + w][i];
+      }
+    }
+  }
+}
+
+/**
+ * Compute the ith entry of A x directly.
+ */
+static double full_row(double **A, const double *x, int i, int n) {
+  double Axi = 0.0;
+  for (int j = 0; j < n; j++) {
+    Axi += A[i][j] * x[j];
+  }
+  return Axi;
+}
+
+int main(void) {
+  START_TEST("band matvec");
+
+  const int n = 9;
+  double **diag = malloc_d2d(5, n);
+  double **A = malloc_d2d(n, n);
+  double *x = malloc(n * sizeof(double));
+  double *y = malloc(n * sizeof(double));
+  double *y0 = malloc(n * sizeof(double));
+  double *f = malloc(n * sizeof(double));
+  for (int k = 0; k < 5; k++) {
+    for (int i = 0; i < n; i++) {
+      diag[k][i] = (double)(rand() % 1000 - 500) / 100.0;
+    }
+  }
+  for (int i = 0; i < n; i++) {
+    x[i] = (double)(rand() % 1000 - 500) / 100.0;
+    y0[i] = (double)(rand() % 1000 - 500) / 100.0;
+    f[i] = (double)(rand() % 1000 - 500) / 100.0;
+  }
+  const double alpha = 0.7;
+  const double beta = -1.3;
+
+  /* check tridiagonal products */
+  SUBTEST("tri matvec") {
+    double **t = diag + 1; // use the central three diagonals
+    for (int cyclic = 0; cyclic < 2; cyclic++) {
+      band_to_full(A, t, 1, n, cyclic);
+
+      // y = A x
+      if (cyclic) {
+        cyclic_tri_matvec(t[0], t[1], t[2], x, y, n);
+      } else {
+        tri_matvec(t[0], t[1], t[2], x, y, n);
+      }
+      for (int i = 0; i < n; i++) {
+        REQUIRE_CLOSE(y[i], full_row(A, x, i, n), 1e-10);
+      }
+
+      // y = alpha A x + beta y
+      memcpy(y, y0, n * sizeof(double));
+      if (cyclic) {
+        cyclic_tri_gemv(alpha, t[0], t[1], t[2], x, beta, y, n);
+      } else {
+        tri_gemv(alpha, t[0], t[1], t[2], x, beta, y, n);
+      }
+      for (int i = 0; i < n; i++) {
+        REQUIRE_CLOSE(y[i], alpha * full_row(A, x, i, n) + beta * y0[i], 1e-10);
+      }
+
+      // with beta = 0, y is overwritten even if it holds NaNs
+      for (int i = 0; i < n; i++) {
+        y[i] = NAN;
+      }
+      if (cyclic) {
+        cyclic_tri_gemv(alpha, t[0], t[1], t[2], x, 0.0, y, n);
+      } else {
+        tri_gemv(alpha, t[0], t[1], t[2], x, 0.0, y, n);
+      }
+      for (int i = 0; i < n; i++) {
+        REQUIRE(fabs(y[i] - alpha * full_row(A, x, i, n)) <= 1e-10); // not NaN
+      }
+
+      // r = f - A x
+      if (cyclic) {
+        cyclic_tri_residual(t[0], t[1], t[2], x, f, y, n);
+      } else {
+        tri_residual(t[0], t[1], t[2], x, f, y, n);
+      }
+      for (int i = 0; i < n; i++) {
+        REQUIRE_CLOSE(y[i], f[i] - full_row(A, x, i, n), 1e-10);
+      }
+    }
+  }
+
+  /* check pentadiagonal products */
+  SUBTEST("pent matvec") {
+    double **p = diag;
+    for (int cyclic = 0; cyclic < 2; cyclic++) {
+      band_to_full(A, p, 2, n, cyclic);
+
+      // y = A x
+      if (cyclic) {
+        cyclic_pent_matvec(p[0], p[1], p[2], p[3], p[4], x, y, n);
+      } else {
+        pent_matvec(p[0], p[1], p[2], p[3], p[4], x, y, n);
+      }
+      for (int i = 0; i < n; i++) {
+        REQUIRE_CLOSE(y[i], full_row(A, x, i, n), 1e-10);
+      }
+
+      // y = alpha A x + beta y
+      memcpy(y, y0, n * sizeof(double));
+      if (cyclic) {
+        cyclic_pent_gemv(alpha, p[0], p[1], p[2], p[3], p[4], x, beta, y, n);
+      } else {
+        pent_gemv(alpha, p[0], p[1], p[2], p[3], p[4], x, beta, y, n);
+      }
+      for (int i = 0; i < n; i++) {
+        REQUIRE_CLOSE(y[i], alpha * full_row(A, x, i, n) + beta * y0[i], 1e-10);
+      }
+
+      // with beta = 0, y is overwritten even if it holds NaNs
+      for (int i = 0; i < n; i++) {
+        y[i] = NAN;
+      }
+      if (cyclic) {
+        cyclic_pent_gemv(alpha, p[0], p[1], p[2], p[3], p[4], x, 0.0, y, n);
+      } else {
+        pent_gemv(alpha, p[0], p[1], p[2], p[3], p[4], x, 0.0, y, n);
+      }
+      for (int i = 0; i < n; i++) {
+        REQUIRE(fabs(y[i] - alpha * full_row(A, x, i, n)) <= 1e-10); // not NaN
+      }
+
+      // r = f - A x, computed in place
+      memcpy(y, f, n * sizeof(double));
+      if (cyclic) {
+        cyclic_pent_residual(p[0], p[1], p[2], p[3], p[4], x, y, y, n);
+      } else {
+        pent_residual(p[0], p[1], p[2], p[3], p[4], x, y, y, n);
+      }
+      for (int i = 0; i < n; i++) {
+        REQUIRE_CLOSE(y[i], f[i] - full_row(A, x, i, n), 1e-10);
+      }
+    }
+  }
+
+  free_2d(diag);
+  free_2d(A);
+  free(x);
+  free(y);
+  free(y0);
+  free(f);
+
+  END_TEST();
+}
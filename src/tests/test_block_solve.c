@@ -1,11 +1,48 @@
 #include "testing.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "src/alloc.h"
 #include "src/block_solve.h"
 #include "src/lu_solve.h"
 
+/**
+ * Fills the off-diagonal blocks and the lower right block of the full matrix R
+ * and the rhs f with random values, copying them into B, C, D, a and b.
+ */
+static void fill_blocks(
+    double **R, double *f, double *B, double *C, double *D, double *a,
+    double *b, int n, int m
+) {
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < m; j++) {
+      R[i][n + j] = (double)(rand() % 1000 - 500) / 100.0;
+      B[i * m + j] = R[i][n + j];
+    }
+  }
+  for (int i = 0; i < m; i++) {
+    for (int j = 0; j < n; j++) {
+      R[n + i][j] = (double)(rand() % 1000 - 500) / 100.0;
+      C[i * n + j] = R[n + i][j];
+    }
+  }
+  for (int i = 0; i < m; i++) {
+    for (int j = 0; j < m; j++) {
+      R[n + i][n + j] = (double)(rand() % 1000 - 500) / 100.0;
+      D[i * m + j] = R[n + i][n + j];
+    }
+  }
+  for (int i = 0; i < n; i++) {
+    f[i] = (double)(rand() % 1000 - 500) / 100.0;
+    a[i] = f[i];
+  }
+  for (int i = 0; i < m; i++) {
+    f[n + i] = (double)(rand() % 1000 - 500) / 100.0;
+    b[i] = f[n + i];
+  }
+}
+
 int main(void) {
   START_TEST("block solve");
 
@@ -176,5 +213,494 @@ int main(void) {
     free(work);
   }
 
+  SUBTEST("block solve with tri") {
+    const int n = 8;
+    const int m = 3;
+    const int nm = n + m;
+    double **R = calloc_d2d(nm, nm);
+    int *piv = malloc(nm * sizeof(int));
+    double *f = malloc(nm * sizeof(double));
+    double **d = malloc_d2d(3, n);
+    double *B = malloc(n * m * sizeof(double));
+    double *C = malloc(m * n * sizeof(double));
+    double *D = malloc(m * m * sizeof(double));
+    double *a = malloc(n * sizeof(double));
+    double *b = malloc(m * sizeof(double));
+
+    // fill A with random, diagonally dominant, values
+    for (int i = 0; i < n; i++) {
+      for (int k = 0; k < 3; k++) {
+        d[k][i] = (double)(rand() % 1000 - 500) / 100.0;
+      }
+      d[1][i] = 1.1 * (fabs(d[0][i]) + fabs(d[1][i]) + fabs(d[2][i]));
+      for (int k = 0; k < 3; k++) {
+        const int j = i + k - 1;
+        if (j >= 0 && j < n) {
+          R[i][j] = d[k][i];
+        }
+      }
+    }
+    fill_blocks(R, f, B, C, D, a, b, n, m);
+
+    int err = lu_solve(R[0], f, piv, nm);
+    REQUIRE_BARRIER(err == 0);
+
+    const size_t work_size = n * m + ((n > m) ? n : m);
+    double *work = malloc(work_size * sizeof(double));
+    block_sub_solver sa, ss;
+    block_sub_solver_tri(&sa, d[0], d[1], d[2]);
+    block_sub_solver_lu(&ss, D, piv);
+    err = block_solve_with(&sa, B, C, D, &ss, a, b, work, n, m);
+    REQUIRE_BARRIER(err == 0);
+
+    // check that the block solve and the normal solve match
+    for (int i = 0; i < n; i++) {
+      REQUIRE_CLOSE(f[i], a[i], 1e-10);
+    }
+    for (int i = 0; i < m; i++) {
+      REQUIRE_CLOSE(f[n + i], b[i], 1e-10);
+    }
+
+    free_2d(R);
+    free_2d(d);
+    free(piv);
+    free(f);
+    free(B);
+    free(C);
+    free(D);
+    free(a);
+    free(b);
+    free(work);
+  }
+
+  SUBTEST("block solve with cyclic pent") {
+    const int n = 9;
+    const int m = 4;
+    const int nm = n + m;
+    double **R = calloc_d2d(nm, nm);
+    int *piv = malloc(nm * sizeof(int));
+    double *f = malloc(nm * sizeof(double));
+    double **d = malloc_d2d(7, n);
+    double *B = malloc(n * m * sizeof(double));
+    double *C = malloc(m * n * sizeof(double));
+    double *D = malloc(m * m * sizeof(double));
+    double *a = malloc(n * sizeof(double));
+    double *b = malloc(m * sizeof(double));
+
+    // fill A with random, diagonally dominant, values
+    for (int i = 0; i < n; i++) {
+      double mag = 0.0;
+      for (int k = 0; k < 5; k++) {
+        d[k][i] = (double)(rand() % 1000 - 500) / 100.0;
+        mag += fabs(d[k][i]);
+      }
+      d[2][i] = 1.1 * mag;
+      for (int k = 0; k < 5; k++) {
+        R[i][(i + k - 2 + n) % n] = d[k][i];
+      }
+    }
+    fill_blocks(R, f, B, C, D, a, b, n, m);
+
+    int err = lu_solve(R[0], f, piv, nm);
+    REQUIRE_BARRIER(err == 0);
+
+    const size_t work_size = n * m + ((n > m) ? n : m);
+    double *work = malloc(work_size * sizeof(double));
+    block_sub_solver sa, ss;
+    block_sub_solver_cyclic_pent(&sa, d[0], d[1], d[2], d[3], d[4], d[5], d[6]);
+    block_sub_solver_lu(&ss, D, piv);
+    err = block_solve_with(&sa, B, C, D, &ss, a, b, work, n, m);
+    REQUIRE_BARRIER(err == 0);
+
+    // check that the block solve and the normal solve match
+    for (int i = 0; i < n; i++) {
+      REQUIRE_CLOSE(f[i], a[i], 1e-10);
+    }
+    for (int i = 0; i < m; i++) {
+      REQUIRE_CLOSE(f[n + i], b[i], 1e-10);
+    }
+
+    free_2d(R);
+    free_2d(d);
+    free(piv);
+    free(f);
+    free(B);
+    free(C);
+    free(D);
+    free(a);
+    free(b);
+    free(work);
+  }
+
+  SUBTEST("block factorise") {
+    const int n = 6;
+    const int m = 4;
+    const int nm = n + m;
+    const int k = 3;
+    double **R = malloc_d2d(nm, nm);
+    double **LU = malloc_d2d(nm, nm);
+    int *piv = malloc(nm * sizeof(int));
+    double *f = malloc(nm * sizeof(double));
+    double *A = malloc(n * n * sizeof(double));
+    double *B = malloc(n * m * sizeof(double));
+    double *C = malloc(m * n * sizeof(double));
+    double *D = malloc(m * m * sizeof(double));
+    double *AB = malloc(n * m * sizeof(double));
+    double *a = malloc(n * sizeof(double));
+    double *b = malloc(m * sizeof(double));
+    double **F = malloc_d2d(nm, k);
+    double **FF = malloc_d2d(nm, k);
+    int *pivn = malloc(n * sizeof(int));
+    int *pivm = malloc(m * sizeof(int));
+
+    // fill the matrix with random values
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) {
+        R[i][j] = (double)(rand() % 1000 - 500) / 100.0;
+        A[i * n + j] = R[i][j];
+      }
+    }
+    fill_blocks(R, f, B, C, D, a, b, n, m);
+    memcpy(LU[0], R[0], nm * nm * sizeof(double));
+
+    int err = lu_factorise(LU[0], piv, nm);
+    REQUIRE_BARRIER(err == 0);
+    err = block_factorise(A, B, C, D, AB, pivn, pivm, n, m);
+    REQUIRE_BARRIER(err == 0);
+
+    // perform several solves reusing the factorisation
+    for (int r = 0; r < 2; r++) {
+      for (int i = 0; i < n; i++) {
+        f[i] = (double)(rand() % 1000 - 500) / 100.0;
+        a[i] = f[i];
+      }
+      for (int i = 0; i < m; i++) {
+        f[n + i] = (double)(rand() % 1000 - 500) / 100.0;
+        b[i] = f[n + i];
+      }
+      lu_solve_factorised(LU[0], piv, f, nm);
+      block_solve_factorised(A, AB, C, D, a, b, pivn, pivm, n, m);
+
+      // check that the block solve and the normal solve match
+      for (int i = 0; i < n; i++) {
+        REQUIRE_CLOSE(f[i], a[i], 1e-10);
+      }
+      for (int i = 0; i < m; i++) {
+        REQUIRE_CLOSE(f[n + i], b[i], 1e-10);
+      }
+    }
+
+    // solve for multiple rhs vectors at once, F is split into its upper n rows
+    // and lower m rows
+    for (int i = 0; i < nm; i++) {
+      for (int j = 0; j < k; j++) {
+        F[i][j] = (double)(rand() % 1000 - 500) / 100.0;
+        FF[i][j] = F[i][j]; // copy the original rhs
+      }
+    }
+    block_solve_factorised_multi(A, AB, C, D, F[0], F[n], pivn, pivm, n, m, k);
+
+    // check that RX = F
+    for (int i = 0; i < nm; i++) {
+      for (int j = 0; j < k; j++) {
+        double RXij = 0.0;
+        for (int l = 0; l < nm; l++) {
+          RXij += R[i][l] * F[l][j];
+        }
+        REQUIRE_CLOSE(RXij, FF[i][j], 1e-10);
+      }
+    }
+
+    free_2d(R);
+    free_2d(LU);
+    free_2d(F);
+    free_2d(FF);
+    free(piv);
+    free(pivn);
+    free(pivm);
+    free(f);
+    free(A);
+    free(B);
+    free(C);
+    free(D);
+    free(AB);
+    free(a);
+    free(b);
+  }
+
+  SUBTEST("block solve panelled") {
+    const int n = 7;
+    const int m = 10;
+    const int nm = n + m;
+    const int p = 3; // does not divide m
+    double **R = malloc_d2d(nm, nm);
+    int *piv = malloc(nm * sizeof(int));
+    double *f = malloc(nm * sizeof(double));
+    double *A = malloc(n * n * sizeof(double));
+    double *B = malloc(n * m * sizeof(double));
+    double *C = malloc(m * n * sizeof(double));
+    double *D = malloc(m * m * sizeof(double));
+    double *a = malloc(n * sizeof(double));
+    double *b = malloc(m * sizeof(double));
+
+    // fill the matrix with random values
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) {
+        R[i][j] = (double)(rand() % 1000 - 500) / 100.0;
+        A[i * n + j] = R[i][j];
+      }
+    }
+    fill_blocks(R, f, B, C, D, a, b, n, m);
+
+    int err = lu_solve(R[0], f, piv, nm);
+    REQUIRE_BARRIER(err == 0);
+
+    // more threads than panels, so some have no panel to solve
+    const int nthreads = 5;
+    const size_t work_size = block_solve_panelled_work_size(n, m, p, nthreads);
+    REQUIRE(work_size == (size_t)(nthreads * n * p + n));
+    double *work = malloc(work_size * sizeof(double));
+    int *pivn = piv;
+    int *pivm = piv + n;
+
+    // invalid panel widths and thread counts are rejected
+    REQUIRE(block_solve_panelled_work_size(n, m, 0, nthreads) == (size_t)n);
+    err = block_solve_panelled(A, B, C, D, a, b, pivn, pivm, work, n, m, 0, 1);
+    REQUIRE(err == -1);
+    err = block_solve_panelled(A, B, C, D, a, b, pivn, pivm, work, n, m, p, 0);
+    REQUIRE(err == -1);
+
+    err = block_solve_panelled(
+        A, B, C, D, a, b, pivn, pivm, work, n, m, p, nthreads
+    );
+    REQUIRE_BARRIER(err == 0);
+
+    // check that the block solve and the normal solve match
+    for (int i = 0; i < n; i++) {
+      REQUIRE_CLOSE(f[i], a[i], 1e-10);
+    }
+    for (int i = 0; i < m; i++) {
+      REQUIRE_CLOSE(f[n + i], b[i], 1e-10);
+    }
+
+    free_2d(R);
+    free(piv);
+    free(f);
+    free(A);
+    free(B);
+    free(C);
+    free(D);
+    free(a);
+    free(b);
+    free(work);
+  }
+
+  SUBTEST("block solve panelled threads") {
+    const int n = 40;
+    const int m = 64;
+    const int nm = n + m;
+    const int p = 2;
+    const int nthreads = 4;
+    double **R = malloc_d2d(nm, nm);
+    int *piv = malloc(2 * nm * sizeof(int));
+    double *f = malloc(nm * sizeof(double));
+    double *A = malloc(2 * n * n * sizeof(double));
+    double *B = malloc(2 * n * m * sizeof(double));
+    double *C = malloc(2 * m * n * sizeof(double));
+    double *D = malloc(2 * m * m * sizeof(double));
+    double *a = malloc(2 * n * sizeof(double));
+    double *b = malloc(2 * m * sizeof(double));
+
+    // fill the matrix with random values, so that A needs pivoting
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) {
+        A[i * n + j] = (double)(rand() % 1000 - 500) / 100.0;
+      }
+    }
+    fill_blocks(R, f, B, C, D, a, b, n, m);
+
+    // keep copies of the inputs for the reference solve
+    memcpy(A + n * n, A, n * n * sizeof(double));
+    memcpy(B + n * m, B, n * m * sizeof(double));
+    memcpy(C + m * n, C, m * n * sizeof(double));
+    memcpy(D + m * m, D, m * m * sizeof(double));
+    memcpy(a + n, a, n * sizeof(double));
+    memcpy(b + m, b, m * sizeof(double));
+
+    // many panels per thread, all solved with the same shared factorisation
+    double *work = malloc(
+        block_solve_panelled_work_size(n, m, p, nthreads) * sizeof(double)
+    );
+    int err = block_solve_panelled(
+        A, B, C, D, a, b, piv, piv + n, work, n, m, p, nthreads
+    );
+    REQUIRE_BARRIER(err == 0);
+    free(work);
+
+    work = malloc((n * m + ((n > m) ? n : m)) * sizeof(double));
+    int *pivr = piv + nm;
+    err = block_solve(
+        A + n * n, B + n * m, C + m * n, D + m * m, a + n, b + m, pivr,
+        pivr + n, work, n, m
+    );
+    REQUIRE_BARRIER(err == 0);
+
+    // the pivots are left intact, and the solutions match
+    for (int i = 0; i < nm; i++) {
+      REQUIRE(piv[i] == pivr[i]);
+    }
+    for (int i = 0; i < n; i++) {
+      REQUIRE_CLOSE(a[n + i], a[i], 1e-10);
+    }
+    for (int i = 0; i < m; i++) {
+      REQUIRE_CLOSE(b[m + i], b[i], 1e-10);
+    }
+
+    free_2d(R);
+    free(piv);
+    free(f);
+    free(A);
+    free(B);
+    free(C);
+    free(D);
+    free(a);
+    free(b);
+    free(work);
+  }
+
+  SUBTEST("block solve symmetric") {
+    const int n = 6;
+    const int m = 4;
+    const int nm = n + m;
+    double **R = malloc_d2d(nm, nm);
+    int *piv = malloc(nm * sizeof(int));
+    double *f = malloc(nm * sizeof(double));
+    double *A = malloc(n * n * sizeof(double));
+    double *B = malloc(n * m * sizeof(double));
+    double *D = malloc(m * m * sizeof(double));
+    double *a = malloc(n * sizeof(double));
+    double *b = malloc(m * sizeof(double));
+
+    // fill the lower triangles with random values, with A diagonally dominant
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j <= i; j++) {
+        R[i][j] = (double)(rand() % 1000 - 500) / 100.0;
+        R[j][i] = R[i][j];
+      }
+      R[i][i] = 10.0 * n;
+    }
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < m; j++) {
+        R[i][n + j] = (double)(rand() % 1000 - 500) / 100.0;
+        R[n + j][i] = R[i][n + j];
+        B[i * m + j] = R[i][n + j];
+      }
+    }
+    for (int i = 0; i < m; i++) {
+      for (int j = 0; j <= i; j++) {
+        R[n + i][n + j] = (double)(rand() % 1000 - 500) / 100.0;
+        R[n + j][n + i] = R[n + i][n + j];
+      }
+    }
+
+    // the upper triangles of A and D should never be read
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) {
+        A[i * n + j] = (j <= i) ? R[i][j] : 1e300;
+      }
+    }
+    for (int i = 0; i < m; i++) {
+      for (int j = 0; j < m; j++) {
+        D[i * m + j] = (j <= i) ? R[n + i][n + j] : 1e300;
+      }
+    }
+
+    // fill the rhs with random values
+    for (int i = 0; i < nm; i++) {
+      f[i] = (double)(rand() % 1000 - 500) / 100.0;
+    }
+    for (int i = 0; i < n; i++) {
+      a[i] = f[i];
+    }
+    for (int i = 0; i < m; i++) {
+      b[i] = f[n + i];
+    }
+
+    int err = lu_solve(R[0], f, piv, nm);
+    REQUIRE_BARRIER(err == 0);
+
+    double *work = malloc(n * m * sizeof(double));
+    err = block_solve_symmetric(A, B, D, a, b, work, n, m);
+    REQUIRE_BARRIER(err == 0);
+
+    // check that the block solve and the normal solve match
+    for (int i = 0; i < n; i++) {
+      REQUIRE_CLOSE(f[i], a[i], 1e-10);
+    }
+    for (int i = 0; i < m; i++) {
+      REQUIRE_CLOSE(f[n + i], b[i], 1e-10);
+    }
+
+    free_2d(R);
+    free(piv);
+    free(f);
+    free(A);
+    free(B);
+    free(D);
+    free(a);
+    free(b);
+    free(work);
+  }
+
+  /* check block solve with the blocks given as views of the full matrix */
+  SUBTEST("matrix block solve") {
+    const int n = 5;
+    const int m = 4;
+    const int nm = n + m;
+    double **R = malloc_d2d(nm, nm);
+    double **RR = malloc_d2d(nm, nm);
+    int *piv = malloc(nm * sizeof(int));
+    double *f = malloc(nm * sizeof(double));
+    double *x = malloc(nm * sizeof(double));
+
+    for (int i = 0; i < nm; i++) {
+      for (int j = 0; j < nm; j++) {
+        R[i][j] = (double)(rand() % 1000 - 500) / 100.0;
+        RR[i][j] = R[i][j];
+      }
+      f[i] = (double)(rand() % 1000 - 500) / 100.0;
+      x[i] = f[i];
+    }
+
+    int err = lu_solve(RR[0], f, piv, nm);
+    REQUIRE_BARRIER(err == 0);
+
+    matrix M, A, B, C, D;
+    matrix_wrap(&M, R[0], nm, nm, nm);
+    matrix_view(&A, &M, 0, 0, n, n);
+    matrix_view(&B, &M, 0, n, n, m);
+    matrix_view(&C, &M, n, 0, m, n);
+    matrix_view(&D, &M, n, n, m, m);
+
+    const size_t nwork = matrix_block_solve_work_size(&A, &B, &C, &D);
+    double *work = malloc(nwork * sizeof(double));
+    err = matrix_block_solve(&A, &B, &C, &D, x, x + n, piv, piv + n, work);
+    REQUIRE_BARRIER(err == 0);
+
+    for (int i = 0; i < nm; i++) {
+      REQUIRE_CLOSE(f[i], x[i], 1e-10);
+    }
+
+    // inconsistent sizes
+    REQUIRE(matrix_block_solve(&B, &B, &C, &D, x, x + n, piv, piv, work) == -1);
+
+    free_2d(R);
+    free_2d(RR);
+    free(piv);
+    free(f);
+    free(x);
+    free(work);
+  }
+
   END_TEST();
 }
@@ -0,0 +1,203 @@
+#include "testing.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "src/alloc.h"
+#include "src/block_tri_solve.h"
+
+/**
+ * Fills the blocks with random values, making the matrix block diagonally
+ * dominant, and sets the elements of the full matrix A from the blocks.
+ */
+static void fill_block_tri(
+    double **A, double *L, double *D, double *U, int n, int b, int cyclic
+) {
+  const int bb = b * b;
+  const int nb = n * b;
+  memset(A[0], 0, nb * nb * sizeof(double));
+
+  for (int i = 0; i < n; i++) {
+    for (int k = 0; k < bb; k++) {
+      L[i * bb + k] = (double)(rand() % 1000 - 500) / 100.0;
+      D[i * bb + k] = (double)(rand() % 1000 - 500) / 100.0;
+      U[i * bb + k] = (double)(rand() % 1000 - 500) / 100.0;
+    }
+    for (int r = 0; r < b; r++) {
+      D[i * bb + r * b + r] = 20.0 * b;
+    }
+
+    // copy the blocks that lie in the matrix into A
+    const int cols[3] = {i - 1, i, i + 1};
+    const double *blocks[3] = {L + i * bb, D + i * bb, U + i * bb};
+    for (int k = 0; k < 3; k++) {
+      int j = cols[k];
+      if (j < 0 || j >= n) {
+        if (!cyclic) {
+          continue;
+        }
+        j = (j + n) % n;
+      }
+      for (int r = 0; r < b; r++) {
+        for (int c = 0; c < b; c++) {
+          A[i * b + r][j * b + c] = blocks[k][r * b + c];
+        }
+      }
+    }
+  }
+}
+
+int main(void) {
+  START_TEST("block tri solve");
+
+  SUBTEST("block tri solve") {
+    const int n = 6;
+    const int b = 3;
+    const int nb = n * b;
+    const int m = 2;
+    double **A = malloc_d2d(nb, nb);
+    double *L = malloc(n * b * b * sizeof(double));
+    double *D = malloc(n * b * b * sizeof(double));
+    double *U = malloc(n * b * b * sizeof(double));
+    int *piv = malloc(nb * sizeof(int));
+    double *f = malloc(nb * sizeof(double));
+    double *ff = malloc(nb * sizeof(double));
+    double **F = malloc_d2d(nb, m);
+    double **FF = malloc_d2d(nb, m);
+
+    fill_block_tri(A, L, D, U, n, b, 0);
+    for (int i = 0; i < nb; i++) {
+      f[i] = (double)(rand() % 1000 - 500) / 100.0;
+      ff[i] = f[i]; // copy the original rhs
+    }
+
+    int err = block_tri_solve(L, D, U, piv, f, n, b);
+    REQUIRE_BARRIER(err == 0);
+
+    // check that Ax = f
+    for (int i = 0; i < nb; i++) {
+      // compute the ith entry of Ax
+      double Axi = 0.0;
+      for (int j = 0; j < nb; j++) {
+        Axi += A[i][j] * f[j];
+      }
+      REQUIRE_CLOSE(Axi, ff[i], 1e-10);
+    }
+
+    // perform a multiple rhs solve reusing the LU factorisation
+    for (int i = 0; i < nb; i++) {
+      for (int k = 0; k < m; k++) {
+        F[i][k] = (double)(rand() % 1000 - 500) / 100.0;
+        FF[i][k] = F[i][k]; // copy the original rhs
+      }
+    }
+    block_tri_lu_solve_multi(L, D, U, piv, F[0], n, b, m);
+
+    // check that AX = F
+    for (int i = 0; i < nb; i++) {
+      for (int k = 0; k < m; k++) {
+        // compute the (i, k)th entry of AX
+        double AXik = 0.0;
+        for (int j = 0; j < nb; j++) {
+          AXik += A[i][j] * F[j][k];
+        }
+        REQUIRE_CLOSE(AXik, FF[i][k], 1e-10);
+      }
+    }
+
+    free_2d(A);
+    free(L);
+    free(D);
+    free(U);
+    free(piv);
+    free(f);
+    free(ff);
+    free_2d(F);
+    free_2d(FF);
+  }
+
+  SUBTEST("cyclic block tri solve") {
+    const int n = 5;
+    const int b = 4;
+    const int nb = n * b;
+    double **A = malloc_d2d(nb, nb);
+    double *L = malloc(n * b * b * sizeof(double));
+    double *D = malloc(n * b * b * sizeof(double));
+    double *U = malloc(n * b * b * sizeof(double));
+    double *K = malloc((n - 1) * b * b * sizeof(double));
+    int *piv = malloc(nb * sizeof(int));
+    double *f = malloc(nb * sizeof(double));
+    double *ff = malloc(nb * sizeof(double));
+
+    fill_block_tri(A, L, D, U, n, b, 1);
+    for (int i = 0; i < nb; i++) {
+      f[i] = (double)(rand() % 1000 - 500) / 100.0;
+      ff[i] = f[i]; // copy the original rhs
+    }
+
+    int err = cyclic_block_tri_solve(L, D, U, K, piv, f, n, b);
+    REQUIRE_BARRIER(err == 0);
+
+    // check that Ax = f
+    for (int i = 0; i < nb; i++) {
+      // compute the ith entry of Ax
+      double Axi = 0.0;
+      for (int j = 0; j < nb; j++) {
+        Axi += A[i][j] * f[j];
+      }
+      REQUIRE_CLOSE(Axi, ff[i], 1e-10);
+    }
+
+    // perform another solve reusing the LU factorisation
+    for (int i = 0; i < nb; i++) {
+      f[i] = (double)(rand() % 1000 - 500) / 100.0;
+      ff[i] = f[i]; // copy the original rhs
+    }
+    cyclic_block_tri_lu_solve(L, D, U, K, piv, f, n, b);
+
+    // check that Ax = f
+    for (int i = 0; i < nb; i++) {
+      // compute the ith entry of Ax
+      double Axi = 0.0;
+      for (int j = 0; j < nb; j++) {
+        Axi += A[i][j] * f[j];
+      }
+      REQUIRE_CLOSE(Axi, ff[i], 1e-10);
+    }
+
+    free_2d(A);
+    free(L);
+    free(D);
+    free(U);
+    free(K);
+    free(piv);
+    free(f);
+    free(ff);
+  }
+
+  /* check the factorisation reports the row of a singular block */
+  SUBTEST("block tri singular") {
+    const int n = 4;
+    const int b = 2;
+    const int nb = n * b;
+    double **A = malloc_d2d(nb, nb);
+    double *L = malloc(n * b * b * sizeof(double));
+    double *D = malloc(n * b * b * sizeof(double));
+    double *U = malloc(n * b * b * sizeof(double));
+    int *piv = malloc(nb * sizeof(int));
+
+    fill_block_tri(A, L, D, U, n, b, 0);
+    memset(D, 0, b * b * sizeof(double)); // first block is singular
+
+    const int err = block_tri_lu_factorise(L, D, U, piv, n, b);
+    REQUIRE(err == 1);
+
+    free_2d(A);
+    free(L);
+    free(D);
+    free(U);
+    free(piv);
+  }
+
+  END_TEST();
+}
@@ -0,0 +1,162 @@
+#include "testing.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "src/alloc.h"
+#include "src/bordered_solve.h"
+
+/**
+ * Fills the diagonals of the core with random, diagonally dominant, values and
+ * the border with random values, setting the elements of the full matrix R.
+ */
+static void fill_bordered(
+    double **R, double **a, int w, double *K, double *H, double *C, int n,
+    int m
+) {
+  const int nm = n + m;
+  memset(R[0], 0, nm * nm * sizeof(double));
+
+  // banded core with 2w+1 diagonals
+  for (int i = 0; i < n; i++) {
+    double mag = 0.0;
+    for (int k = 0; k < 2 * w + 1; k++) {
+      a[k][i] = (double)(rand() % 1000 - 500) / 100.0;
+      mag += fabs(a[k][i]);
+    }
+    a[w][i] = 1.1 * mag;
+    for (int k = 0; k < 2 * w + 1; k++) {
+      const int j = i + k - w;
+      if (j >= 0 && j < n) {
+        R[i][j] = a[k][i];
+      }
+    }
+  }
+
+  // dense border
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < m; j++) {
+      K[i * m + j] = (double)(rand() % 1000 - 500) / 100.0;
+      R[i][n + j] = K[i * m + j];
+      H[j * n + i] = (double)(rand() % 1000 - 500) / 100.0;
+      R[n + j][i] = H[j * n + i];
+    }
+  }
+  for (int i = 0; i < m; i++) {
+    for (int j = 0; j < m; j++) {
+      C[i * m + j] = (double)(rand() % 1000 - 500) / 100.0;
+      R[n + i][n + j] = C[i * m + j];
+    }
+  }
+}
+
+int main(void) {
+  START_TEST("bordered solve");
+
+  SUBTEST("bordered tri solve") {
+    const int n = 9;
+    const int m = 3;
+    const int nm = n + m;
+    double **R = malloc_d2d(nm, nm);
+    double **a = malloc_d2d(3, n);
+    double *K = malloc(n * m * sizeof(double));
+    double *H = malloc(m * n * sizeof(double));
+    double *C = malloc(m * m * sizeof(double));
+    int *piv = malloc(m * sizeof(int));
+    double *f = malloc(nm * sizeof(double));
+    double *ff = malloc(nm * sizeof(double));
+
+    fill_bordered(R, a, 1, K, H, C, n, m);
+
+    // solve twice, the second time reusing the factorisation
+    for (int r = 0; r < 2; r++) {
+      for (int i = 0; i < nm; i++) {
+        f[i] = (double)(rand() % 1000 - 500) / 100.0;
+        ff[i] = f[i]; // copy the original rhs
+      }
+
+      if (r == 0) {
+        const int err =
+            bordered_tri_solve(a[0], a[1], a[2], K, H, C, piv, f, n, m);
+        REQUIRE_BARRIER(err == 0);
+      } else {
+        bordered_tri_lu_solve(a[0], a[1], a[2], K, H, C, piv, f, n, m);
+      }
+
+      // check that Rx = f
+      for (int i = 0; i < nm; i++) {
+        // compute the ith entry of Rx
+        double Rxi = 0.0;
+        for (int j = 0; j < nm; j++) {
+          Rxi += R[i][j] * f[j];
+        }
+        REQUIRE_CLOSE(Rxi, ff[i], 1e-10);
+      }
+    }
+
+    free_2d(R);
+    free_2d(a);
+    free(K);
+    free(H);
+    free(C);
+    free(piv);
+    free(f);
+    free(ff);
+  }
+
+  SUBTEST("bordered pent solve") {
+    const int n = 10;
+    const int m = 4;
+    const int nm = n + m;
+    double **R = malloc_d2d(nm, nm);
+    double **a = malloc_d2d(5, n);
+    double *K = malloc(n * m * sizeof(double));
+    double *H = malloc(m * n * sizeof(double));
+    double *C = malloc(m * m * sizeof(double));
+    int *piv = malloc(m * sizeof(int));
+    double *f = malloc(nm * sizeof(double));
+    double *ff = malloc(nm * sizeof(double));
+
+    fill_bordered(R, a, 2, K, H, C, n, m);
+
+    // solve twice, the second time reusing the factorisation
+    for (int r = 0; r < 2; r++) {
+      for (int i = 0; i < nm; i++) {
+        f[i] = (double)(rand() % 1000 - 500) / 100.0;
+        ff[i] = f[i]; // copy the original rhs
+      }
+
+      if (r == 0) {
+        const int err = bordered_pent_solve(
+            a[0], a[1], a[2], a[3], a[4], K, H, C, piv, f, n, m
+        );
+        REQUIRE_BARRIER(err == 0);
+      } else {
+        bordered_pent_lu_solve(
+            a[0], a[1], a[2], a[3], a[4], K, H, C, piv, f, n, m
+        );
+      }
+
+      // check that Rx = f
+      for (int i = 0; i < nm; i++) {
+        // compute the ith entry of Rx
+        double Rxi = 0.0;
+        for (int j = 0; j < nm; j++) {
+          Rxi += R[i][j] * f[j];
+        }
+        REQUIRE_CLOSE(Rxi, ff[i], 1e-10);
+      }
+    }
+
+    free_2d(R);
+    free_2d(a);
+    free(K);
+    free(H);
+    free(C);
+    free(piv);
+    free(f);
+    free(ff);
+  }
+
+  END_TEST();
+}
@@ -0,0 +1,154 @@
+#include "testing.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "src/alloc.h"
+#include "src/circ_solve.h"
+
+/**
+ * Set the elements of the full, circulant, pentadiagonal matrix A from its
+ * constant diagonals (the tridiagonal case has l2 = u2 = 0).
+ */
+static void circ_to_full(
+    double **A, double l2, double l1, double d0, double u1, double u2, int n
+) {
+  memset(A[0], 0, n * n * sizeof(double));
+  for (int i = 0; i < n; i++) {
+    A[i][(i + n - 2) % n] += l2;
+    A[i][(i + n - 1) % n] += l1;
+    A[i][i] += d0;
+    A[i][(i + 1) % n] += u1;
+    A[i][(i + 2) % n] += u2;
+  }
+}
+
+/**
+ * Compute the maximum error in AX = F for m right-hand sides.
+ */
+static double
+residual(double **A, const double *X, const double *F, int n, int m) {
+  double err = 0.0;
+  for (int i = 0; i < n; i++) {
+    for (int k = 0; k < m; k++) {
+      double AXik = 0.0;
+      for (int j = 0; j < n; j++) {
+        AXik += A[i][j] * X[j * m + k];
+      }
+      err = fmax(err, fabs(AXik - F[i * m + k]));
+    }
+  }
+  return err;
+}
+
+int main(void) {
+  START_TEST("circ solve");
+
+  /* check the constant-coefficient tridiagonal solve */
+  SUBTEST("cyclic tri const solve") {
+    const int sizes[] = {3, 8, 11, 64};
+    for (int s = 0; s < 4; s++) {
+      const int n = sizes[s];
+      double **A = malloc_d2d(n, n);
+      double *f = malloc(n * sizeof(double));
+      double *ff = malloc(n * sizeof(double));
+
+      const double l = (double)(rand() % 1000 - 500) / 100.0;
+      const double u = (double)(rand() % 1000 - 500) / 100.0;
+      const double d = 1.1 * (fabs(l) + fabs(u)) + 0.1;
+      circ_to_full(A, 0.0, l, d, u, 0.0, n);
+
+      for (int i = 0; i < n; i++) {
+        f[i] = (double)(rand() % 1000 - 500) / 100.0;
+        ff[i] = f[i];
+      }
+
+      int err = cyclic_tri_const_solve(l, d, u, f, n);
+      REQUIRE_BARRIER(err == 0);
+      REQUIRE(residual(A, f, ff, n, 1) < 1e-10);
+
+      free_2d(A);
+      free(f);
+      free(ff);
+    }
+  }
+
+  /* check the constant-coefficient pentadiagonal solve */
+  SUBTEST("cyclic pent const solve") {
+    const int sizes[] = {5, 16, 13};
+    for (int s = 0; s < 3; s++) {
+      const int n = sizes[s];
+      double **A = malloc_d2d(n, n);
+      double *f = malloc(n * sizeof(double));
+      double *ff = malloc(n * sizeof(double));
+
+      const double l2 = (double)(rand() % 1000 - 500) / 100.0;
+      const double l1 = (double)(rand() % 1000 - 500) / 100.0;
+      const double u1 = (double)(rand() % 1000 - 500) / 100.0;
+      const double u2 = (double)(rand() % 1000 - 500) / 100.0;
+      const double d0 = -1.1 * (fabs(l2) + fabs(l1) + fabs(u1) + fabs(u2));
+      circ_to_full(A, l2, l1, d0, u1, u2, n);
+
+      for (int i = 0; i < n; i++) {
+        f[i] = (double)(rand() % 1000 - 500) / 100.0;
+        ff[i] = f[i];
+      }
+
+      int err = cyclic_pent_const_solve(l2, l1, d0, u1, u2, f, n);
+      REQUIRE_BARRIER(err == 0);
+      REQUIRE(residual(A, f, ff, n, 1) < 1e-10);
+
+      free_2d(A);
+      free(f);
+      free(ff);
+    }
+  }
+
+  /* check reuse of the factorisation for many right-hand sides */
+  SUBTEST("circ solve multi") {
+    const int n = 24;
+    const int m = 7;
+    double **A = malloc_d2d(n, n);
+    double *F = malloc(n * m * sizeof(double));
+    double *FF = malloc(n * m * sizeof(double));
+
+    const double l2 = 0.5, l1 = -1.0, d0 = 4.0, u1 = 2.0, u2 = 0.25;
+    circ_to_full(A, l2, l1, d0, u1, u2, n);
+
+    for (int i = 0; i < n * m; i++) {
+      F[i] = (double)(rand() % 1000 - 500) / 100.0;
+      FF[i] = F[i];
+    }
+
+    circ_factor circ;
+    int err = cyclic_pent_const_factorise(&circ, l2, l1, d0, u1, u2, n);
+    REQUIRE_BARRIER(err == 0);
+    circ_solve_factorised_multi(&circ, F, m);
+    REQUIRE(residual(A, F, FF, n, m) < 1e-10);
+
+    // a second single solve with the same factorisation
+    for (int i = 0; i < n; i++) {
+      F[i] = FF[i * m];
+    }
+    circ_solve_factorised(&circ, F);
+    for (int i = 0; i < n; i++) {
+      FF[i] = FF[i * m];
+    }
+    REQUIRE(residual(A, F, FF, n, 1) < 1e-10);
+
+    circ_factor_free(&circ);
+    free_2d(A);
+    free(F);
+    free(FF);
+  }
+
+  /* check that singular matrices are detected */
+  SUBTEST("circ singular") {
+    circ_factor circ;
+    // the constant vector is in the null space of the periodic Laplacian
+    int err = cyclic_tri_const_factorise(&circ, 1.0, -2.0, 1.0, 10);
+    REQUIRE(err == 1);
+  }
+
+  END_TEST();
+}
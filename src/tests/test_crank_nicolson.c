@@ -0,0 +1,155 @@
+#include "testing.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "src/alloc.h"
+#include "src/crank_nicolson.h"
+#include "src/lu_solve.h"
+
+/**
+ * Set the elements of the full banded matrix A from its 2w+1 diagonals. If
+ * cyclic, the diagonals wrap around the corners of the matrix.
+ */
+static void
+band_to_full(double **A, double **diag, int w, int n, int cyclic) {
+  memset(A[0], 0, n * n * sizeof(double));
+  for (int i = 0; i < n; i++) {
+    for (int k = -w; k <= w; k++) {
+      const int j = i + k;
+      if (j >= 0 && j < n) {
+        A[i][j] = diag[k + w][i];
+      } else if (cyclic) {
+        A[i][(j + n) % n] = diag[k + w][i];
+      }
+    }
+  }
+}
+
+/**
+ * Check that nsteps of the stepper match the theta method computed with full
+ * matrices.
+ */
+static int check_stepper(int w, int cyclic, int n, double dt, double theta) {
+  const int ndiag = 2 * w + 1;
+  double **L = malloc_d2d(ndiag, n);
+  double **Lsave = malloc_d2d(ndiag, n);
+  double **Lfull = malloc_d2d(n, n);
+  double **E = malloc_d2d(n, n);
+  double **M = malloc_d2d(n, n);
+  int *piv = malloc(n * sizeof(int));
+  double *x = malloc(n * sizeof(double));
+  double *xx = malloc(n * sizeof(double));
+  double *rhs = malloc(n * sizeof(double));
+
+  // a diffusion-like operator (negative diagonal) so that the implicit
+  // operator is diagonally dominant
+  for (int k = 0; k < ndiag; k++) {
+    for (int i = 0; i < n; i++) {
+      L[k][i] = (double)(rand() % 1000) / 1000.0;
+    }
+  }
+  for (int i = 0; i < n; i++) {
+    double sum = 0.0;
+    for (int k = 0; k < ndiag; k++) {
+      sum += (k == w) ? 0.0 : L[k][i];
+    }
+    L[w][i] = -1.5 * sum;
+    x[i] = (double)(rand() % 1000 - 500) / 100.0;
+    xx[i] = x[i];
+  }
+  memcpy(Lsave[0], L[0], ndiag * n * sizeof(double));
+
+  // full explicit and implicit operators
+  band_to_full(Lfull, L, w, n, cyclic);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      const double I = (i == j) ? 1.0 : 0.0;
+      E[i][j] = I + (1.0 - theta) * dt * Lfull[i][j];
+      M[i][j] = I - theta * dt * Lfull[i][j];
+    }
+  }
+
+  cn_stepper s;
+  int err = lu_factorise(M[0], piv, n);
+  if (err == 0) {
+    if (w == 1) {
+      err = cn_stepper_init_tri(&s, L[0], L[1], L[2], dt, theta, cyclic, n);
+    } else {
+      err = cn_stepper_init_pent(
+          &s, L[0], L[1], L[2], L[3], L[4], dt, theta, cyclic, n
+      );
+    }
+  }
+
+  int errs = (err != 0);
+  for (int step = 0; err == 0 && step < 5; step++) {
+    // reference step
+    for (int i = 0; i < n; i++) {
+      rhs[i] = 0.0;
+      for (int j = 0; j < n; j++) {
+        rhs[i] += E[i][j] * xx[j];
+      }
+    }
+    lu_solve_factorised(M[0], piv, rhs, n);
+    memcpy(xx, rhs, n * sizeof(double));
+
+    cn_step(&s, x);
+    for (int i = 0; i < n; i++) {
+      errs += fabs(x[i] - xx[i]) > 1e-10;
+    }
+  }
+
+  // the caller's operator is left untouched
+  for (int k = 0; k < ndiag; k++) {
+    for (int i = 0; i < n; i++) {
+      errs += L[k][i] != Lsave[k][i];
+    }
+  }
+
+  if (err == 0) {
+    cn_stepper_free(&s);
+  }
+  free_2d(L);
+  free_2d(Lsave);
+  free_2d(Lfull);
+  free_2d(E);
+  free_2d(M);
+  free(piv);
+  free(x);
+  free(xx);
+  free(rhs);
+  return errs;
+}
+
+int main(void) {
+  START_TEST("crank nicolson");
+
+  SUBTEST("tri stepper") {
+    REQUIRE(check_stepper(1, 0, 9, 0.1, 0.5) == 0);
+    REQUIRE(check_stepper(1, 0, 4, 0.3, 1.0) == 0);
+  }
+
+  SUBTEST("cyclic tri stepper") {
+    REQUIRE(check_stepper(1, 1, 9, 0.1, 0.5) == 0);
+    REQUIRE(check_stepper(1, 1, 3, 0.2, 0.75) == 0);
+  }
+
+  SUBTEST("pent stepper") {
+    REQUIRE(check_stepper(2, 0, 10, 0.1, 0.5) == 0);
+    REQUIRE(check_stepper(2, 0, 5, 0.2, 1.0) == 0);
+  }
+
+  SUBTEST("cyclic pent stepper") {
+    REQUIRE(check_stepper(2, 1, 11, 0.1, 0.5) == 0);
+    REQUIRE(check_stepper(2, 1, 7, 0.2, 0.6) == 0);
+    REQUIRE(check_stepper(2, 1, 6, 0.3, 0.5) == 0);
+
+    // too small for the corners to be kept apart
+    cn_stepper s;
+    double v[5] = {1.0, 1.0, 1.0, 1.0, 1.0};
+    REQUIRE(cn_stepper_init_pent(&s, v, v, v, v, v, 0.1, 0.5, 1, 5) == -1);
+  }
+
+  END_TEST();
+}
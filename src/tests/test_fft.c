@@ -0,0 +1,200 @@
+#include "testing.h"
+
+#include <stdlib.h>
+
+#include "src/fft.h"
+
+#define PI (3.14159265358979323846)
+
+/**
+ * Compute the discrete Fourier transform of the complex vector z directly.
+ */
+static void naive_dft(const double *z, double *Z, int n) {
+  for (int k = 0; k < n; k++) {
+    Z[2 * k] = 0.0;
+    Z[2 * k + 1] = 0.0;
+    for (int j = 0; j < n; j++) {
+      const double c = cos(2.0 * PI * j * k / n);
+      const double s = -sin(2.0 * PI * j * k / n);
+      Z[2 * k] += z[2 * j] * c - z[2 * j + 1] * s;
+      Z[2 * k + 1] += z[2 * j] * s + z[2 * j + 1] * c;
+    }
+  }
+}
+
+/**
+ * Check complex transforms of length n against the direct DFT.
+ */
+static int check_fft(int n) {
+  int errs = 0;
+  fft_plan plan;
+  if (fft_plan_init(&plan, n) != 0) {
+    return 1;
+  }
+  double *z = malloc(2 * n * sizeof(double));
+  double *zz = malloc(2 * n * sizeof(double));
+  double *Z = malloc(2 * n * sizeof(double));
+  double *work = malloc((plan.nwork + 1) * sizeof(double));
+
+  for (int i = 0; i < 2 * n; i++) {
+    z[i] = (double)(rand() % 1000 - 500) / 100.0;
+    zz[i] = z[i];
+  }
+
+  // forward transform matches the DFT
+  naive_dft(z, Z, n);
+  fft_forward(&plan, z, work);
+  for (int i = 0; i < 2 * n; i++) {
+    errs += fabs(z[i] - Z[i]) > 1e-9;
+  }
+
+  // inverse transform recovers the original vector
+  fft_inverse(&plan, z, work);
+  for (int i = 0; i < 2 * n; i++) {
+    errs += fabs(z[i] - zz[i]) > 1e-10;
+  }
+
+  fft_plan_free(&plan);
+  free(z);
+  free(zz);
+  free(Z);
+  free(work);
+  return errs;
+}
+
+/**
+ * Check real transforms of length n against the direct DFT.
+ */
+static int check_rfft(int n) {
+  int errs = 0;
+  rfft_plan plan;
+  if (rfft_plan_init(&plan, n) != 0) {
+    return 1;
+  }
+  double *x = malloc(n * sizeof(double));
+  double *xx = malloc(n * sizeof(double));
+  double *z = malloc(2 * n * sizeof(double));
+  double *Z = malloc(2 * n * sizeof(double));
+  double *work = malloc(plan.nwork * sizeof(double));
+
+  for (int i = 0; i < n; i++) {
+    x[i] = (double)(rand() % 1000 - 500) / 100.0;
+    xx[i] = x[i];
+    z[2 * i] = x[i];
+    z[2 * i + 1] = 0.0;
+  }
+
+  // forward transform matches the DFT in half-complex order
+  naive_dft(z, Z, n);
+  rfft_forward(&plan, x, work);
+  errs += fabs(x[0] - Z[0]) > 1e-9;
+  for (int k = 1; 2 * k < n; k++) {
+    errs += fabs(x[2 * k - 1] - Z[2 * k]) > 1e-9;
+    errs += fabs(x[2 * k] - Z[2 * k + 1]) > 1e-9;
+  }
+  if (n % 2 == 0) {
+    errs += fabs(x[n - 1] - Z[n]) > 1e-9;
+  }
+
+  // inverse transform recovers the original vector
+  rfft_inverse(&plan, x, work);
+  for (int i = 0; i < n; i++) {
+    errs += fabs(x[i] - xx[i]) > 1e-10;
+  }
+
+  rfft_plan_free(&plan);
+  free(x);
+  free(xx);
+  free(z);
+  free(Z);
+  free(work);
+  return errs;
+}
+
+/**
+ * Check sine transforms of length n against the direct DST-I.
+ */
+static int check_dst(int n) {
+  int errs = 0;
+  dst_plan plan;
+  if (dst_plan_init(&plan, n) != 0) {
+    return 1;
+  }
+  double *x = malloc(n * sizeof(double));
+  double *xx = malloc(n * sizeof(double));
+  double *X = malloc(n * sizeof(double));
+  double *work = malloc(plan.nwork * sizeof(double));
+
+  for (int i = 0; i < n; i++) {
+    x[i] = (double)(rand() % 1000 - 500) / 100.0;
+    xx[i] = x[i];
+  }
+  for (int k = 0; k < n; k++) {
+    X[k] = 0.0;
+    for (int j = 0; j < n; j++) {
+      X[k] += x[j] * sin(PI * (j + 1) * (k + 1) / (n + 1));
+    }
+  }
+
+  // forward transform matches the direct DST-I
+  dst1(&plan, x, work);
+  for (int i = 0; i < n; i++) {
+    errs += fabs(x[i] - X[i]) > 1e-9;
+  }
+
+  // applying it again recovers the original vector up to scaling
+  dst1(&plan, x, work);
+  for (int i = 0; i < n; i++) {
+    errs += fabs(2.0 * x[i] / (n + 1) - xx[i]) > 1e-10;
+  }
+
+  dst_plan_free(&plan);
+  free(x);
+  free(xx);
+  free(X);
+  free(work);
+  return errs;
+}
+
+int main(void) {
+  START_TEST("fft");
+
+  /* check power-of-two lengths */
+  SUBTEST("radix-2 FFT") {
+    REQUIRE(check_fft(1) == 0);
+    REQUIRE(check_fft(2) == 0);
+    REQUIRE(check_fft(16) == 0);
+    REQUIRE(check_fft(128) == 0);
+  }
+
+  /* check other lengths */
+  SUBTEST("Bluestein FFT") {
+    REQUIRE(check_fft(3) == 0);
+    REQUIRE(check_fft(12) == 0);
+    REQUIRE(check_fft(97) == 0);
+  }
+
+  /* check even length real transforms */
+  SUBTEST("real FFT (even)") {
+    REQUIRE(check_rfft(2) == 0);
+    REQUIRE(check_rfft(4) == 0);
+    REQUIRE(check_rfft(32) == 0);
+    REQUIRE(check_rfft(30) == 0);
+  }
+
+  /* check odd length real transforms */
+  SUBTEST("real FFT (odd)") {
+    REQUIRE(check_rfft(1) == 0);
+    REQUIRE(check_rfft(7) == 0);
+    REQUIRE(check_rfft(45) == 0);
+  }
+
+  /* check sine transforms */
+  SUBTEST("DST-I") {
+    REQUIRE(check_dst(1) == 0);
+    REQUIRE(check_dst(7) == 0);
+    REQUIRE(check_dst(10) == 0);
+  }
+
+  END_TEST();
+}
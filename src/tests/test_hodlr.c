@@ -0,0 +1,138 @@
+#include "testing.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "src/alloc.h"
+#include "src/hodlr.h"
+#include "src/lu_solve.h"
+
+/**
+ * A smooth kernel on points in [0, 1] with a strong diagonal, so that the
+ * off-diagonal blocks are numerically low-rank.
+ */
+static double kernel(int i, int j, void *ctx) {
+  const int n = *(const int *)ctx;
+  if (i == j) {
+    return 2.0;
+  }
+  const double x = (double)i / n;
+  const double y = (double)j / n;
+  return 1.0 / (n * (1.0 + 4.0 * fabs(x - y)));
+}
+
+int main(void) {
+  START_TEST("hodlr");
+
+  SUBTEST("hodlr solve") {
+    int n = 400;
+    const int m = 3;
+    double **A = malloc_d2d(n, n);
+    double **F = malloc_d2d(n, m);
+    double **FF = malloc_d2d(n, m);
+    double *f = malloc(n * sizeof(double));
+    double *ff = malloc(n * sizeof(double));
+
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) {
+        A[i][j] = kernel(i, j, &n);
+      }
+      f[i] = (double)(rand() % 1000 - 500) / 100.0;
+      ff[i] = f[i]; // copy the original rhs
+      for (int j = 0; j < m; j++) {
+        F[i][j] = (double)(rand() % 1000 - 500) / 100.0;
+        FF[i][j] = F[i][j]; // copy the original rhs
+      }
+    }
+
+    hodlr h;
+    int err = hodlr_init(&h, kernel, &n, n, 32, 1e-12, 40);
+    REQUIRE_BARRIER(err == 0);
+
+    // the off-diagonal blocks should have been compressed
+    REQUIRE(h.kmax > 0);
+    REQUIRE(h.kmax < 60);
+
+    err = hodlr_factorise(&h);
+    REQUIRE_BARRIER(err == 0);
+
+    double *work = malloc(h.kmax * m * sizeof(double));
+    hodlr_solve(&h, f, work);
+    hodlr_solve_multi(&h, F[0], m, work);
+
+    // check that Ax = f
+    for (int i = 0; i < n; i++) {
+      // compute the ith entry of Ax
+      double Axi = 0.0;
+      for (int j = 0; j < n; j++) {
+        Axi += A[i][j] * f[j];
+      }
+      REQUIRE_CLOSE(Axi, ff[i], 1e-8);
+    }
+
+    // check that AX = F
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < m; j++) {
+        // compute the ijth entry of AX
+        double AXij = 0.0;
+        for (int k = 0; k < n; k++) {
+          AXij += A[i][k] * F[k][j];
+        }
+        REQUIRE_CLOSE(AXij, FF[i][j], 1e-8);
+      }
+    }
+
+    hodlr_free(&h);
+    free_2d(A);
+    free_2d(F);
+    free_2d(FF);
+    free(f);
+    free(ff);
+    free(work);
+  }
+
+  SUBTEST("hodlr dense") {
+    const int n = 37; // odd, so the tree is unbalanced
+    double **A = malloc_d2d(n, n);
+    double *f = malloc(n * sizeof(double));
+    double *g = malloc(n * sizeof(double));
+    int *piv = malloc(n * sizeof(int));
+
+    // a general random matrix is not low-rank, so the approximation is only
+    // exact if the ranks are allowed to be full
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) {
+        A[i][j] = (double)(rand() % 1000 - 500) / 100.0;
+      }
+      A[i][i] += 100.0;
+      f[i] = (double)(rand() % 1000 - 500) / 100.0;
+      g[i] = f[i];
+    }
+
+    hodlr h;
+    int err = hodlr_init_dense(&h, A[0], n, 4, 1e-14, n);
+    REQUIRE_BARRIER(err == 0);
+    err = hodlr_factorise(&h);
+    REQUIRE_BARRIER(err == 0);
+
+    double *work = malloc(h.kmax * sizeof(double));
+    hodlr_solve(&h, f, work);
+
+    err = lu_solve(A[0], g, piv, n);
+    REQUIRE_BARRIER(err == 0);
+
+    // check that the HODLR and dense solves match
+    for (int i = 0; i < n; i++) {
+      REQUIRE_CLOSE(f[i], g[i], 1e-10);
+    }
+
+    hodlr_free(&h);
+    free_2d(A);
+    free(f);
+    free(g);
+    free(piv);
+    free(work);
+  }
+
+  END_TEST();
+}
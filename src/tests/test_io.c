@@ -1,10 +1,16 @@
 #include "testing.h"
 
 #include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #include "src/alloc.h"
+#include "src/band_matvec.h"
 #include "src/io.h"
+#include "src/lu_solve.h"
+#include "src/tri_solve.h"
 
 int main(void) {
   START_TEST("io");
@@ -156,6 +162,680 @@ int main(void) {
     unlink(filename);
   }
 
+  /* write a transposed view and read it back into a view */
+  SUBTEST("matrix output/input") {
+    const char filename[] = "tests/test_output.txt";
+    matrix MA, MT, MC, V;
+    matrix_wrap(&MA, A[0], n, m, m);
+    matrix_transpose(&MT, &MA);
+    int err = matrix_output(filename, &MT);
+    REQUIRE_BARRIER(err == 0);
+
+    // read into the bottom right m x n corner of a larger matrix
+    double C[5 * 5] = {0};
+    matrix_wrap(&MC, C, 5, 5, 5);
+    matrix_view(&V, &MC, 5 - m, 5 - n, m, n);
+    err = matrix_input(filename, &V);
+    REQUIRE_BARRIER(err == 0);
+
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < m; j++) {
+        REQUIRE(A[i][j] == C[(5 - m + j) * 5 + (5 - n + i)]);
+      }
+    }
+    REQUIRE(C[0] == 0.0);
+
+    // write errors are reported, e.g. when the disk is full
+    if (access("/dev/full", W_OK) == 0) {
+      REQUIRE(matrix_output("/dev/full", &MT) == 1);
+    }
+
+    unlink(filename);
+  }
+
+  /* check binary output is read back exactly */
+  SUBTEST("binary output/input") {
+    const char filename[] = "tests/test_output.bin";
+    double **X = malloc_d2d(n, m);
+    double **Y = malloc_d2d(n, m);
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < m; j++) {
+        X[i][j] = 1.0 / (i * m + j + 3.0); // not exactly representable
+      }
+    }
+
+    int err = mat_output_bin(filename, X[0], n, m);
+    REQUIRE_BARRIER(err == 0);
+
+    mat_header h;
+    err = mat_input_bin_header(filename, &h);
+    REQUIRE_BARRIER(err == 0);
+    REQUIRE(h.version == MAT_BIN_VERSION);
+    REQUIRE(h.dtype == MAT_BIN_F64);
+    REQUIRE(h.rows == n && h.cols == m && h.stride == m);
+    REQUIRE(h.kl == -1 && h.ku == -1);
+    REQUIRE(!h.swap);
+
+    err = mat_input_bin(filename, Y[0], n, m);
+    REQUIRE_BARRIER(err == 0);
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < m; j++) {
+        REQUIRE(X[i][j] == Y[i][j]);
+      }
+    }
+
+    // the wrong size is rejected
+    err = mat_input_bin(filename, Y[0], m, n);
+    REQUIRE(err == 1);
+
+    unlink(filename);
+    free_2d(X);
+    free_2d(Y);
+  }
+
+  /* check padded rows are dropped when reading */
+  SUBTEST("binary input (padded)") {
+    const char filename[] = "tests/test_output.bin";
+    const int stride = m + 3;
+    double P[3 * 5];
+    for (int i = 0; i < n * stride; i++) {
+      P[i] = (i % stride < m) ? i : -1.0;
+    }
+
+    mat_header h;
+    mat_header_init(&h, n, m);
+    h.stride = stride;
+    h.data_offset = 200;
+    int err = mat_output_bin_header(filename, &h, P);
+    REQUIRE_BARRIER(err == 0);
+
+    err = mat_input_bin(filename, B[0], n, m);
+    REQUIRE_BARRIER(err == 0);
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < m; j++) {
+        REQUIRE(B[i][j] == i * stride + j);
+      }
+    }
+
+    double Q[3 * 5];
+    err = mat_input_bin_raw(filename, Q, n * stride);
+    REQUIRE_BARRIER(err == 0);
+    REQUIRE(memcmp(P, Q, sizeof(P)) == 0);
+    REQUIRE(mat_input_bin_raw(filename, Q, n * stride - 1) == 1);
+
+    unlink(filename);
+  }
+
+  /* check files of the opposite byte order are converted */
+  SUBTEST("binary input (byte swapped)") {
+    const char filename[] = "tests/test_output.bin";
+    unsigned char buf[MAT_BIN_HEADER_SIZE + 6 * sizeof(double)];
+
+    // write a file with no padding, then reverse every field and entry by hand
+    mat_header h;
+    mat_header_init(&h, n, m);
+    h.data_offset = MAT_BIN_HEADER_SIZE;
+    int err = mat_output_bin_header(filename, &h, A[0]);
+    REQUIRE_BARRIER(err == 0);
+    FILE *fp = fopen(filename, "rb");
+    REQUIRE_BARRIER(fp != NULL);
+    REQUIRE_BARRIER(fread(buf, 1, sizeof(buf), fp) == sizeof(buf));
+    fclose(fp);
+
+    const int fields[11][2] = {{8, 4},  {12, 4}, {16, 4}, {20, 4},
+                               {24, 8}, {32, 8}, {40, 8}, {48, 4},
+                               {52, 4}, {56, 8}, {64, 48}};
+    for (int f = 0; f < 11; f++) {
+      const int size = (f < 10) ? fields[f][1] : 8;
+      const int count = (f < 10) ? 1 : 6;
+      for (int k = 0; k < count; k++) {
+        unsigned char *p = buf + fields[f][0] + k * size;
+        for (int i = 0; i < size / 2; i++) {
+          const unsigned char tmp = p[i];
+          p[i] = p[size - 1 - i];
+          p[size - 1 - i] = tmp;
+        }
+      }
+    }
+    fp = fopen(filename, "wb");
+    REQUIRE_BARRIER(fp != NULL);
+    fwrite(buf, 1, sizeof(buf), fp);
+    fclose(fp);
+
+    err = mat_input_bin_header(filename, &h);
+    REQUIRE_BARRIER(err == 0);
+    REQUIRE(h.swap);
+    REQUIRE(h.rows == n && h.cols == m);
+
+    err = mat_input_bin(filename, B[0], n, m);
+    REQUIRE_BARRIER(err == 0);
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < m; j++) {
+        REQUIRE(A[i][j] == B[i][j]);
+      }
+    }
+
+    unlink(filename);
+  }
+
+  /* check text files are not mistaken for binary ones */
+  SUBTEST("invalid binary input") {
+    const char filename[] = "tests/test_output.txt";
+    int err = mat_outputf(filename, "%5.1lf", A[0], n, m);
+    REQUIRE_BARRIER(err == 0);
+
+    mat_header h;
+    REQUIRE(mat_input_bin_header(filename, &h) == 1);
+    REQUIRE(mat_input_bin(filename, B[0], n, m) == 1);
+    REQUIRE(mat_input_bin_raw(filename, B[0], (size_t)(n * m)) == 1);
+    unlink(filename);
+
+    // headers describing impossible sizes are not written
+    const char binname[] = "tests/test_output.bin";
+    const int bad[5][4] = {
+        {-1, m, -1, -1}, {n, -1, -1, -1}, {n, m, -2, -1},
+        {n, m, 1, -1}, {n, m, -1, -3}
+    };
+    for (int k = 0; k < 5; k++) {
+      mat_header_init(&h, bad[k][0], bad[k][1]);
+      h.stride = (bad[k][1] < 0) ? m : bad[k][1];
+      h.kl = bad[k][2];
+      h.ku = bad[k][3];
+      REQUIRE(mat_output_bin_header(binname, &h, A[0]) == 1);
+      REQUIRE(access(binname, F_OK) != 0);
+    }
+  }
+
+  /* check solving with a factorisation mapped straight from a file */
+  SUBTEST("mapped input") {
+    const char filename[] = "tests/test_output.bin";
+    const int k = 6;
+    double **LU = malloc_d2d(k, k);
+    double **AA = malloc_d2d(k, k);
+    int *piv = malloc(k * sizeof(int));
+    double *f = malloc(k * sizeof(double));
+    double *ff = malloc(k * sizeof(double));
+    for (int i = 0; i < k; i++) {
+      for (int j = 0; j < k; j++) {
+        LU[i][j] = (double)(rand() % 1000 - 500) / 100.0;
+        AA[i][j] = LU[i][j];
+      }
+      f[i] = (double)(rand() % 1000 - 500) / 100.0;
+      ff[i] = f[i];
+    }
+    int err = lu_factorise(LU[0], piv, k);
+    REQUIRE_BARRIER(err == 0);
+    err = mat_output_bin(filename, LU[0], k, k);
+    REQUIRE_BARRIER(err == 0);
+
+    mat_map map;
+    err = mat_map_bin(filename, &map);
+    REQUIRE_BARRIER(err == 0);
+    REQUIRE(map.h.rows == k && map.h.cols == k);
+    REQUIRE(map.h.data_offset % MAT_BIN_PAGE_SIZE == 0);
+    REQUIRE((uintptr_t)map.data % MAT_BIN_PAGE_SIZE == 0);
+
+    lu_solve_factorised(map.data, piv, f, k);
+    for (int i = 0; i < k; i++) {
+      double Axi = 0.0;
+      for (int j = 0; j < k; j++) {
+        Axi += AA[i][j] * f[j];
+      }
+      REQUIRE_CLOSE(Axi, ff[i], 1e-10);
+    }
+
+    mat_unmap_bin(&map);
+    REQUIRE(map.data == NULL);
+
+    // files which are not binary matrices cannot be mapped
+    err = mat_outputf(filename, "%5.1lf", A[0], n, m);
+    REQUIRE_BARRIER(err == 0);
+    REQUIRE(mat_map_bin(filename, &map) == 1);
+
+    unlink(filename);
+    free_2d(LU);
+    free_2d(AA);
+    free(piv);
+    free(f);
+    free(ff);
+  }
+
+  /* check the parser rounds exactly, in agreement with strtod */
+  SUBTEST("parse") {
+    const char text[] =
+        "0.1 -2.5e-3 1e22 1e23 123456789012345678901 -0 0.000000000000000001 "
+        "9007199254740993 4.9406564584124654e-324 1.7976931348623157e308 "
+        "+7. .5 inf 0x1p-3";
+    double x[14];
+    size_t nread;
+    int err = mat_parse(text, sizeof(text) - 1, x, 14, &nread);
+    REQUIRE_BARRIER(err == 0);
+    REQUIRE(nread == 14);
+
+    const char *p = text;
+    for (int k = 0; k < 14; k++) {
+      char *end;
+      const double y = strtod(p, &end);
+      REQUIRE(memcmp(&x[k], &y, sizeof(double)) == 0);
+      p = end;
+    }
+
+    // stops at the count, and reports bad tokens
+    err = mat_parse("1 2 3", 5, x, 2, &nread);
+    REQUIRE(err == 0 && nread == 2);
+    err = mat_parse("1 2 3e 4", 8, x, 4, &nread);
+    REQUIRE(err == 1 && nread == 2);
+  }
+
+  /* check a file larger than a single block of the reader */
+  SUBTEST("large input") {
+    const char filename[] = "tests/test_output.txt";
+    const int nl = 400;
+    const int ml = 500;
+    double **X = malloc_d2d(nl, ml);
+    double **Y = malloc_d2d(nl, ml);
+    for (int i = 0; i < nl; i++) {
+      for (int j = 0; j < ml; j++) {
+        X[i][j] = (double)(rand() % 100000 - 50000) / 7.0;
+      }
+    }
+
+    int err = mat_outputf(filename, "%.17g", X[0], nl, ml);
+    REQUIRE_BARRIER(err == 0);
+    err = mat_input(filename, Y[0], nl, ml);
+    REQUIRE_BARRIER(err == 0);
+    for (int i = 0; i < nl; i++) {
+      for (int j = 0; j < ml; j++) {
+        REQUIRE(X[i][j] == Y[i][j]);
+      }
+    }
+
+    unlink(filename);
+    free_2d(X);
+    free_2d(Y);
+  }
+
+  /* check that a file streamed a few rows at a time matches the whole file */
+  SUBTEST("streamed input") {
+    const char filename[] = "tests/test_output.txt";
+    const char binname[] = "tests/test_output.bin";
+    const int nl = 400;
+    const int ml = 500;
+    const int k = 7;
+    double **X = malloc_d2d(nl, ml);
+    double *rows = malloc((size_t)(k * ml) * sizeof(double));
+    double x[500], y[400], z[400];
+    for (int i = 0; i < nl; i++) {
+      for (int j = 0; j < ml; j++) {
+        X[i][j] = (double)(rand() % 100000 - 50000) / 7.0;
+      }
+    }
+    for (int j = 0; j < ml; j++) {
+      x[j] = 1.0 / (j + 1.0);
+    }
+    for (int i = 0; i < nl; i++) {
+      y[i] = 0.0;
+      for (int j = 0; j < ml; j++) {
+        y[i] += X[i][j] * x[j];
+      }
+    }
+
+    // a matrix-vector product over a text file larger than one block
+    int err = mat_output(filename, X[0], nl, ml);
+    REQUIRE_BARRIER(err == 0);
+    mat_stream s;
+    err = mat_stream_open(&s, filename, nl, ml);
+    REQUIRE_BARRIER(err == 0);
+    int i0 = 0;
+    int nrows;
+    do {
+      err = mat_stream_read(&s, rows, k, &nrows);
+      for (int i = 0; i < nrows; i++) {
+        z[i0 + i] = 0.0;
+        for (int j = 0; j < ml; j++) {
+          z[i0 + i] += rows[i * ml + j] * x[j];
+        }
+      }
+      i0 += nrows;
+    } while (err == 0 && nrows == k);
+    mat_stream_close(&s);
+    REQUIRE_BARRIER(err == 0 && i0 == nl);
+    REQUIRE(nrows == nl % k);
+    for (int i = 0; i < nl; i++) {
+      REQUIRE(y[i] == z[i]);
+    }
+
+    // the file ends before the last row
+    err = mat_stream_open(&s, filename, nl + 1, ml);
+    REQUIRE_BARRIER(err == 0);
+    for (i0 = 0; i0 < nl; i0 += nrows) {
+      err = mat_stream_read(&s, rows, k, &nrows);
+      if (err) {
+        break;
+      }
+    }
+    mat_stream_close(&s);
+    REQUIRE(err == 1);
+
+    // a binary file with padded rows
+    const int stride = ml + 3;
+    double *P = malloc((size_t)(nl * stride) * sizeof(double));
+    for (int i = 0; i < nl * stride; i++) {
+      P[i] = (i % stride < ml) ? X[i / stride][i % stride] : -1.0;
+    }
+    mat_header h;
+    mat_header_init(&h, nl, ml);
+    h.stride = stride;
+    err = mat_output_bin_header(binname, &h, P);
+    REQUIRE_BARRIER(err == 0);
+    err = mat_stream_open_bin(&s, binname);
+    REQUIRE_BARRIER(err == 0);
+    REQUIRE(s.rows == nl && s.cols == ml);
+    for (i0 = 0; i0 < nl; i0 += nrows) {
+      err = mat_stream_read(&s, rows, k, &nrows);
+      REQUIRE_BARRIER(err == 0 && nrows > 0);
+      for (int i = 0; i < nrows; i++) {
+        REQUIRE(memcmp(rows + i * ml, X[i0 + i], ml * sizeof(double)) == 0);
+      }
+    }
+    err = mat_stream_read(&s, rows, 2, &nrows);
+    REQUIRE(err == 0 && nrows == 0);
+    mat_stream_close(&s);
+
+    unlink(filename);
+    unlink(binname);
+    free_2d(X);
+    free(rows);
+    free(P);
+  }
+
+  /* check .npy files, including a hand-written big-endian one */
+  SUBTEST("npy output/input") {
+    const char filename[] = "tests/test_output.npy";
+    int err = mat_output_npy(filename, A[0], n, m);
+    REQUIRE_BARRIER(err == 0);
+
+    mat_header h;
+    err = mat_input_npy_header(filename, &h);
+    REQUIRE_BARRIER(err == 0);
+    REQUIRE(h.rows == n && h.cols == m && h.swap == 0);
+    REQUIRE(h.data_offset % 64 == 0);
+
+    err = mat_input_npy(filename, B[0], n, m);
+    REQUIRE_BARRIER(err == 0);
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < m; j++) {
+        REQUIRE(A[i][j] == B[i][j]);
+      }
+    }
+    REQUIRE(mat_input_npy(filename, B[0], m, n) == 1); // wrong shape
+
+    mat_map map;
+    err = mat_map_npy(filename, &map);
+    REQUIRE_BARRIER(err == 0);
+    REQUIRE(map.copied == 0);
+    for (int k = 0; k < n * m; k++) {
+      REQUIRE(map.data[k] == A[0][k]);
+    }
+    mat_unmap_bin(&map);
+
+    // vectors are read as a single column
+    err = mat_output_npy_vector(filename, A[1], m);
+    REQUIRE_BARRIER(err == 0);
+    err = mat_input_npy(filename, B[0], m, 1);
+    REQUIRE_BARRIER(err == 0);
+    for (int j = 0; j < m; j++) {
+      REQUIRE(A[1][j] == B[0][j]);
+    }
+
+    // big-endian, as written by numpy for dtype '>f8'
+    const char dict[] =
+        "{'descr': '>f8', 'fortran_order': False, 'shape': (3,), }";
+    unsigned char buf[128 + 24];
+    memset(buf, ' ', 128);
+    memcpy(buf, "\x93NUMPY\x01\x00\x76\x00", 10);
+    memcpy(buf + 10, dict, sizeof(dict) - 1);
+    buf[127] = '\n';
+    const double x[3] = {1.5, -2.25, 1e-300};
+    for (int k = 0; k < 3; k++) {
+      unsigned char b[8];
+      memcpy(b, &x[k], 8);
+      const uint16_t one = 1;
+      const int little = (*(const unsigned char *)&one == 1);
+      for (int i = 0; i < 8; i++) {
+        buf[128 + 8 * k + i] = little ? b[7 - i] : b[i];
+      }
+    }
+    FILE *fp = fopen(filename, "wb");
+    REQUIRE_BARRIER(fp != NULL);
+    fwrite(buf, 1, sizeof(buf), fp);
+    fclose(fp);
+
+    double y[3];
+    err = mat_input_npy(filename, y, 3, 1);
+    REQUIRE_BARRIER(err == 0);
+    for (int k = 0; k < 3; k++) {
+      REQUIRE(x[k] == y[k]);
+    }
+    err = mat_map_npy(filename, &map);
+    REQUIRE_BARRIER(err == 0);
+    REQUIRE(map.copied == 1);
+    for (int k = 0; k < 3; k++) {
+      REQUIRE(x[k] == map.data[k]);
+    }
+    mat_unmap_bin(&map);
+
+    unlink(filename);
+  }
+
+  /* check .npz archives of tridiagonal diagonals and a dense matrix */
+  SUBTEST("npz output/input") {
+    const char filename[] = "tests/test_output.npz";
+    const int k = 7;
+    double l[7], d[7], u[7], x[7], f[7];
+    for (int i = 0; i < k; i++) {
+      l[i] = (double)(rand() % 1000 - 500) / 100.0;
+      u[i] = (double)(rand() % 1000 - 500) / 100.0;
+      d[i] = fabs(l[i]) + fabs(u[i]) + 1.0;
+      x[i] = (double)(rand() % 1000 - 500) / 100.0;
+    }
+    for (int i = 0; i < k; i++) {
+      f[i] = d[i] * x[i];
+      f[i] += (i > 0) ? l[i] * x[i - 1] : 0.0;
+      f[i] += (i < k - 1) ? u[i] * x[i + 1] : 0.0;
+    }
+
+    const mat_npz_entry entries[5] = {
+        {"l", l, k, 0}, {"d", d, k, 0}, {"u", u, k, 0}, {"f", f, k, 0},
+        {"A", A[0], n, m}
+    };
+    int err = mat_output_npz(filename, entries, 5);
+    REQUIRE_BARRIER(err == 0);
+
+    // map the diagonals without copying, and solve with them
+    mat_map maps[4];
+    const char *names[4] = {"l", "d", "u.npy", "f"};
+    for (int i = 0; i < 4; i++) {
+      err = mat_map_npz(filename, names[i], &maps[i]);
+      REQUIRE_BARRIER(err == 0);
+      REQUIRE(maps[i].copied == 0);
+      REQUIRE(maps[i].h.rows == k && maps[i].h.cols == 1);
+      REQUIRE((uintptr_t)maps[i].data % 64 == 0);
+    }
+    double dd[7], uu[7], xx[7];
+    memcpy(dd, maps[1].data, sizeof(dd));
+    memcpy(uu, maps[2].data, sizeof(uu));
+    memcpy(xx, maps[3].data, sizeof(xx));
+    tri_solve(maps[0].data, dd, uu, xx, k); // l is used in place
+    for (int i = 0; i < k; i++) {
+      REQUIRE_CLOSE(xx[i], x[i], 1e-10);
+    }
+    for (int i = 0; i < 4; i++) {
+      mat_unmap_bin(&maps[i]);
+    }
+
+    err = mat_input_npz(filename, "A", B[0], n, m);
+    REQUIRE_BARRIER(err == 0);
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < m; j++) {
+        REQUIRE(A[i][j] == B[i][j]);
+      }
+    }
+
+    // missing arrays
+    mat_header h;
+    REQUIRE(mat_input_npz_header(filename, "B", &h) == 1);
+    REQUIRE(mat_input_npz_header(filename, "A.np", &h) == 1);
+    REQUIRE(mat_input_npz(filename, "A", B[0], m, n) == 1);
+
+    unlink(filename);
+  }
+
+  /* check banded files, in both formats, against the diagonals */
+  SUBTEST("banded output/input") {
+    const char filename[] = "tests/test_output.txt";
+    const char binname[] = "tests/test_output.bin";
+    const int nt = 200000; // more rows than a block of the text reader
+    double **T = malloc_d2d(6, nt);
+    for (int i = 0; i < nt; i++) {
+      T[0][i] = 1.0 / (i + 3.0);
+      T[1][i] = (double)(rand() % 1000 - 500) / 7.0;
+      T[2][i] = -T[0][i];
+      T[3][i] = (double)(rand() % 1000 - 500) / 100.0;
+    }
+    const double *tri[3] = {T[0], T[1], T[2]};
+    double *out[3] = {T[3], T[4], T[5]};
+
+    // cyclic tridiagonal, so every entry is kept
+    int err = mat_output_band(filename, tri, 1, 1, 1, nt);
+    REQUIRE_BARRIER(err == 0);
+    mat_header h;
+    err = mat_input_band_header(filename, &h);
+    REQUIRE_BARRIER(err == 0);
+    REQUIRE(h.rows == 3 && h.cols == nt);
+    REQUIRE(h.kl == 1 && h.ku == 1 && h.cyclic == 1);
+    int cyclic = 0;
+    err = mat_input_band(filename, out, 1, 1, &cyclic, nt);
+    REQUIRE_BARRIER(err == 0);
+    REQUIRE(cyclic == 1);
+    for (int k = 0; k < 3; k++) {
+      REQUIRE(memcmp(tri[k], out[k], (size_t)nt * sizeof(double)) == 0);
+    }
+
+    err = mat_output_band_bin(binname, tri, 1, 1, 1, nt);
+    REQUIRE_BARRIER(err == 0);
+    memset(T[3], 0, 3 * (size_t)nt * sizeof(double));
+    cyclic = 0;
+    err = mat_input_band_bin(binname, out, 1, 1, &cyclic, nt);
+    REQUIRE_BARRIER(err == 0);
+    REQUIRE(cyclic == 1);
+    for (int k = 0; k < 3; k++) {
+      REQUIRE(memcmp(tri[k], out[k], (size_t)nt * sizeof(double)) == 0);
+    }
+
+    // the mapped diagonals can be used directly
+    mat_map map;
+    err = mat_map_bin(binname, &map);
+    REQUIRE_BARRIER(err == 0);
+    REQUIRE(map.h.kl == 1 && map.h.ku == 1 && map.h.cyclic == 1);
+    const double *md = map.data + map.h.stride;
+    cyclic_tri_matvec(map.data, md, md + map.h.stride, T[3], T[4], nt);
+    cyclic_tri_matvec(T[0], T[1], T[2], T[3], T[5], nt);
+    REQUIRE(memcmp(T[4], T[5], (size_t)nt * sizeof(double)) == 0);
+    mat_unmap_bin(&map);
+
+    // the wrong size or bandwidth is rejected
+    REQUIRE(mat_input_band(filename, out, 1, 1, NULL, nt - 1) == 1);
+    REQUIRE(mat_input_band(filename, out, 2, 0, NULL, nt) == 1);
+    REQUIRE(mat_input_band_bin(binname, out, 1, 1, NULL, nt + 1) == 1);
+    REQUIRE(mat_input_band_bin(binname, out, 0, 2, NULL, nt) == 1);
+    REQUIRE(mat_output_band(filename, tri, 1, 1, 0, 1) == 1);
+
+    // non-cyclic pentadiagonal, so the entries outside the matrix are zeroed
+    const int np = 6;
+    double P[5][6], Q[5][6];
+    for (int k = 0; k < 5; k++) {
+      for (int i = 0; i < np; i++) {
+        P[k][i] = (double)(10 * k + i);
+      }
+    }
+    const double *pent[5] = {P[0], P[1], P[2], P[3], P[4]};
+    double *qent[5] = {Q[0], Q[1], Q[2], Q[3], Q[4]};
+    for (int f = 0; f < 2; f++) {
+      const char *name = f ? binname : filename;
+      err = f ? mat_output_band_bin(name, pent, 2, 2, 0, np)
+              : mat_output_band(name, pent, 2, 2, 0, np);
+      REQUIRE_BARRIER(err == 0);
+      memset(Q, 0xff, sizeof(Q));
+      cyclic = 1;
+      err = f ? mat_input_band_bin(name, qent, 2, 2, &cyclic, np)
+              : mat_input_band(name, qent, 2, 2, &cyclic, np);
+      REQUIRE_BARRIER(err == 0);
+      REQUIRE(cyclic == 0);
+      for (int k = 0; k < 5; k++) {
+        for (int i = 0; i < np; i++) {
+          const int inside = (i + k - 2 >= 0 && i + k - 2 < np);
+          REQUIRE(Q[k][i] == (inside ? P[k][i] : 0.0));
+        }
+      }
+    }
+
+    // a dense file is not a banded one
+    err = mat_output_bin(binname, P[0], 5, np);
+    REQUIRE_BARRIER(err == 0);
+    REQUIRE(mat_input_band_bin(binname, qent, 2, 2, NULL, np) == 1);
+    err = mat_output(filename, P[0], 5, np);
+    REQUIRE_BARRIER(err == 0);
+    REQUIRE(mat_input_band(filename, qent, 2, 2, NULL, np) == 1);
+    REQUIRE(mat_input_band_header(filename, &h) == 1);
+
+    unlink(filename);
+    unlink(binname);
+    free_2d(T);
+  }
+
+  /* check that the exact writer is short and round-trips */
+  SUBTEST("exact output") {
+    const char filename[] = "tests/test_output.txt";
+    const int nl = 300;
+    const int ml = 400;
+    double **X = malloc_d2d(nl, ml);
+    double **Y = malloc_d2d(nl, ml);
+    const double scale[4] = {0.01, 1.0 / 3.0, 1.0, 1e-300 / 7.0};
+    for (int i = 0; i < nl; i++) {
+      for (int j = 0; j < ml; j++) {
+        const double r = (double)(rand() % 1000 - 500);
+        X[i][j] = r * scale[(i + j) % 4];
+      }
+    }
+    X[0][0] = -0.0;
+    X[0][1] = 1e300;
+    X[0][2] = 0.1;
+    X[0][3] = -5e15;
+
+    int err = mat_output(filename, X[0], nl, ml);
+    REQUIRE_BARRIER(err == 0);
+    err = mat_input(filename, Y[0], nl, ml);
+    REQUIRE_BARRIER(err == 0);
+    for (int i = 0; i < nl; i++) {
+      for (int j = 0; j < ml; j++) {
+        REQUIRE(memcmp(&X[i][j], &Y[i][j], sizeof(double)) == 0);
+      }
+    }
+
+    // short values are written without padding
+    FILE *fp = fopen(filename, "r");
+    REQUIRE_BARRIER(fp != NULL);
+    char line[64];
+    REQUIRE(fgets(line, sizeof(line), fp) != NULL);
+    REQUIRE(strncmp(line, "-0 1e+300 0.1 -5000000000000000 ", 32) == 0);
+    fclose(fp);
+
+    unlink(filename);
+    free_2d(X);
+    free_2d(Y);
+  }
+
   free_2d(A);
   free_2d(B);
 
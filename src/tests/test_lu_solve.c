@@ -360,5 +360,141 @@ int main(void) {
     free(piv);
   }
 
+  /* check LDL^T factorisation solve */
+  SUBTEST("LDLT solve") {
+    const int n = 6;
+    const int m = 3;
+    double **A = malloc_d2d(n, n);
+    double **AA = malloc_d2d(n, n);
+    double *f = malloc(n * sizeof(double));
+    double *ff = malloc(n * sizeof(double));
+    double **F = malloc_d2d(n, m);
+    double **FF = malloc_d2d(n, m);
+
+    // fill the matrix and rhs with random values, keeping A symmetric (but
+    // indefinite) and diagonally dominant so that no pivoting is needed
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j <= i; j++) {
+        A[i][j] = (double)(rand() % 1000 - 500) / 100.0;
+        A[j][i] = A[i][j];
+      }
+      A[i][i] = (i % 2) ? 5.0 * n : -5.0 * n;
+      f[i] = (double)(rand() % 1000 - 500) / 100.0;
+      ff[i] = f[i]; // copy the original rhs
+      for (int j = 0; j < m; j++) {
+        F[i][j] = (double)(rand() % 1000 - 500) / 100.0;
+        FF[i][j] = F[i][j]; // copy the original rhs
+      }
+    }
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) {
+        AA[i][j] = A[i][j]; // copy the original matrix
+      }
+    }
+
+    int err = ldlt_solve(A[0], f, n);
+    REQUIRE_BARRIER(err == 0);
+
+    // check that the upper triangle is untouched
+    for (int i = 0; i < n; i++) {
+      for (int j = i + 1; j < n; j++) {
+        REQUIRE(A[i][j] == AA[i][j]);
+      }
+    }
+
+    // check that Ax = f
+    for (int i = 0; i < n; i++) {
+      // compute the ith entry of Ax
+      double Axi = 0.0;
+      for (int j = 0; j < n; j++) {
+        Axi += AA[i][j] * f[j];
+      }
+      REQUIRE_CLOSE(Axi, ff[i], 1e-10);
+    }
+
+    // perform a multiple rhs solve reusing the factorisation
+    ldlt_solve_factorised_multi(A[0], F[0], n, m);
+
+    // check that AX = F
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < m; j++) {
+        // compute the ijth entry of AX
+        double AXij = 0.0;
+        for (int k = 0; k < n; k++) {
+          AXij += AA[i][k] * F[k][j];
+        }
+        REQUIRE_CLOSE(AXij, FF[i][j], 1e-10);
+      }
+    }
+
+    free_2d(A);
+    free_2d(AA);
+    free(f);
+    free(ff);
+    free_2d(F);
+    free_2d(FF);
+  }
+
+  /* check solving with a view into a larger matrix */
+  SUBTEST("matrix LU solve") {
+    const int n = 6;
+    const int m = 2;
+    const int big = 10;
+    double **R = malloc_d2d(big, big);
+    double **AA = malloc_d2d(n, n);
+    double **F = malloc_d2d(big, big);
+    double **FF = malloc_d2d(n, m);
+    int *piv = malloc(n * sizeof(int));
+
+    // fill the larger matrices with random values
+    for (int i = 0; i < big; i++) {
+      for (int j = 0; j < big; j++) {
+        R[i][j] = (double)(rand() % 1000 - 500) / 100.0;
+        F[i][j] = (double)(rand() % 1000 - 500) / 100.0;
+      }
+    }
+
+    // solve with the n x n block starting at (2, 3) and the n x m block of F
+    // starting at (1, 4)
+    matrix RR, A, FB, FV;
+    matrix_wrap(&RR, R[0], big, big, big);
+    matrix_wrap(&FB, F[0], big, big, big);
+    matrix_view(&A, &RR, 2, 3, n, n);
+    matrix_view(&FV, &FB, 1, 4, n, m);
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) {
+        AA[i][j] = R[2 + i][3 + j];
+      }
+      for (int j = 0; j < m; j++) {
+        FF[i][j] = F[1 + i][4 + j];
+      }
+    }
+
+    int err = matrix_lu_solve(&A, &FV, piv);
+    REQUIRE_BARRIER(err == 0);
+
+    // check that AX = F
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < m; j++) {
+        double AXij = 0.0;
+        for (int k = 0; k < n; k++) {
+          AXij += AA[i][k] * F[1 + k][4 + j];
+        }
+        REQUIRE_CLOSE(AXij, FF[i][j], 1e-10);
+      }
+    }
+
+    // transposed matrices are not supported
+    matrix T;
+    matrix_transpose(&T, &A);
+    REQUIRE(matrix_lu_factorise(&T, piv) == -1);
+
+    free_2d(R);
+    free_2d(AA);
+    free_2d(F);
+    free_2d(FF);
+    free(piv);
+  }
+
   END_TEST();
 }
@@ -0,0 +1,96 @@
+#include "testing.h"
+
+#include <stdint.h>
+
+#include "src/alloc.h"
+#include "src/matrix.h"
+
+int main(void) {
+  START_TEST("matrix");
+
+  const int n = 6;
+  const int m = 9;
+  matrix A;
+  int err = matrix_alloc(&A, n, m);
+  REQUIRE_BARRIER(err == 0);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < m; j++) {
+      A.data[(size_t)i * A.stride + j] = i * m + j;
+    }
+  }
+
+  /* check allocated matrices are aligned */
+  SUBTEST("alloc") {
+    REQUIRE(A.owner);
+    REQUIRE(A.stride >= m);
+    REQUIRE((uintptr_t)A.data % ALLOC_ALIGN == 0);
+    REQUIRE(!matrix_is_contiguous(&A)); // since the rows are padded
+  }
+
+  /* check submatrix views index into the original matrix */
+  SUBTEST("view") {
+    matrix V;
+    err = matrix_view(&V, &A, 2, 3, 3, 4);
+    REQUIRE_BARRIER(err == 0);
+    REQUIRE(!V.owner);
+    for (int i = 0; i < 3; i++) {
+      for (int j = 0; j < 4; j++) {
+        REQUIRE(*matrix_entry(&V, i, j) == (i + 2) * m + (j + 3));
+      }
+    }
+
+    // views of views
+    matrix W;
+    err = matrix_row_range(&W, &V, 1, 2);
+    REQUIRE_BARRIER(err == 0);
+    REQUIRE(*matrix_entry(&W, 0, 0) == 3 * m + 3);
+
+    // out of range
+    REQUIRE(matrix_view(&V, &A, 4, 0, 3, 1) == -1);
+    REQUIRE(matrix_view(&V, &A, 0, 8, 1, 2) == -1);
+  }
+
+  /* check transposed views */
+  SUBTEST("transpose") {
+    matrix T, V;
+    matrix_transpose(&T, &A);
+    REQUIRE(T.rows == m && T.cols == n);
+    for (int i = 0; i < m; i++) {
+      for (int j = 0; j < n; j++) {
+        REQUIRE(*matrix_entry(&T, i, j) == j * m + i);
+      }
+    }
+
+    // a submatrix of the transpose is the transpose of a submatrix
+    err = matrix_view(&V, &T, 1, 2, 3, 2);
+    REQUIRE_BARRIER(err == 0);
+    for (int i = 0; i < 3; i++) {
+      for (int j = 0; j < 2; j++) {
+        REQUIRE(*matrix_entry(&V, i, j) == (j + 2) * m + (i + 1));
+      }
+    }
+  }
+
+  /* check copying into contiguous memory */
+  SUBTEST("copy") {
+    double B[6 * 9];
+    matrix PB, T;
+    matrix_wrap(&PB, B, m, n, n);
+    REQUIRE(matrix_is_contiguous(&PB));
+
+    matrix_transpose(&T, &A);
+    err = matrix_copy(&PB, &T);
+    REQUIRE_BARRIER(err == 0);
+    for (int i = 0; i < m; i++) {
+      for (int j = 0; j < n; j++) {
+        REQUIRE(B[i * n + j] == j * m + i);
+      }
+    }
+
+    REQUIRE(matrix_copy(&PB, &A) == -1); // wrong size
+  }
+
+  matrix_free(&A);
+
+  END_TEST();
+}
@@ -0,0 +1,317 @@
+#include "testing.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "src/alloc.h"
+#include "src/mtx.h"
+
+/**
+ * Writes a string to a file.
+ */
+static void write_file(const char *filename, const char *text) {
+  FILE *fp = fopen(filename, "w");
+  fputs(text, fp);
+  fclose(fp);
+}
+
+int main(void) {
+  START_TEST("mtx");
+
+  const char filename[] = "tests/test_output.mtx";
+  const int n = 12;
+  const int m = 9;
+
+  // a sparse matrix with a few entries in each row
+  double **A = calloc_d2d(n, m);
+  double **B = malloc_d2d(n, m);
+  int row[100], col[100];
+  double val[100];
+  size_t nnz = 0;
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < m; j++) {
+      if ((i * 7 + j * 3) % 5 == 0) {
+        A[i][j] = (double)(rand() % 1000 - 500) / 100.0;
+        row[nnz] = i;
+        col[nnz] = j;
+        val[nnz] = A[i][j];
+        nnz++;
+      }
+    }
+  }
+
+  /* check coordinate files read back in every form */
+  SUBTEST("coordinate general") {
+    int err =
+        mtx_write_triplets(filename, n, m, row, col, val, nnz, MTX_GENERAL);
+    REQUIRE_BARRIER(err == 0);
+
+    mtx_info info;
+    err = mtx_read_info(filename, &info);
+    REQUIRE_BARRIER(err == 0);
+    REQUIRE(info.format == MTX_COORDINATE);
+    REQUIRE(info.symmetry == MTX_GENERAL);
+    REQUIRE(info.rows == n && info.cols == m);
+    REQUIRE(info.nnz == nnz && info.max_entries == nnz);
+
+    err = mtx_read_dense(filename, B[0], n, m);
+    REQUIRE_BARRIER(err == 0);
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < m; j++) {
+        REQUIRE(A[i][j] == B[i][j]);
+      }
+    }
+
+    int r[100], c[100];
+    double v[100];
+    size_t count;
+    err = mtx_read_triplets(filename, r, c, v, 100, &count);
+    REQUIRE_BARRIER(err == 0 && count == nnz);
+    for (size_t k = 0; k < nnz; k++) {
+      REQUIRE(r[k] == row[k] && c[k] == col[k] && v[k] == val[k]);
+    }
+
+    // too short for every entry
+    err = mtx_read_triplets(filename, r, c, v, nnz - 1, &count);
+    REQUIRE(err == 1);
+
+    size_t rowptr[13];
+    err = mtx_read_csr(filename, n, rowptr, c, v, 100);
+    REQUIRE_BARRIER(err == 0);
+    REQUIRE(rowptr[0] == 0 && rowptr[n] == nnz);
+    memset(B[0], 0, (size_t)(n * m) * sizeof(double));
+    for (int i = 0; i < n; i++) {
+      for (size_t k = rowptr[i]; k < rowptr[i + 1]; k++) {
+        B[i][c[k]] = v[k];
+      }
+    }
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < m; j++) {
+        REQUIRE(A[i][j] == B[i][j]);
+      }
+    }
+
+    // and the CSR arrays write back to the same file
+    err = mtx_write_csr(filename, n, m, rowptr, c, v, MTX_GENERAL);
+    REQUIRE_BARRIER(err == 0);
+    err = mtx_read_dense(filename, B[0], n, m);
+    REQUIRE_BARRIER(err == 0);
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < m; j++) {
+        REQUIRE(A[i][j] == B[i][j]);
+      }
+    }
+
+    unlink(filename);
+  }
+
+  /* check array files, including the symmetric variants */
+  SUBTEST("array") {
+    const int k = 7;
+    double **S = malloc_d2d(k, k);
+    double **T = malloc_d2d(k, k);
+    for (int i = 0; i < k; i++) {
+      for (int j = 0; j <= i; j++) {
+        S[i][j] = (double)(rand() % 1000 - 500) / 7.0;
+        S[j][i] = S[i][j];
+      }
+    }
+
+    int err = mtx_write_dense(filename, S[0], k, k, MTX_GENERAL);
+    REQUIRE_BARRIER(err == 0);
+    err = mtx_read_dense(filename, T[0], k, k);
+    REQUIRE_BARRIER(err == 0);
+    for (int i = 0; i < k; i++) {
+      for (int j = 0; j < k; j++) {
+        REQUIRE(S[i][j] == T[i][j]);
+      }
+    }
+
+    err = mtx_write_dense(filename, S[0], k, k, MTX_SYMMETRIC);
+    REQUIRE_BARRIER(err == 0);
+    mtx_info info;
+    err = mtx_read_info(filename, &info);
+    REQUIRE_BARRIER(err == 0);
+    REQUIRE(info.format == MTX_ARRAY && info.symmetry == MTX_SYMMETRIC);
+    REQUIRE(info.nnz == (size_t)(k * (k + 1) / 2));
+    memset(T[0], 0, (size_t)(k * k) * sizeof(double));
+    err = mtx_read_dense(filename, T[0], k, k);
+    REQUIRE_BARRIER(err == 0);
+    for (int i = 0; i < k; i++) {
+      for (int j = 0; j < k; j++) {
+        REQUIRE(S[i][j] == T[i][j]);
+      }
+    }
+
+    // skew-symmetric: only the strict lower triangle is stored
+    for (int i = 0; i < k; i++) {
+      S[i][i] = 0.0;
+      for (int j = 0; j < i; j++) {
+        S[j][i] = -S[i][j];
+      }
+    }
+    err = mtx_write_dense(filename, S[0], k, k, MTX_SKEW_SYMMETRIC);
+    REQUIRE_BARRIER(err == 0);
+    err = mtx_read_dense(filename, T[0], k, k);
+    REQUIRE_BARRIER(err == 0);
+    for (int i = 0; i < k; i++) {
+      for (int j = 0; j < k; j++) {
+        REQUIRE(S[i][j] == T[i][j]);
+      }
+    }
+
+    // symmetric storage needs a square matrix
+    err = mtx_write_dense(filename, A[0], n, m, MTX_SYMMETRIC);
+    REQUIRE(err == 1);
+
+    unlink(filename);
+    free_2d(S);
+    free_2d(T);
+  }
+
+  /* check symmetric and pattern coordinate files written by hand */
+  SUBTEST("coordinate symmetric") {
+    write_file(
+        filename, "%%MatrixMarket matrix coordinate real symmetric\n"
+                  "% a comment\n"
+                  "%\n"
+                  "\n"
+                  "3 3 4\n"
+                  "1 1 2.0\n"
+                  "2 1 -1\n"
+                  "3 2 -1e0\n"
+                  "3 3 2.5\n"
+    );
+    const double expect[9] = {2, -1, 0, -1, 0, -1, 0, -1, 2.5};
+
+    double C[9];
+    int err = mtx_read_dense(filename, C, 3, 3);
+    REQUIRE_BARRIER(err == 0);
+    for (int k = 0; k < 9; k++) {
+      REQUIRE(C[k] == expect[k]);
+    }
+
+    // off-diagonal entries are stored twice
+    mtx_info info;
+    err = mtx_read_info(filename, &info);
+    REQUIRE_BARRIER(err == 0);
+    REQUIRE(info.max_entries == 8);
+    size_t rowptr[4];
+    int c[8];
+    double v[8];
+    err = mtx_read_csr(filename, 3, rowptr, c, v, 8);
+    REQUIRE_BARRIER(err == 0);
+    REQUIRE(rowptr[1] == 2 && rowptr[2] == 4 && rowptr[3] == 6);
+    for (int i = 0; i < 3; i++) {
+      for (size_t k = rowptr[i]; k < rowptr[i + 1]; k++) {
+        REQUIRE(v[k] == expect[i * 3 + c[k]]);
+      }
+    }
+
+    // pattern entries have the value 1, and the banner is case-insensitive
+    write_file(
+        filename, "%%MatrixMarket MATRIX Coordinate Pattern General\n"
+                  "2 3 3\n"
+                  "1 3\n"
+                  "2 1\n"
+                  "2 2\n"
+    );
+    const double pattern[6] = {0, 0, 1, 1, 1, 0};
+    err = mtx_read_dense(filename, C, 2, 3);
+    REQUIRE_BARRIER(err == 0);
+    for (int k = 0; k < 6; k++) {
+      REQUIRE(C[k] == pattern[k]);
+    }
+
+    unlink(filename);
+  }
+
+  /* check that malformed files are rejected */
+  SUBTEST("invalid input") {
+    double C[9];
+    mtx_info info;
+
+    // missing file
+    REQUIRE(mtx_read_info("tests/nonexistent.mtx", &info) == 1);
+
+    // complex entries are not supported
+    write_file(
+        filename, "%%MatrixMarket matrix coordinate complex general\n"
+                  "1 1 1\n1 1 1 0\n"
+    );
+    REQUIRE(mtx_read_info(filename, &info) == 1);
+
+    // index out of range
+    write_file(
+        filename, "%%MatrixMarket matrix coordinate real general\n"
+                  "3 3 1\n4 1 1\n"
+    );
+    REQUIRE(mtx_read_dense(filename, C, 3, 3) == 1);
+
+    // too few entries
+    write_file(
+        filename, "%%MatrixMarket matrix array real general\n"
+                  "3 3\n1 2 3 4 5 6 7 8\n"
+    );
+    REQUIRE(mtx_read_dense(filename, C, 3, 3) == 1);
+
+    // wrong size
+    write_file(
+        filename, "%%MatrixMarket matrix array real general\n"
+                  "3 2\n1 2 3 4 5 6\n"
+    );
+    REQUIRE(mtx_read_dense(filename, C, 3, 3) == 1);
+
+    unlink(filename);
+  }
+
+  /* check a file larger than a single block of the reader */
+  SUBTEST("large input") {
+    const int nl = 200;
+    const size_t nnzl = 250000;
+    int *r = malloc(nnzl * sizeof(int));
+    int *c = malloc(nnzl * sizeof(int));
+    double *v = malloc(nnzl * sizeof(double));
+    double **X = calloc_d2d(nl, nl);
+    for (size_t k = 0; k < nnzl; k++) {
+      r[k] = rand() % nl;
+      c[k] = rand() % nl;
+      v[k] = (double)(rand() % 100000 - 50000) / 7.0;
+      X[r[k]][c[k]] = v[k]; // later duplicates overwrite earlier ones
+    }
+
+    int err =
+        mtx_write_triplets(filename, nl, nl, r, c, v, nnzl, MTX_GENERAL);
+    REQUIRE_BARRIER(err == 0);
+
+    double **Y = malloc_d2d(nl, nl);
+    err = mtx_read_dense(filename, Y[0], nl, nl);
+    REQUIRE_BARRIER(err == 0);
+    for (int i = 0; i < nl; i++) {
+      for (int j = 0; j < nl; j++) {
+        REQUIRE(X[i][j] == Y[i][j]);
+      }
+    }
+
+    size_t count;
+    err = mtx_read_triplets(filename, r, c, v, nnzl, &count);
+    REQUIRE_BARRIER(err == 0 && count == nnzl);
+    for (size_t k = 0; k < nnzl; k++) {
+      REQUIRE(r[k] >= 0 && r[k] < nl && c[k] >= 0 && c[k] < nl);
+    }
+
+    unlink(filename);
+    free(r);
+    free(c);
+    free(v);
+    free_2d(X);
+    free_2d(Y);
+  }
+
+  free_2d(A);
+  free_2d(B);
+
+  END_TEST();
+}
@@ -0,0 +1,88 @@
+#include "testing.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "src/alloc.h"
+#include "src/nd_solve.h"
+
+/**
+ * Fills the five diagonals of the grid operator with random, diagonally
+ * dominant, values and sets the elements of the full matrix A.
+ */
+static void fill_grid(double **A, double **a, int nx, int ny) {
+  const int n = nx * ny;
+  const int di[5] = {-1, 0, 0, 0, 1};
+  const int dj[5] = {0, -1, 0, 1, 0};
+  memset(A[0], 0, n * n * sizeof(double));
+
+  for (int i = 0; i < nx; i++) {
+    for (int j = 0; j < ny; j++) {
+      const int p = i * ny + j;
+      double mag = 0.0;
+      for (int k = 0; k < 5; k++) {
+        a[k][p] = (double)(rand() % 1000 - 500) / 100.0;
+        mag += fabs(a[k][p]);
+      }
+      a[2][p] = 1.1 * mag;
+
+      for (int k = 0; k < 5; k++) {
+        const int qi = i + di[k];
+        const int qj = j + dj[k];
+        if (qi >= 0 && qi < nx && qj >= 0 && qj < ny) {
+          A[p][qi * ny + qj] = a[k][p];
+        }
+      }
+    }
+  }
+}
+
+int main(void) {
+  START_TEST("nd solve");
+
+  SUBTEST("nd solve") {
+    const int sizes[4][2] = {{13, 17}, {20, 9}, {1, 11}, {2, 2}};
+    for (int s = 0; s < 4; s++) {
+      const int nx = sizes[s][0];
+      const int ny = sizes[s][1];
+      const int n = nx * ny;
+      double **A = malloc_d2d(n, n);
+      double **a = malloc_d2d(5, n);
+      double *f = malloc(n * sizeof(double));
+      double *ff = malloc(n * sizeof(double));
+
+      fill_grid(A, a, nx, ny);
+
+      nd_factor nd;
+      const int err = nd_factorise(&nd, a[0], a[1], a[2], a[3], a[4], nx, ny);
+      REQUIRE_BARRIER(err == 0);
+
+      // solve twice, reusing the factorisation
+      for (int r = 0; r < 2; r++) {
+        for (int i = 0; i < n; i++) {
+          f[i] = (double)(rand() % 1000 - 500) / 100.0;
+          ff[i] = f[i]; // copy the original rhs
+        }
+        nd_solve_factorised(&nd, f);
+
+        // check that Ax = f
+        for (int i = 0; i < n; i++) {
+          // compute the ith entry of Ax
+          double Axi = 0.0;
+          for (int j = 0; j < n; j++) {
+            Axi += A[i][j] * f[j];
+          }
+          REQUIRE_CLOSE(Axi, ff[i], 1e-10);
+        }
+      }
+
+      nd_factor_free(&nd);
+      free_2d(A);
+      free_2d(a);
+      free(f);
+      free(ff);
+    }
+  }
+
+  END_TEST();
+}
@@ -0,0 +1,140 @@
+#include "testing.h"
+
+#include <stdlib.h>
+
+#include "src/poisson_solve.h"
+
+/**
+ * Apply the discrete Laplacian to u on an n[0] x n[1] x n[2] grid (n[2] = 1 in
+ * 2D), with the given boundary conditions.
+ */
+static void laplacian(
+    const double *u, double *f, const int *n, const double *h,
+    const poisson_bc *bc
+) {
+  const int stride[3] = {n[1] * n[2], n[2], 1};
+  for (int i = 0; i < n[0]; i++) {
+    for (int j = 0; j < n[1]; j++) {
+      for (int k = 0; k < n[2]; k++) {
+        const int idx[3] = {i, j, k};
+        const int p = i * stride[0] + j * stride[1] + k * stride[2];
+        f[p] = 0.0;
+        for (int d = 0; d < 3; d++) {
+          if (n[d] == 1) {
+            continue;
+          }
+          // neighbours are zero outside a Dirichlet domain, or wrap around a
+          // periodic one
+          double lo = 0.0, hi = 0.0;
+          if (idx[d] > 0) {
+            lo = u[p - stride[d]];
+          } else if (bc[d] == POISSON_PERIODIC) {
+            lo = u[p + (n[d] - 1) * stride[d]];
+          }
+          if (idx[d] < n[d] - 1) {
+            hi = u[p + stride[d]];
+          } else if (bc[d] == POISSON_PERIODIC) {
+            hi = u[p - (n[d] - 1) * stride[d]];
+          }
+          f[p] += (lo - 2.0 * u[p] + hi) / (h[d] * h[d]);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Check that the Poisson solver recovers a random field from its Laplacian.
+ */
+static int check_poisson(const int *n, const double *h, const poisson_bc *bc) {
+  const int dim = (n[2] == 1) ? 2 : 3;
+  const int total = n[0] * n[1] * n[2];
+  double *u = malloc(total * sizeof(double));
+  double *f = malloc(total * sizeof(double));
+
+  // random solution, with zero mean in case the problem is fully periodic
+  double mean = 0.0;
+  for (int p = 0; p < total; p++) {
+    u[p] = (double)(rand() % 1000 - 500) / 100.0;
+    mean += u[p];
+  }
+  mean /= total;
+  for (int p = 0; p < total; p++) {
+    u[p] -= mean;
+  }
+  laplacian(u, f, n, h, bc);
+
+  poisson_plan plan;
+  int err;
+  if (dim == 2) {
+    err = poisson_plan_init_2d(&plan, n[0], n[1], h[0], h[1], bc[0], bc[1]);
+  } else {
+    err = poisson_plan_init_3d(
+        &plan, n[0], n[1], n[2], h[0], h[1], h[2], bc[0], bc[1], bc[2]
+    );
+  }
+  if (err != 0) {
+    free(u);
+    free(f);
+    return 1;
+  }
+  poisson_solve(&plan, f);
+
+  int errs = 0;
+  for (int p = 0; p < total; p++) {
+    errs += fabs(f[p] - u[p]) > 1e-9;
+  }
+
+  poisson_plan_free(&plan);
+  free(u);
+  free(f);
+  return errs;
+}
+
+int main(void) {
+  START_TEST("poisson solve");
+
+  SUBTEST("2D Dirichlet") {
+    const int n[3] = {9, 8, 1};
+    const double h[3] = {0.1, 0.2, 1.0};
+    const poisson_bc bc[3] = {POISSON_DIRICHLET, POISSON_DIRICHLET};
+    REQUIRE(check_poisson(n, h, bc) == 0);
+  }
+
+  SUBTEST("2D periodic") {
+    const int n[3] = {6, 16, 1};
+    const double h[3] = {0.3, 0.1, 1.0};
+    const poisson_bc bc[3] = {POISSON_PERIODIC, POISSON_PERIODIC};
+    REQUIRE(check_poisson(n, h, bc) == 0);
+  }
+
+  SUBTEST("2D mixed") {
+    const int n1[3] = {7, 10, 1};
+    const int n2[3] = {12, 5, 1};
+    const double h[3] = {0.1, 0.15, 1.0};
+    const poisson_bc bc1[3] = {POISSON_PERIODIC, POISSON_DIRICHLET};
+    const poisson_bc bc2[3] = {POISSON_DIRICHLET, POISSON_PERIODIC};
+    REQUIRE(check_poisson(n1, h, bc1) == 0);
+    REQUIRE(check_poisson(n2, h, bc2) == 0);
+  }
+
+  SUBTEST("3D mixed") {
+    const int n[3] = {5, 6, 7};
+    const double h[3] = {0.1, 0.2, 0.3};
+    const poisson_bc bc[3] = {
+        POISSON_DIRICHLET, POISSON_PERIODIC, POISSON_DIRICHLET
+    };
+    REQUIRE(check_poisson(n, h, bc) == 0);
+  }
+
+  SUBTEST("3D periodic") {
+    const int n[3] = {8, 4, 6};
+    const double h[3] = {0.5, 0.25, 0.125};
+    const poisson_bc bc[3] = {
+        POISSON_PERIODIC, POISSON_PERIODIC, POISSON_PERIODIC
+    };
+    REQUIRE(check_poisson(n, h, bc) == 0);
+  }
+
+  END_TEST();
+}
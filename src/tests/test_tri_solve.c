@@ -155,6 +155,32 @@ int main(void) {
       REQUIRE_CLOSE(Axi, ff[i], 1e-10);
     }
 
+    // perform a multiple rhs solve reusing the LU factorisation
+    const int m = 3;
+    double **F = malloc_d2d(n, m);
+    double **FF = malloc_d2d(n, m);
+    for (int i = 0; i < n; i++) {
+      for (int k = 0; k < m; k++) {
+        F[i][k] = (double)(rand() % 1000 - 500) / 100.0;
+        FF[i][k] = F[i][k]; // copy the original rhs
+      }
+    }
+    tri_lu_solve_multi(l, d, u, F[0], n, m);
+
+    // check that AX = F
+    for (int i = 0; i < n; i++) {
+      for (int k = 0; k < m; k++) {
+        // compute the (i, k)th entry of AX
+        double AXik = 0.0;
+        for (int j = 0; j < n; j++) {
+          AXik += A[i][j] * F[j][k];
+        }
+        REQUIRE_CLOSE(AXik, FF[i][k], 1e-10);
+      }
+    }
+    free_2d(F);
+    free_2d(FF);
+
     free(l);
     free(d);
     free(u);
@@ -220,6 +246,32 @@ int main(void) {
       REQUIRE_CLOSE(Axi, ff[i], 1e-10);
     }
 
+    // perform a multiple rhs solve reusing the LU factorisation
+    const int m = 3;
+    double **F = malloc_d2d(n, m);
+    double **FF = malloc_d2d(n, m);
+    for (int i = 0; i < n; i++) {
+      for (int k = 0; k < m; k++) {
+        F[i][k] = (double)(rand() % 1000 - 500) / 100.0;
+        FF[i][k] = F[i][k]; // copy the original rhs
+      }
+    }
+    cyclic_tri_lu_solve_multi(l, d, u, q, F[0], n, m);
+
+    // check that AX = F
+    for (int i = 0; i < n; i++) {
+      for (int k = 0; k < m; k++) {
+        // compute the (i, k)th entry of AX
+        double AXik = 0.0;
+        for (int j = 0; j < n; j++) {
+          AXik += A[i][j] * F[j][k];
+        }
+        REQUIRE_CLOSE(AXik, FF[i][k], 1e-10);
+      }
+    }
+    free_2d(F);
+    free_2d(FF);
+
     free(l);
     free(d);
     free(u);
@@ -9,6 +9,7 @@
 
 #include "tri_solve.h"
 
+#include <stddef.h>
 #include <string.h>
 
 void tri_lu_factorise(const double *l, double *d, double *u, const int n) {
@@ -48,6 +49,30 @@ void tri_lu_solve(
   }
 }
 
+void tri_lu_solve_multi(
+    const double *l, const double *d, const double *u, double *F, const int n,
+    const int m
+) {
+  // solve LY = F via forward substitution
+  for (int j = 0; j < m; j++) { // apply to entire row
+    F[j] /= d[0];
+  }
+  for (int i = 1; i < n; i++) {
+    double *Fi = F + (size_t)i * m;
+    for (int j = 0; j < m; j++) { // apply to entire row
+      Fi[j] = (Fi[j] - l[i] * Fi[j - m]) / d[i];
+    }
+  }
+
+  // solve UX = Y via backward substitution
+  for (int i = n - 2; i >= 0; i--) {
+    double *Fi = F + (size_t)i * m;
+    for (int j = 0; j < m; j++) { // apply to entire row
+      Fi[j] -= u[i] * Fi[j + m];
+    }
+  }
+}
+
 void tri_solve(const double *l, double *d, double *u, double *f, const int n) {
   tri_lu_factorise(l, d, u, n);
   tri_lu_solve(l, d, u, f, n);
@@ -92,6 +117,28 @@ void cyclic_tri_lu_solve(
   }
 }
 
+void cyclic_tri_lu_solve_multi(
+    const double *l, const double *d, const double *u, const double *q,
+    double *F, const int n, const int m
+) {
+  // solve Y = B \ F
+  tri_lu_solve_multi(l, d, u, F, n, m);
+
+  // compute v[n-1] = l[0] / gamma
+  const double gamma = -0.5 * d[0];
+  const double vn_1 = l[0] / gamma;
+  const double denom = 1.0 + q[0] + vn_1 * q[n - 1];
+
+  // then X = Y - q * (v·Y / (1 + v·q)), one column at a time since the scale
+  // depends on the first and last rows
+  for (int j = 0; j < m; j++) {
+    const double scale = (F[j] + vn_1 * F[(size_t)(n - 1) * m + j]) / denom;
+    for (int i = 0; i < n; i++) {
+      F[(size_t)i * m + j] -= q[i] * scale;
+    }
+  }
+}
+
 void cyclic_tri_solve(
     const double *l, double *d, double *u, double *q, double *f, const int n
 ) {
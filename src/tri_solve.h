@@ -37,6 +37,25 @@ void tri_lu_solve(
     const double *l, const double *d, const double *u, double *f, int n
 );
 
+/**
+ * Given an LU factorisation of a tridiagonal, square, matrix A = LU, solves
+ * AX = F in place.
+ *
+ * As for `tri_lu_solve` but for multiple right-hand side vectors. Each step of
+ * the substitution is applied to an entire row of F, so the inner loops run
+ * over the right-hand sides and can be vectorised.
+ *
+ * @param l lower diagonal of L
+ * @param d main diagonal of L
+ * @param u upper diagonal of U
+ * @param F right-hand side vectors (n x m), overwritten with the solution
+ * @param n size of the matrix
+ * @param m number of right-hand side vectors
+ */
+void tri_lu_solve_multi(
+    const double *l, const double *d, const double *u, double *F, int n, int m
+);
+
 /**
  * Solves the system Ax = f in place, where A is a tridiagonal.
  *
@@ -94,6 +113,25 @@ void cyclic_tri_lu_solve(
     double *f, int n
 );
 
+/**
+ * Given a partial LU factorisation of a cyclic, tridiagonal, square matrix A
+ * = LU, solves AX = F in place.
+ *
+ * As for `cyclic_tri_lu_solve` but for multiple right-hand side vectors.
+ *
+ * @param l lower diagonal of L
+ * @param d main diagonal of L
+ * @param u upper diagonal of U
+ * @param q B \ g
+ * @param F right-hand side vectors (n x m), overwritten with the solution
+ * @param n size of the matrix
+ * @param m number of right-hand side vectors
+ */
+void cyclic_tri_lu_solve_multi(
+    const double *l, const double *d, const double *u, const double *q,
+    double *F, int n, int m
+);
+
 /**
  * Given a cyclic, tridiagonal, square matrix A = LU, solves Ax = f in place.
  * Stores the partial LU factorisation of A in place so that it can be reused.